@@ -52,7 +52,7 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         TabMeta &tab = sm_manager_->db_.get_table(x->tab_name);
         for (auto &set_clause : query->set_clauses) {
             auto lhs_col = tab.get_col(set_clause.lhs.col_name);
-            if (lhs_col->type != set_clause.rhs.type) {
+            if (!is_compatible_type(lhs_col->type, set_clause.rhs.type)) {
                 throw IncompatibleTypeError(coltype2str(lhs_col->type), coltype2str(set_clause.rhs.type));
             }
             set_clause.rhs.init_raw(lhs_col->len);
@@ -151,7 +151,7 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
             auto rhs_col = rhs_tab.get_col(cond.rhs_col.col_name);
             rhs_type = rhs_col->type;
         }
-        if (lhs_type != rhs_type) {
+        if (!is_compatible_type(lhs_type, rhs_type)) {
             throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
         }
     }
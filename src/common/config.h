@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <string>
 
 #define BUFFER_LENGTH 8192
 
@@ -34,6 +35,12 @@ static constexpr int HEADER_PAGE_ID = 0;                                      //
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
 static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_INSTANCES = 8;                               // number of buffer pool instances
+static constexpr int BUFFER_POOL_MAX_SIZE = 4 * BUFFER_POOL_SIZE;             // max size the buffer pool can grow to at runtime
+static constexpr int BUFFER_POOL_RESIZE_CHUNK = 1024;                         // frames added/removed per instance per resize step
+static constexpr int BUFFER_POOL_SHRINK_RETRIES = 10;                         // retries when frames to release are pinned
+static constexpr bool ENABLE_HUGE_PAGE_FRAMES = true;                         // back frame data with 2MB huge pages (MAP_HUGETLB, falling back to THP)
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;                             // huge page size; frame arenas are rounded up to a multiple of it
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
 
@@ -47,8 +54,42 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
+static const std::string DOUBLE_WRITE_FILE_NAME = "db.dwb";
+static const std::string WARMUP_FILE_NAME = "db.warmup";
 
 // replacer
-static const std::string REPLACER_TYPE = "LRU";
+static const std::string REPLACER_TYPE = "LRU_K"; // 缓冲池替换策略，"LRU"、"LRU_K"、"CLOCK"或"CLOCK_PRO"
+static constexpr size_t LRU_K = 2;                // LRU-K替换策略中的K
+static constexpr size_t LRU_K_CORRELATED_PERIOD = 8;  // LRU-K的相关访问期：距上次访问不超过这么多次访问的再次访问视为同一次访问
+static constexpr int PAGE_LATCH_SPIN_COUNT = 64;   // 页面latch获取失败时挂起线程之前的自旋次数
+
+// buffer access strategy
+static constexpr int BULK_READ_RING_SIZE = 64;      // 大表顺序扫描使用的私有环形缓冲区的帧数
+static constexpr int BULK_WRITE_RING_SIZE = 1024;   // 批量插入新页面使用的私有环形缓冲区的帧数
+static constexpr int BULK_READ_THRESHOLD = 4;       // 表的页面数超过缓冲池帧数的1/BULK_READ_THRESHOLD时，扫描使用环形缓冲区
+
+// read ahead
+static constexpr int READ_AHEAD_MIN_PAGES = 4;      // 顺序扫描预读窗口的初始页面数
+static constexpr int READ_AHEAD_MAX_PAGES = 32;     // 预读窗口的最大页面数，窗口随着扫描的推进成倍增长
+
+// io engine
+static const std::string IO_ENGINE_TYPE = "URING";  // 异步I/O引擎类型，"URING"或"THREAD_POOL"，io_uring不可用时自动退化为线程池
+static constexpr int IO_QUEUE_DEPTH = 64;           // 异步I/O同时在途的最大请求数
+static constexpr int IO_THREAD_NUM = 4;             // 线程池I/O引擎的线程数
+static constexpr bool ENABLE_DIRECT_IO = false;     // 是否以O_DIRECT打开数据文件，绕过内核页缓存，避免页面在内存中缓存两份
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;    // O_DIRECT要求的缓冲区地址、读写长度和文件偏移量的对齐粒度
+static constexpr int FILE_EXTENT_SIZE = 1 << 20;    // 数据文件每次用fallocate预分配的空间大小，为0时不预分配
+static constexpr bool ENABLE_PAGE_CHECKSUM = true;  // 是否在页面写回时计算CRC32C校验和、读入时校验，用于发现磁盘上损坏的页面
+static constexpr bool ENABLE_DOUBLE_WRITE = true;   // 是否使用双写缓冲区防止崩溃时写坏页面，需要同时启用页面校验和
+static constexpr int DOUBLE_WRITE_PAGES = 128;      // 双写文件的槽位个数，即一批最多先写入双写文件的页面数
+static constexpr bool ENABLE_BACKGROUND_WRITER = true;  // 是否启动后台写线程，提前淘汰并批量写回脏页，使缺页时不必等待写盘
+static constexpr int BACKGROUND_WRITER_FREE_FRAMES = 256;  // 后台写线程为每个缓冲池实例保持的空闲帧数
+static constexpr int BACKGROUND_WRITER_INTERVAL_MS = 20;   // 后台写线程两轮之间的最长间隔（毫秒）
+static constexpr bool ENABLE_BUFFER_POOL_WARMUP = true;  // 是否在关闭数据库时转储缓冲池中的页面，打开时在后台预先读入
+static constexpr int WARMUP_BATCH_PAGES = 32;             // 预热时一次读请求最多读入的连续页面数
+static constexpr int CHECKPOINT_BATCH_PAGES = 128;        // 检查点每批固定并写回的脏页数
+static constexpr int CHECKPOINT_MAX_PAGES_PER_SECOND = 16384;  // 检查点每秒最多写回的页面数，避免挤占前台的磁盘带宽；为0时不限速
+static constexpr bool COMPRESS_TABLE_FILES = false;  // 新建的表是否以页面压缩格式存储，用CPU换取更少的磁盘空间和读写量
+static constexpr bool OPEN_TABLES_READ_ONLY = false;  // 打开数据库时是否以只读方式打开已有的表，页面通过mmap直接读取，适用于只读的报表库
 
 static const std::string DB_META_NAME = "db.meta";
@@ -59,6 +59,12 @@ class FileNotFoundError : public RMDBError {
     FileNotFoundError(const std::string &filename) : RMDBError("File not found: " + filename) {}
 };
 
+class PageChecksumError : public RMDBError {
+   public:
+    PageChecksumError(int fd, int page_no)
+        : RMDBError("Page checksum mismatch: fd " + std::to_string(fd) + ", page " + std::to_string(page_no)) {}
+};
+
 // RM errors
 class RecordNotFoundError : public RMDBError {
    public:
@@ -132,6 +138,11 @@ class IndexExistsError : public RMDBError {
     }
 };
 
+class VariableNotFoundError : public RMDBError {
+   public:
+    VariableNotFoundError(const std::string &name) : RMDBError("Variable not found: " + name) {}
+};
+
 // QL errors
 class InvalidValueCountError : public RMDBError {
    public:
@@ -158,4 +169,9 @@ class PageNotExistError : public RMDBError {
    public:
     PageNotExistError(const std::string &table_name, int page_no)
         : RMDBError("Page " + std::to_string(page_no) + " in table " + table_name + "not exits") {}
+};
+
+class TableReadOnlyError : public RMDBError {
+   public:
+    TableReadOnlyError(const std::string &table_name) : RMDBError("Table is opened read-only: " + table_name) {}
 };
\ No newline at end of file
@@ -20,6 +20,9 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "record_printer.h"
 
+#include <iomanip>
+#include <sstream>
+
 const char *help_info = "Supported SQL syntax:\n"
                    "  command ;\n"
                    "command:\n"
@@ -31,6 +34,8 @@ const char *help_info = "Supported SQL syntax:\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  SET buffer_pool_size = num_pages\n"
+                   "  SHOW buffer_stats\n"
                    "type:\n"
                    "  {INT | FLOAT | CHAR(n)}\n"
                    "where_clause:\n"
@@ -75,7 +80,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     }
 }
 
-// 执行help; show tables; desc table; begin; commit; abort;语句
+// 执行help; show tables; show buffer_stats; desc table; begin; commit; abort; set name = value;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -90,6 +95,14 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_tables(context);
                 break;
             }
+            case T_ShowStats:
+            {
+                if (x->tab_name_ != "buffer_stats") {
+                    throw VariableNotFoundError(x->tab_name_);
+                }
+                show_buffer_stats(context);
+                break;
+            }
             case T_DescTable:
             {
                 sm_manager_->desc_table(x->tab_name_, context);
@@ -124,7 +137,75 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 break;                        
         }
 
+    } else if (auto x = std::dynamic_pointer_cast<SetVariablePlan>(plan)) {
+        sm_manager_->set_variable(x->name_, x->value_, context);
+    }
+}
+
+/**
+ * @description: 输出缓冲池的统计信息：各实例的命中率、淘汰和latch等待次数，命中、缺页、写回和latch等待的延迟分布，
+ * 以及各文件在缓冲池中缓存的页面数
+ * @param {Context*} context
+ */
+void QlManager::show_buffer_stats(Context *context) {
+    BufferPoolStats stats = sm_manager_->get_bpm()->get_stats();
+    auto ratio = [](double value) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(4) << value;
+        return os.str();
+    };
+
+    std::vector<std::string> captions = {"Shard",  "Frames",    "Free",      "Resident",     "Dirty",
+                                         "Hits",   "Misses",    "Hit ratio", "Evictions",    "Dirty evicts",
+                                         "Latch waits"};
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    auto print_shard = [&](const std::string &name, const BufferPoolShardStats &shard) {
+        printer.print_record({name, std::to_string(shard.pool_size), std::to_string(shard.num_free_frames),
+                              std::to_string(shard.num_resident_pages), std::to_string(shard.num_dirty_pages),
+                              std::to_string(shard.num_hits), std::to_string(shard.num_misses),
+                              ratio(shard.hit_ratio()), std::to_string(shard.num_evictions),
+                              std::to_string(shard.num_dirty_evictions), std::to_string(shard.num_latch_waits)},
+                             context);
+    };
+    for (size_t i = 0; i < stats.shards.size(); i++) {
+        print_shard(std::to_string(i), stats.shards[i]);
+    }
+    print_shard("total", stats.total);
+    printer.print_separator(context);
+
+    // 延迟分布，分位数是样本所在2的幂区间的上界
+    captions = {"Latency", "Count", "Mean(ns)", "P50(ns)", "P99(ns)", "P99.9(ns)"};
+    RecordPrinter latency_printer(captions.size());
+    latency_printer.print_separator(context);
+    latency_printer.print_record(captions, context);
+    latency_printer.print_separator(context);
+    auto print_latency = [&](const std::string &name, const HistogramSnapshot &histogram) {
+        latency_printer.print_record({name, std::to_string(histogram.count), std::to_string(histogram.mean_ns()),
+                                      std::to_string(histogram.percentile_ns(0.5)),
+                                      std::to_string(histogram.percentile_ns(0.99)),
+                                      std::to_string(histogram.percentile_ns(0.999))},
+                                     context);
+    };
+    print_latency("fetch hit", stats.total.hit_latency);
+    print_latency("fetch miss", stats.total.miss_latency);
+    print_latency("write back", stats.write_back_latency);
+    print_latency("latch wait", stats.total.latch_wait);
+    latency_printer.print_record({"pages written", std::to_string(stats.num_write_backs), "", "", "", ""}, context);
+    latency_printer.print_separator(context);
+
+    captions = {"File", "Resident", "Dirty"};
+    RecordPrinter file_printer(captions.size());
+    file_printer.print_separator(context);
+    file_printer.print_record(captions, context);
+    file_printer.print_separator(context);
+    for (auto &file : stats.files) {
+        file_printer.print_record(
+            {file.file_name, std::to_string(file.num_resident_pages), std::to_string(file.num_dirty_pages)}, context);
     }
+    file_printer.print_separator(context);
 }
 
 // 执行select语句，select语句的输出除了需要返回客户端外，还需要写入output.txt文件中
@@ -163,7 +244,7 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
                 col_str = std::to_string(*(int *)rec_buf);
             } else if (col.type == TYPE_FLOAT) {
                 col_str = std::to_string(*(float *)rec_buf);
-            } else if (col.type == TYPE_STRING) {
+            } else if (is_string_type(col.type)) {
                 col_str = std::string((char *)rec_buf, col.len);
                 col_str.resize(strlen(col_str.c_str()));
             }
@@ -41,4 +41,7 @@ class QlManager {
                         Context *context);
 
     void run_dml(std::unique_ptr<AbstractExecutor> exec);
+
+   private:
+    void show_buffer_stats(Context *context);
 };
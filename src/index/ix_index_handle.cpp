@@ -209,10 +209,12 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
-    
+    // 文件头之后存放的是已释放、可以复用的页面列表
+    disk_manager_->load_free_pages(fd, buf + file_hdr_->tot_len_);
+    delete[] buf;
+
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
 }
 
 /**
@@ -221,17 +223,17 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @param operation 查找到目标键值对后要进行的操作类型
  * @param transaction 事务参数，如果不需要则默认传入nullptr
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
- * @note need to Unlatch and unpin the leaf node outside!
- * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * @note 叶子结点的句柄析构时取消固定；查找路径上的其他结点在向下移动时已经取消固定
  */
-std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                            Transaction *transaction, bool find_first) {
+std::pair<std::unique_ptr<IxNodeHandle>, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
+                                                                            Transaction *transaction,
+                                                                            bool find_first) {
     // Todo:
     // 1. 获取根节点
     // 2. 从根节点开始不断向下查找目标key
     // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
     // std::cout<< "In find_leaf_page" << std::endl;
-    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    std::unique_ptr<IxNodeHandle> node = fetch_node(file_hdr_->root_page_);
     bool root_is_latched = false;
     // 检查根节点是否加锁
     if (root_latch_.try_lock()) {
@@ -242,10 +244,9 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
     }
     while (!node->page_hdr->is_leaf) {
         page_id_t page_no = node->internal_lookup(key);
-        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
         node = fetch_node(page_no);
     }
-    return std::make_pair(node, root_is_latched);
+    return std::make_pair(std::move(node), root_is_latched);
 }
 
 /**
@@ -264,12 +265,11 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
     // std::cout<< "In get_value" << std::endl;
     std::scoped_lock lock(root_latch_);
-    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, transaction, true).first;
+    std::unique_ptr<IxNodeHandle> node = find_leaf_page(key, Operation::FIND, transaction, true).first;
     Rid *rid;
     bool found = node->leaf_lookup(key, &rid);
-    if (node != nullptr && found) {
+    if (found) {
         result->push_back(*rid);
-        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
     }
     return found;
 }
@@ -277,11 +277,9 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
 /**
  * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
  * @param node 需要拆分的结点
- * @return 拆分得到的new_node
- * @note need to unpin the new node outside
- * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * @return 拆分得到的new_node，其句柄析构时取消固定
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
+std::unique_ptr<IxNodeHandle> IxIndexHandle::split(IxNodeHandle *node) {
     // Todo:
     // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
     //    需要初始化新节点的page_hdr内容
@@ -289,7 +287,7 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
     //    为新节点分配键值对，更新旧节点的键值对数记录
     // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
 
-    IxNodeHandle *new_node = create_node();
+    std::unique_ptr<IxNodeHandle> new_node = create_node();
     int pos = node->get_size() / 2;
     new_node->set_size(0);
     new_node->set_is_leaf(node->page_hdr->is_leaf);
@@ -298,15 +296,13 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
     if (new_node->is_leaf_page()) {
         new_node->set_prev_leaf(node->get_page_no());
         new_node->set_next_leaf(node->get_next_leaf());
-        IxNodeHandle *next = fetch_node(new_node->get_next_leaf());
-        next->set_prev_leaf(new_node->get_page_no());
-        buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+        fetch_node(new_node->get_next_leaf())->set_prev_leaf(new_node->get_page_no());
         node->set_next_leaf(new_node->get_page_no());
     }
     new_node->insert_pairs(0, node->get_key(pos), node->get_rid(pos), node->get_size() - pos);
     node->set_size(pos);
     for (int i = 0; i < new_node->get_size(); i++) {
-        maintain_child(new_node, i);
+        maintain_child(new_node.get(), i);
     }
     return new_node;
 }
@@ -322,7 +318,7 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  * @param key 要插入parent的key
  * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
  * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
- * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
+ * @note new node和old node由调用者持有，本函数中获取的其他结点在返回前取消固定
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                      Transaction *transaction) {
@@ -334,7 +330,7 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
     // 提示：记得unpin page
 
     if (old_node->is_root_page()) {
-        IxNodeHandle *new_root = create_node();
+        std::unique_ptr<IxNodeHandle> new_root = create_node();
         new_root->set_size(0);
         new_root->set_is_leaf(false);
         new_root->set_parent_page_no(INVALID_PAGE_ID);
@@ -345,15 +341,13 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
         old_node->set_parent_page_no(new_root->get_page_no());
         this->set_root_page_no(new_root->get_page_no());
     } else {
-        IxNodeHandle *parent = fetch_node(old_node->get_parent_page_no());
+        std::unique_ptr<IxNodeHandle> parent = fetch_node(old_node->get_parent_page_no());
         int pos_rid = parent->find_child(old_node);
         parent->insert_pair(pos_rid + 1, key, {new_node->get_page_no(), -1});
         if (parent->get_size() == parent->get_max_size()) {
-            IxNodeHandle *new_node_split = split(parent);
-            insert_into_parent(parent, new_node_split->get_key(0), new_node_split, transaction);
-            buffer_pool_manager_->unpin_page(new_node_split->get_page_id(), true);
+            std::unique_ptr<IxNodeHandle> new_node_split = split(parent.get());
+            insert_into_parent(parent.get(), new_node_split->get_key(0), new_node_split.get(), transaction);
         }
-        buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
     }
 }
 
@@ -370,23 +364,21 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
     // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
     std::scoped_lock lock{root_latch_};
-    IxNodeHandle *leaf_page = find_leaf_page(key, Operation::INSERT, transaction).first;
+    std::unique_ptr<IxNodeHandle> leaf_page = find_leaf_page(key, Operation::INSERT, transaction).first;
     int past_num = leaf_page->get_size();
     int new_num = leaf_page->insert(key, value);
     if (new_num > past_num) {
         // 已满， 需要split
         if (leaf_page->get_size() == leaf_page->get_max_size()) {
-            IxNodeHandle *new_node = split(leaf_page);
+            std::unique_ptr<IxNodeHandle> new_node = split(leaf_page.get());
             // 最右叶子结点
             if (leaf_page->get_page_no() == file_hdr_->get_last_leaf()) {
                 file_hdr_->set_last_leaf(new_node->get_page_no());
             }
-            insert_into_parent(leaf_page, new_node->get_key(0), new_node, transaction);
-            buffer_pool_manager_->unpin_page(new_node->get_page_id(), true);
+            insert_into_parent(leaf_page.get(), new_node->get_key(0), new_node.get(), transaction);
         }
     }
-    buffer_pool_manager_->unpin_page(leaf_page->get_page_id(), false);
-    return leaf_page->get_page_id().page_no;
+    return leaf_page->get_page_no();
 }
 
 /**
@@ -401,14 +393,15 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
     // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
     // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
     std::scoped_lock lock{root_latch_};
-    IxNodeHandle *leaf_page = find_leaf_page(key, Operation::DELETE, transaction).first;
+    std::unique_ptr<IxNodeHandle> leaf_page = find_leaf_page(key, Operation::DELETE, transaction).first;
     int num = leaf_page->get_size();
     if (leaf_page->remove(key) < num) {
-        coalesce_or_redistribute(leaf_page, transaction, nullptr);
-        buffer_pool_manager_->unpin_page(leaf_page->get_page_id(), true);
+        coalesce_or_redistribute(leaf_page.get(), transaction, nullptr);
+        // 释放叶子结点的句柄之后，合并中被删除的结点都已经不再被固定，可以归还给磁盘文件
+        leaf_page.reset();
+        free_released_pages();
         return true;
     }
-    buffer_pool_manager_->unpin_page(leaf_page->get_page_id(), false);
     return false;
 }
 
@@ -440,23 +433,21 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
         maintain_parent(node);
         return false;
     }
-    IxNodeHandle *parent = fetch_node(node->get_parent_page_no());
+    std::unique_ptr<IxNodeHandle> parent = fetch_node(node->get_parent_page_no());
     int index = parent->find_child(node);
-    IxNodeHandle *neighbor;
+    std::unique_ptr<IxNodeHandle> neighbor;
     if (index > 0) {
         neighbor = fetch_node(parent->get_rid(index - 1)->page_no);
     } else {
         neighbor = fetch_node(parent->get_rid(index + 1)->page_no);
     }
     if (node->get_size() + neighbor->get_size() >= node->get_min_size() * 2) {
-        redistribute(neighbor, node, parent, index);
-        buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
-        buffer_pool_manager_->unpin_page(neighbor->get_page_id(), true);
+        redistribute(neighbor.get(), node, parent.get(), index);
         return false;
     }
-    coalesce(&neighbor, &node, &parent, index, transaction, root_is_latched);
-    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
-    buffer_pool_manager_->unpin_page(neighbor->get_page_id(), true);
+    IxNodeHandle *neighbor_node = neighbor.get();
+    IxNodeHandle *parent_node = parent.get();
+    coalesce(&neighbor_node, &node, &parent_node, index, transaction, root_is_latched);
     return true;
 }
 
@@ -472,18 +463,18 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
     // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
     // 3. 除了上述两种情况，不需要进行操作
     if (old_root_node->is_leaf_page() && old_root_node->get_size() == 0) {
-        // old_root_node->file_hdr->num_pages_--;
-        release_node_handle(*old_root_node);
+        // 唯一的叶子结点总是最左叶子，即初始根结点，它作为空树的根保留下来，不需要释放
+        if (old_root_node->get_page_no() != IX_INIT_ROOT_PAGE) {
+            release_node_handle(*old_root_node);
+        }
         this->set_root_page_no(IX_INIT_ROOT_PAGE);
         return true;
     }
     if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
-        IxNodeHandle *child = fetch_node(old_root_node->get_rid(0)->page_no);
-        // old_root_node->file_hdr->num_pages_--;
+        std::unique_ptr<IxNodeHandle> child = fetch_node(old_root_node->get_rid(0)->page_no);
         release_node_handle(*old_root_node);
         this->set_root_page_no(child->get_page_no());
         child->set_parent_page_no(IX_NO_PAGE);
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
         return true;
     }
     return false;
@@ -586,11 +577,10 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  * @note iid和rid存的不是一个东西，rid是上层传过来的记录位置，iid是索引内部生成的索引槽位置
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
-    IxNodeHandle *node = fetch_node(iid.page_no);
+    std::unique_ptr<IxNodeHandle> node = fetch_node(iid.page_no);
     if (iid.slot_no >= node->get_size()) {
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
     return *node->get_rid(iid.slot_no);
 }
 
@@ -604,7 +594,7 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
     std::scoped_lock lock{root_latch_};
-    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, nullptr, true).first;
+    std::unique_ptr<IxNodeHandle> node = find_leaf_page(key, Operation::FIND, nullptr, true).first;
     int key_idx = node->lower_bound(key);
     Iid iid = (key_idx == node->get_size()) ? leaf_end() : Iid{.page_no = node->get_page_no(), .slot_no = key_idx};
     return iid;
@@ -618,7 +608,7 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
     std::scoped_lock lock{root_latch_};
-    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, nullptr, true).first;
+    std::unique_ptr<IxNodeHandle> node = find_leaf_page(key, Operation::FIND, nullptr, true).first;
     int key_idx = node->upper_bound(key);
     Iid iid = (key_idx == node->get_size()) ? leaf_end() : Iid{.page_no = node->get_page_no(), .slot_no = key_idx};
     return iid;
@@ -631,10 +621,8 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return iid;
+    std::unique_ptr<IxNodeHandle> node = fetch_node(file_hdr_->last_leaf_);
+    return {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
 }
 
 /**
@@ -652,35 +640,26 @@ Iid IxIndexHandle::leaf_begin() const {
  * @brief 获取一个指定结点
  *
  * @param page_no
- * @return IxNodeHandle*
- * @note pin the page, remember to unpin it outside!
+ * @return IxNodeHandle* 结点的句柄，析构时取消固定
  */
-IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
-    Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
-    IxNodeHandle *node = new IxNodeHandle(file_hdr_, page);
-    
-    return node;
+std::unique_ptr<IxNodeHandle> IxIndexHandle::fetch_node(int page_no) const {
+    return std::make_unique<IxNodeHandle>(file_hdr_, buffer_pool_manager_->fetch_page_basic(PageId{fd_, page_no}));
 }
 
 /**
  * @brief 创建一个新结点
  *
- * @return IxNodeHandle*
- * @note pin the page, remember to unpin it outside!
- * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
- * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
- * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
+ * @return IxNodeHandle* 新结点的句柄，析构时取消固定
+ * @note 注意：对于Index的处理是，合并时被删除的结点页面归还给DiskManager的空闲页面列表，
+ * 新结点优先复用其中页号最小的页面，没有空闲页面时才从文件末尾分配（从3开始）
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
  */
-IxNodeHandle *IxIndexHandle::create_node() {
-    IxNodeHandle *node;
-    file_hdr_->num_pages_++;
-
+std::unique_ptr<IxNodeHandle> IxIndexHandle::create_node() {
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
-    // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
-    Page *page = buffer_pool_manager_->new_page(&new_page_id);
-    node = new IxNodeHandle(file_hdr_, page);
-    return node;
+    BasicPageGuard guard = buffer_pool_manager_->new_page_guarded(&new_page_id);
+    // num_pages_记录文件中页面的数量，复用空闲页面时不会增长
+    file_hdr_->num_pages_ = std::max(file_hdr_->num_pages_, new_page_id.page_no + 1);
+    return std::make_unique<IxNodeHandle>(file_hdr_, std::move(guard));
 }
 
 /**
@@ -690,20 +669,20 @@ IxNodeHandle *IxIndexHandle::create_node() {
  */
 void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
     IxNodeHandle *curr = node;
+    std::unique_ptr<IxNodeHandle> curr_handle;     // 向上遍历时持有curr的固定，node由调用者持有
     while (curr->get_parent_page_no() != IX_NO_PAGE) {
         // Load its parent
-        IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
+        std::unique_ptr<IxNodeHandle> parent = fetch_node(curr->get_parent_page_no());
         int rank = parent->find_child(curr);
         char *parent_key = parent->get_key(rank);
         char *child_first_key = curr->get_key(0);
         if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
             break;
         }
         memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
-        curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        parent->mark_dirty();
+        curr = parent.get();
+        curr_handle = std::move(parent);
     }
 }
 
@@ -715,22 +694,31 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
 
-    IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
-    prev->set_next_leaf(leaf->get_next_leaf());
-    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
-
-    IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
-    next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
-    buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    fetch_node(leaf->get_prev_leaf())->set_next_leaf(leaf->get_next_leaf());
+    fetch_node(leaf->get_next_leaf())->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时，记录其页面，等到该页面不再被固定后由free_released_pages()释放
  *
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) { 
-    file_hdr_->num_pages_--;
+    released_pages_.push_back(node.get_page_no());
+}
+
+/**
+ * @brief 将已删除结点的页面从缓冲池中删除并归还给DiskManager，之后create_node()可以复用这些页面
+ * @note 仍被固定的页面暂不释放，留待下一次调用
+ */
+void IxIndexHandle::free_released_pages() {
+    std::vector<page_id_t> still_pinned;
+    for (page_id_t page_no : released_pages_) {
+        if (!buffer_pool_manager_->delete_page(PageId{fd_, page_no})) {
+            still_pinned.push_back(page_no);
+        }
+    }
+    released_pages_ = std::move(still_pinned);
 }
 
 /**
@@ -740,8 +728,6 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
     if (!node->is_leaf_page()) {
         //  Current node is inner node, load its child and set its parent to current node
         int child_page_no = node->value_at(child_idx);
-        IxNodeHandle *child = fetch_node(child_page_no);
-        child->set_parent_page_no(node->get_page_no());
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        fetch_node(child_page_no)->set_parent_page_no(node->get_page_no());
     }
 }
\ No newline at end of file
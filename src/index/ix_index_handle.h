@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+
 #include "ix_defs.h"
 #include "transaction/transaction.h"
 
@@ -31,6 +33,7 @@ inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
             return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
         }
         case TYPE_STRING:
+        case TYPE_VARCHAR:
             return memcmp(a, b, col_len);
         default:
             throw InternalError("Unexpected data type");
@@ -49,13 +52,14 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
-/* 管理B+树中的每个节点 */
+/* 管理B+树中的每个节点，句柄持有页面的固定，析构时自动取消固定；通过set_*等函数修改结点时页面被标记为脏页 */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
+    BasicPageGuard guard;           // 固定页面的guard
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
     char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
@@ -64,7 +68,8 @@ class IxNodeHandle {
    public:
     IxNodeHandle() = default;
 
-    IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
+    IxNodeHandle(const IxFileHdr *file_hdr_, BasicPageGuard &&guard_)
+        : file_hdr(file_hdr_), guard(std::move(guard_)), page(guard.get_page()) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
         keys = page->get_data() + sizeof(IxPageHdr);
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
@@ -72,7 +77,10 @@ class IxNodeHandle {
 
     int get_size() { return page_hdr->num_key; }
 
-    void set_size(int size) { page_hdr->num_key = size; }
+    void set_size(int size) {
+        page_hdr->num_key = size;
+        guard.mark_dirty();
+    }
 
     int get_max_size() { return file_hdr->btree_order_ + 1; }
 
@@ -98,23 +106,47 @@ class IxNodeHandle {
     bool is_root_page() { return get_parent_page_no() == INVALID_PAGE_ID; }
 
 
-    void set_next_leaf(page_id_t page_no) { page_hdr->next_leaf = page_no; }
+    void set_next_leaf(page_id_t page_no) {
+        page_hdr->next_leaf = page_no;
+        guard.mark_dirty();
+    }
 
-    void set_prev_leaf(page_id_t page_no) { page_hdr->prev_leaf = page_no; }
+    void set_prev_leaf(page_id_t page_no) {
+        page_hdr->prev_leaf = page_no;
+        guard.mark_dirty();
+    }
 
-    void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
+    void set_parent_page_no(page_id_t parent) {
+        page_hdr->parent = parent;
+        guard.mark_dirty();
+    }
 
-    void set_next_free_page_no(page_id_t page_no) { page_hdr->next_free_page_no = page_no; }
+    void set_next_free_page_no(page_id_t page_no) {
+        page_hdr->next_free_page_no = page_no;
+        guard.mark_dirty();
+    }
 
-    void set_is_leaf(bool is_leaf) { page_hdr->is_leaf = is_leaf; }
+    void set_is_leaf(bool is_leaf) {
+        page_hdr->is_leaf = is_leaf;
+        guard.mark_dirty();
+    }
+
+    // 直接通过get_key()/get_rid()返回的指针修改结点后需调用
+    void mark_dirty() { guard.mark_dirty(); }
 
     char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
 
     Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    void set_key(int key_idx, const char *key) {
+        memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_);
+        guard.mark_dirty();
+    }
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    void set_rid(int rid_idx, const Rid &rid) {
+        rids[rid_idx] = rid;
+        guard.mark_dirty();
+    }
 
     int lower_bound(const char *target) const;
 
@@ -176,6 +208,7 @@ class IxIndexHandle {
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
     std::mutex root_latch_;
+    std::vector<page_id_t> released_pages_;     // 合并中被删除、尚未归还给DiskManager的结点页面，由root_latch_保护
 
    public:
 
@@ -186,13 +219,13 @@ class IxIndexHandle {
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
-    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                 bool find_first = false);
+    std::pair<std::unique_ptr<IxNodeHandle>, bool> find_leaf_page(const char *key, Operation operation,
+                                                                  Transaction *transaction, bool find_first = false);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    std::unique_ptr<IxNodeHandle> split(IxNodeHandle *node);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
@@ -223,9 +256,9 @@ class IxIndexHandle {
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
     // for get/create node
-    IxNodeHandle *fetch_node(int page_no) const;
+    std::unique_ptr<IxNodeHandle> fetch_node(int page_no) const;
 
-    IxNodeHandle *create_node();
+    std::unique_ptr<IxNodeHandle> create_node();
 
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
@@ -234,6 +267,8 @@ class IxIndexHandle {
 
     void release_node_handle(IxNodeHandle &node);
 
+    void free_released_pages();
+
     void maintain_child(IxNodeHandle *node, int child_idx);
 
     // for index test
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include "system/sm_meta.h"
 #include "ix_defs.h"
 #include "ix_index_handle.h"
+#include "storage/checksum.h"
 
 class IxManager {
    private:
@@ -73,9 +74,11 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
+        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE - |checksum| 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        // 页尾的PAGE_CHECKSUM_SIZE个字节留给缓冲池存放页面校验和
+        int btree_order =
+            static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr) - PAGE_CHECKSUM_SIZE) / (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
@@ -88,10 +91,12 @@ class IxManager {
         }
         fhdr->update_tot_len();
         
-        char* data = new char[fhdr->tot_len_];
+        char* data = new char[PAGE_SIZE]();
         fhdr->serialize(data);
+        // 文件头之后写入空的空闲页面列表，打开索引时据此恢复
+        disk_manager_->save_free_pages(fd, data + fhdr->tot_len_, PAGE_SIZE - fhdr->tot_len_);
 
-        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, fhdr->tot_len_);
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, PAGE_SIZE);
 
         char page_buf[PAGE_SIZE];  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
         memset(page_buf, 0, PAGE_SIZE);
@@ -108,6 +113,7 @@ class IxManager {
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
             };
+            set_page_checksum(page_buf);  // 这两个页面之后通过缓冲池读取，需要带上校验和
             disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
         }
         // 注意root node页号为2，也标记为叶子结点，其前一个/后一个叶子均指向leaf header
@@ -124,11 +130,10 @@ class IxManager {
                 .next_leaf = IX_LEAF_HEADER_PAGE,
             };
             // Must write PAGE_SIZE here in case of future fetch_node()
+            set_page_checksum(page_buf);
             disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
         }
 
-        disk_manager_->set_fd2pageno(fd, IX_INIT_NUM_PAGES - 1);  // DEBUG
-
         // Close index file
         disk_manager_->close_file(fd);
     }
@@ -157,11 +162,15 @@ class IxManager {
     }
 
     void close_index(const IxIndexHandle *ih) {
-        char* data = new char[ih->file_hdr_->tot_len_];
+        // 文件头页中依次存放文件头和空闲页面列表
+        char data[PAGE_SIZE] = {};
         ih->file_hdr_->serialize(data);
-        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
+        disk_manager_->save_free_pages(ih->fd_, data + ih->file_hdr_->tot_len_, PAGE_SIZE - ih->file_hdr_->tot_len_);
+        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, PAGE_SIZE);
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(ih->fd_);
+        // 关闭后fd可能被其他文件复用，不能在缓冲池中留下该文件的页面
+        buffer_pool_manager_->discard_file_pages(ih->fd_);
         disk_manager_->close_file(ih->fd_);
     }
 };
\ No newline at end of file
@@ -16,9 +16,14 @@ See the Mulan PSL v2 for more details. */
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
+    std::unique_ptr<IxNodeHandle> node = ih_->fetch_node(iid_.page_no);
     assert(node->is_leaf_page());
     assert(iid_.slot_no < node->get_size());
+    // 第一次访问一个叶子结点时预读下一个叶子结点，使其在扫描当前结点期间读入
+    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && node->get_next_leaf() != prefetched_leaf_) {
+        prefetched_leaf_ = node->get_next_leaf();
+        bpm_->prefetch({.fd = ih_->fd_, .page_no = prefetched_leaf_});
+    }
     // increment slot no
     iid_.slot_no++;
     if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
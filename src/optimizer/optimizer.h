@@ -38,6 +38,12 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowTables>(query->parse)) {
             // show tables;
             return std::make_shared<OtherPlan>(T_ShowTable, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowStats>(query->parse)) {
+            // show buffer_stats;
+            return std::make_shared<OtherPlan>(T_ShowStats, x->name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::SetVariable>(query->parse)) {
+            // set name = value;
+            return std::make_shared<SetVariablePlan>(x->name, x->value);
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
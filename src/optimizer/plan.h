@@ -23,6 +23,7 @@ typedef enum PlanTag{
     T_Invalid = 1,
     T_Help,
     T_ShowTable,
+    T_ShowStats,
     T_DescTable,
     T_CreateTable,
     T_DropTable,
@@ -36,6 +37,7 @@ typedef enum PlanTag{
     T_Transaction_commit,
     T_Transaction_abort,
     T_Transaction_rollback,
+    T_SetVariable,
     T_SeqScan,
     T_IndexScan,
     T_NestLoop,
@@ -172,7 +174,7 @@ class DDLPlan : public Plan
         std::vector<ColDef> cols_;
 };
 
-// help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
+// help; show tables; show stats; desc tables; begin; abort; commit; rollback语句对应的plan
 class OtherPlan : public Plan
 {
     public:
@@ -185,6 +187,21 @@ class OtherPlan : public Plan
         std::string tab_name_;
 };
 
+// set name = value;语句对应的plan
+class SetVariablePlan : public Plan
+{
+    public:
+        SetVariablePlan(std::string name, int value)
+        {
+            Plan::tag = T_SetVariable;
+            name_ = std::move(name);
+            value_ = value;
+        }
+        ~SetVariablePlan(){}
+        std::string name_;
+        int value_;
+};
+
 class plannerInfo{
     public:
     std::shared_ptr<ast::SelectStmt> parse;
@@ -19,7 +19,7 @@ enum JoinType {
 namespace ast {
 
 enum SvType {
-    SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING
+    SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING, SV_TYPE_VARCHAR
 };
 
 enum SvCompOp {
@@ -43,6 +43,21 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+// SHOW name; 显示系统的统计信息，如show buffer_stats;
+struct ShowStats : public TreeNode {
+    std::string name;
+
+    ShowStats(std::string name_) : name(std::move(name_)) {}
+};
+
+// SET name = value; 修改运行时的系统参数
+struct SetVariable : public TreeNode {
+    std::string name;
+    int value;
+
+    SetVariable(std::string name_, int value_) : name(std::move(name_)), value(value_) {}
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -379,8 +379,8 @@ static void yynoreturn yy_fatal_error ( const char* msg  );
 	(yy_hold_char) = *yy_cp; \
 	*yy_cp = '\0'; \
 	(yy_c_buf_p) = yy_cp;
-#define YY_NUM_RULES 47
-#define YY_END_OF_BUFFER 48
+#define YY_NUM_RULES 48
+#define YY_END_OF_BUFFER 49
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -388,25 +388,25 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[154] =
+static const flex_int16_t yy_accept[159] =
     {   0,
-        0,    0,    0,    0,   48,   46,    6,    7,    7,   46,
-       41,   46,   46,   46,   43,   41,   41,   42,   42,   42,
-       42,   42,   42,   42,   42,   42,   42,   42,   42,   42,
-       42,   42,   42,   42,    3,    4,    6,    7,    0,   45,
-       43,    5,    1,   44,   39,   40,   38,   42,   42,   42,
-       42,   42,   36,   42,   42,   42,   42,   42,   42,   42,
-       42,   42,   42,   42,   42,   42,   42,   42,   42,   42,
-       42,   42,    2,    5,   44,   42,   31,   37,   42,   42,
-       42,   42,   42,   42,   42,   42,   42,   42,   42,   42,
-       42,   27,   42,   42,   42,   42,   25,   42,   42,   42,
-
-       42,   42,   42,   42,   28,   42,   42,   42,   17,   16,
-       33,   42,   22,   34,   42,   42,   19,   32,   42,   42,
-       42,    8,   42,   42,   42,   42,   11,    9,   42,   42,
-       42,   29,   30,   42,   35,   42,   42,   15,   42,   42,
-       23,   10,   14,   21,   18,   42,   26,   13,   24,   20,
-       42,   12,    0
+        0,    0,    0,    0,   49,   47,    6,    7,    7,   47,
+       42,   47,   47,   47,   44,   42,   42,   43,   43,   43,
+       43,   43,   43,   43,   43,   43,   43,   43,   43,   43,
+       43,   43,   43,   43,    3,    4,    6,    7,    0,   46,
+       44,    5,    1,   45,   40,   41,   39,   43,   43,   43,
+       43,   43,   37,   43,   43,   43,   43,   43,   43,   43,
+       43,   43,   43,   43,   43,   43,   43,   43,   43,   43,
+       43,   43,    2,    5,   45,   43,   32,   38,   43,   43,
+       43,   43,   43,   43,   43,   43,   43,   43,   43,   43,
+       43,   27,   43,   43,   43,   43,   25,   43,   43,   43,
+
+       43,   43,   43,   43,   28,   43,   43,   43,   17,   16,
+       34,   43,   22,   35,   43,   43,   19,   33,   43,   43,
+       43,    8,   43,   43,   43,   43,   11,    9,   43,   43,
+       43,   30,   31,   43,   36,   43,   43,   15,   43,   43,
+       23,   10,   14,   21,   18,   43,   26,   13,   24,   20,
+       43,   12,   43,   43,   43,   43,   29,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -452,16 +452,16 @@ static const YY_CHAR yy_meta[69] =
         3,    3,    3,    3,    3,    3,    3,    3
     } ;
 
-static const flex_int16_t yy_base[158] =
+static const flex_int16_t yy_base[163] =
     {   0,
-        0,    0,  281,  280,  287,  306,  284,  306,  279,  274,
-      306,  261,   58,  265,   59,   57,  238,   50,   54,   50,
+        0,    0,  281,  280,  287,  336,  284,  336,  279,  274,
+      336,  261,   58,  265,   59,   57,  238,   50,   54,   50,
        55,   38,   54,    0,   58,   56,   59,   58,   62,   75,
-       80,   66,   87,   87,  306,  176,  139,  306,   88,  306,
-      116,    0,  306,   75,  306,  306,  306,    0,   84,   98,
+       80,   66,   87,   87,  336,  176,  139,  336,   88,  336,
+      116,    0,  336,   75,  336,  336,  336,    0,   84,   98,
       102,  104,    0,  112,  102,  111,  105,  103,  110,  105,
       107,  114,  131,  118,  125,  118,  120,  118,  132,  132,
-      126,  142,  306,    0,   71,  136,    0,    0,  148,  145,
+      274,  142,  336,    0,   71,  136,    0,    0,  148,  145,
       153,  166,  163,  166,  154,  152,  173,  164,  162,  175,
       176,  167,  170,  180,  174,  182,    0,  166,  178,  190,
 
@@ -470,31 +470,33 @@ static const flex_int16_t yy_base[158] =
       222,    0,  222,  209,  225,  227,    0,    0,  215,  228,
       231,    0,    0,  218,    0,  238,  221,  223,  242,  230,
         0,    0,    0,    0,    0,  247,    0,    0,    0,    0,
-      241,    0,  306,  296,  299,   76,  302
+      241,    0,  135,  264,  274,  259,    0,  336,  296,  299,
+       76,  302
     } ;
 
-static const flex_int16_t yy_def[158] =
+static const flex_int16_t yy_def[163] =
     {   0,
-      153,    1,  154,  154,  153,  153,  153,  153,  153,  155,
-      153,  153,  153,  153,  153,  153,  153,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  153,  153,  153,  153,  155,  153,
-      153,  157,  153,  153,  153,  153,  153,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  153,  157,  153,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,  156,  156,  156,  156,  156,  156,  156,  156,
-      156,  156,    0,  153,  153,  153,  153
+      158,    1,  159,  159,  158,  158,  158,  158,  158,  160,
+      158,  158,  158,  158,  158,  158,  158,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  158,  158,  158,  158,  160,  158,
+      158,  162,  158,  158,  158,  158,  158,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  158,  162,  158,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,  161,  161,  161,
+      161,  161,  161,  161,  161,  161,  161,    0,  158,  158,
+      158,  158
     } ;
 
-static const flex_int16_t yy_nxt[375] =
+static const flex_int16_t yy_nxt[405] =
     {   0,
         6,    7,    8,    9,   10,   11,   11,   11,   12,   11,
        13,   11,   14,   15,   11,   16,   11,   17,   18,   19,
@@ -512,10 +514,10 @@ static const flex_int16_t yy_nxt[375] =
        66,   53,   78,   67,   69,   70,   68,   44,   79,   41,
        80,   71,   81,   82,   83,   85,   86,   87,   72,   88,
        37,   84,   76,   89,   93,   77,   94,   95,   78,   96,
-       98,   99,   90,  100,   79,  101,   80,   97,   81,   82,
+       98,   99,   90,  100,   79,  154,   80,   97,   81,   82,
        83,   85,   86,   87,  102,   88,   84,   91,   92,   89,
        93,  103,   94,   95,  104,   96,   98,   99,   90,  100,
-      105,  101,   97,  106,  107,  108,  109,  110,   73,  111,
+      105,  154,   97,  106,  107,  108,  109,  110,   73,  111,
       102,  112,   91,   92,  113,  114,  103,  115,  116,  117,
 
       104,  118,  119,  120,  121,  105,  122,  123,  124,  106,
@@ -526,20 +528,24 @@ static const flex_int16_t yy_nxt[375] =
       143,  130,  142,  144,   47,  145,  146,  131,  147,  148,
       132,  133,  134,  135,  149,  136,  150,  151,  137,  152,
       138,  139,   43,  140,   41,  141,  143,  142,   40,  144,
-      145,   38,  146,  147,  148,   37,  153,   36,   36,  153,
-      149,  150,  153,  151,  153,  152,   35,   35,   35,   39,
-
-       39,   39,   74,  153,   74,    5,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153
+      145,   38,  146,  147,  148,   37,  158,   36,   36,  155,
+      149,  150,  156,  151,  157,  152,   35,   35,   35,   39,
+
+       39,   39,   74,  101,   74,  158,  158,  158,  158,  153,
+      158,  158,  158,  158,  158,  155,  158,  158,  156,  157,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  101,
+      158,  158,  158,  158,  153,    5,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+
+      158,  158,  158,  158
     } ;
 
-static const flex_int16_t yy_chk[375] =
+static const flex_int16_t yy_chk[405] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -548,7 +554,7 @@ static const flex_int16_t yy_chk[375] =
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,   13,   18,
-       15,   13,   15,   16,   16,   20,   19,   21,  156,   22,
+       15,   13,   15,   16,   16,   20,   19,   21,  161,   22,
        25,   18,   20,   23,   75,   20,   18,   26,   44,   23,
        21,   27,   39,   28,   29,   18,   19,   30,   31,   32,
 
@@ -557,10 +563,10 @@ static const flex_int16_t yy_chk[375] =
        29,   19,   51,   30,   31,   32,   30,   41,   52,   41,
        54,   33,   55,   56,   57,   58,   59,   60,   34,   61,
        37,   57,   49,   62,   64,   50,   65,   66,   51,   67,
-       68,   69,   63,   70,   52,   71,   54,   67,   55,   56,
+       68,   69,   63,   70,   52,  153,   54,   67,   55,   56,
        57,   58,   59,   60,   72,   61,   57,   63,   63,   62,
        64,   76,   65,   66,   79,   67,   68,   69,   63,   70,
-       80,   71,   67,   81,   82,   83,   84,   85,   36,   86,
+       80,  153,   67,   81,   82,   83,   84,   85,   36,   86,
        72,   87,   63,   63,   88,   89,   76,   90,   91,   92,
 
        79,   93,   94,   95,   96,   80,   98,   99,  100,   81,
@@ -571,17 +577,21 @@ static const flex_int16_t yy_chk[375] =
       130,  107,  129,  131,   17,  134,  136,  108,  137,  138,
       112,  115,  116,  119,  139,  120,  140,  146,  121,  151,
       123,  124,   14,  125,   12,  126,  130,  129,   10,  131,
-      134,    9,  136,  137,  138,    7,    5,    4,    3,    0,
-      139,  140,    0,  146,    0,  151,  154,  154,  154,  155,
-
-      155,  155,  157,    0,  157,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153,  153,  153,  153,  153,  153,  153,
-      153,  153,  153,  153
+      134,    9,  136,  137,  138,    7,    5,    4,    3,  154,
+      139,  140,  155,  146,  156,  151,  159,  159,  159,  160,
+
+      160,  160,  162,   71,  162,    0,    0,    0,    0,   71,
+        0,    0,    0,    0,    0,  154,    0,    0,  155,  156,
+        0,    0,    0,    0,    0,    0,    0,    0,    0,   71,
+        0,    0,    0,    0,   71,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+      158,  158,  158,  158,  158,  158,  158,  158,  158,  158,
+
+      158,  158,  158,  158
     } ;
 
 static yy_state_type yy_last_accepting_state;
@@ -623,9 +633,9 @@ char *yytext;
         } \
     }
 
-#line 626 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
+#line 636 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
 
-#line 628 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
+#line 638 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
 
 #define INITIAL 0
 #define STATE_COMMENT 1
@@ -863,7 +873,7 @@ YY_DECL
 
 #line 48 "lex.l"
     /* block comment */
-#line 866 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
+#line 876 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -890,13 +900,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 154 )
+				if ( yy_current_state >= 159 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 306 );
+		while ( yy_base[yy_current_state] != 336 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1068,99 +1078,104 @@ YY_RULE_SETUP
 case 29:
 YY_RULE_SETUP
 #line 80 "lex.l"
-{ return FLOAT; }
+{ return VARCHAR; }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
 #line 81 "lex.l"
-{ return INDEX; }
+{ return FLOAT; }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
 #line 82 "lex.l"
-{ return AND; }
+{ return INDEX; }
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
 #line 83 "lex.l"
-{return JOIN;}
+{ return AND; }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
 #line 84 "lex.l"
-{ return EXIT; }
+{return JOIN;}
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
 #line 85 "lex.l"
-{ return HELP; }
+{ return EXIT; }
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
 #line 86 "lex.l"
-{ return ORDER; }
+{ return HELP; }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
 #line 87 "lex.l"
-{  return BY;  }
+{ return ORDER; }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
 #line 88 "lex.l"
-{ return ASC; }
+{  return BY;  }
 	YY_BREAK
-/* operators */
 case 38:
 YY_RULE_SETUP
-#line 90 "lex.l"
-{ return GEQ; }
+#line 89 "lex.l"
+{ return ASC; }
 	YY_BREAK
+/* operators */
 case 39:
 YY_RULE_SETUP
 #line 91 "lex.l"
-{ return LEQ; }
+{ return GEQ; }
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
 #line 92 "lex.l"
-{ return NEQ; }
+{ return LEQ; }
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
 #line 93 "lex.l"
+{ return NEQ; }
+	YY_BREAK
+case 42:
+YY_RULE_SETUP
+#line 94 "lex.l"
 { return yytext[0]; }
 	YY_BREAK
 /* id */
-case 42:
+case 43:
 YY_RULE_SETUP
-#line 95 "lex.l"
+#line 96 "lex.l"
 {
     yylval->sv_str = yytext;
     return IDENTIFIER;
 }
 	YY_BREAK
 /* literals */
-case 43:
+case 44:
 YY_RULE_SETUP
-#line 100 "lex.l"
+#line 101 "lex.l"
 {
     yylval->sv_int = atoi(yytext);
     return VALUE_INT;
 }
 	YY_BREAK
-case 44:
+case 45:
 YY_RULE_SETUP
-#line 104 "lex.l"
+#line 105 "lex.l"
 {
     yylval->sv_float = atof(yytext);
     return VALUE_FLOAT;
 }
 	YY_BREAK
-case 45:
-/* rule 45 can match eol */
+case 46:
+/* rule 46 can match eol */
 YY_RULE_SETUP
-#line 108 "lex.l"
+#line 109 "lex.l"
 {
     yylval->sv_str = std::string(yytext + 1, strlen(yytext) - 2);
     return VALUE_STRING;
@@ -1169,21 +1184,21 @@ YY_RULE_SETUP
 /* EOF */
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(STATE_COMMENT):
-#line 113 "lex.l"
+#line 114 "lex.l"
 { return T_EOF; }
 	YY_BREAK
 /* unexpected char */
-case 46:
+case 47:
 YY_RULE_SETUP
-#line 115 "lex.l"
+#line 116 "lex.l"
 { std::cerr << "Lexer Error: unexpected character " << yytext[0] << std::endl; }
 	YY_BREAK
-case 47:
+case 48:
 YY_RULE_SETUP
-#line 116 "lex.l"
+#line 117 "lex.l"
 ECHO;
 	YY_BREAK
-#line 1186 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
+#line 1201 "/Users/sxy/Documents/projects/rucbase/src/parser/lex.yy.cpp"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -1478,7 +1493,7 @@ static int yy_get_next_buffer (void)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 154 )
+			if ( yy_current_state >= 159 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1506,11 +1521,11 @@ static int yy_get_next_buffer (void)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 154 )
+		if ( yy_current_state >= 159 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 153);
+	yy_is_jam = (yy_current_state == 158);
 
 		return yy_is_jam ? 0 : yy_current_state;
 }
@@ -2149,6 +2164,6 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 116 "lex.l"
+#line 117 "lex.l"
 
 
@@ -18,6 +18,7 @@ int main() {
         "show tables;",
         "desc tb;",
         "create table tb (a int, b float, c char(4));",
+        "create table tb (a int, b varchar(20), c VarChar(4));",
         "drop table tb;",
         "create index tb(a);",
         "create index tb(a, b, c);",
@@ -17,14 +17,31 @@ constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_NO_SLOT = -1;
+constexpr int RM_MAX_VAR_COLS = 32;     // 槽式页面格式的文件头中最多记录的变长字段个数
+
+/* 表数据文件的存储格式 */
+enum RmFileFormat {
+    RM_FORMAT_FIXED = 0,    // 定长记录：页面由位图和等长的slot组成，每条记录都按record_size存放
+    RM_FORMAT_SLOTTED = 1   // 槽式页面：页头之后是槽目录，变长元组从页尾向前存放，变长字段只存放实际长度
+};
+
+/* 记录中的一个变长字段（VARCHAR），在内存中的记录里按最大长度len存放，不足的部分填0 */
+struct RmVarCol {
+    int offset;     // 字段在记录中的偏移量
+    int len;        // 字段的最大长度
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
-    int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
+    int record_size;            // 表中每条记录在内存中的大小，变长字段按最大长度计算，字段初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
-    int num_records_per_page;   // 每个页面最多能存储的元组个数
+    int num_records_per_page;   // 每个页面最多能存储的元组个数；槽式页面中为槽号的上界
     int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
-    int bitmap_size;            // 每个页面bitmap大小
+    int bitmap_size;            // 每个页面bitmap大小，槽式页面没有bitmap，为0
+    int format;                 // 存储格式，RmFileFormat；旧文件中该位置为0，即定长格式
+    int num_var_cols;           // 槽式页面格式下变长字段的个数
+    RmVarCol var_cols[RM_MAX_VAR_COLS];     // 变长字段，按偏移量排序
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
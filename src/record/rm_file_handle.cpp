@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -25,6 +28,9 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
         context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);
     }
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+        return get_slotted_record(page_handle, rid);
+    }
     // 初始化一个指向RmRecord的指针（赋值其内部的data和size）
     char* data = page_handle.get_slot(rid.slot_no);
     return std::make_unique<RmRecord>(file_hdr_.record_size, data);
@@ -43,6 +49,10 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     // 3. 将buf复制到空闲slot位置
     // 4. 更新page_handle.page_hdr中的数据结构
     // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
+    check_writable();
+    if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+        return insert_slotted_record(buf, context);
+    }
     // 获取当前未满的page handle
     RmPageHandle page_handle = create_page_handle();
     // 在page handle中找到空闲slot位置
@@ -63,8 +73,9 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     }
     // 将buf复制到空闲slot位置
     memcpy(page_handle.get_slot(slot_no), buf, file_hdr_.record_size);
+    page_handle.mark_dirty();
     // 返回插入的记录的记录号（位置）
-    return Rid{page_handle.page->get_page_id().page_no, slot_no};
+    return rid;
 }
 
 /**
@@ -73,10 +84,15 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
  * @param {char*} buf 要插入记录的数据
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
-    // 检查页面号是否有效
-    if (rid.page_no < file_hdr_.num_pages) {
+    check_writable();
+    // 指定的页面尚未分配时，先分配到该页面为止
+    while (rid.page_no >= file_hdr_.num_pages) {
         create_new_page_handle();
     }
+    if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+        insert_slotted_record(rid, buf);
+        return;
+    }
     // 获取指定记录所在的page handle
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
     // 更新记录
@@ -88,6 +104,7 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
         file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
     }
+    page_handle.mark_dirty();
 }
 
 /**
@@ -100,19 +117,25 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // 1. 获取指定记录所在的page handle
     // 2. 更新page_handle.page_hdr中的数据结构
     // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
+    check_writable();
     // 获取指定记录所在的page handle
     if (context) {
         context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
     }
+    if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+        delete_slotted_record(rid);
+        return;
+    }
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
     // 更新记录
     int slot_no = rid.slot_no;
     page_handle.page_hdr->num_records--;
     Bitmap::reset(page_handle.bitmap, slot_no);
-    // 如果删除一条记录后页面未满，则释放页面
-    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
+    // 如果删除前页面已满（删除后恰好空出一个位置），则将其重新加入空闲页面链表，之后的插入会复用其空间
+    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page - 1) {
         release_page_handle(page_handle);
     }
+    page_handle.mark_dirty();
 }
 
 
@@ -126,14 +149,65 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新记录
+    check_writable();
     // 获取指定记录所在的page handle
     if (context) {
         context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
     }
+    if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+        update_slotted_record(rid, buf);
+        return;
+    }
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
     // 更新记录
     int slot_no = rid.slot_no;
     memcpy(page_handle.get_slot(slot_no), buf, file_hdr_.record_size);
+    page_handle.mark_dirty();
+}
+
+/**
+ * @description: 提示内核将按顺序扫描映射中的页面，使其加大预读；没有映射时不做任何事
+ */
+void RmFileHandle::advise_sequential() const {
+    if (mapping_ != nullptr) {
+        madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+    }
+}
+
+RmFileHandle::~RmFileHandle() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
+}
+
+/**
+ * @description: 将整个文件以只读方式映射到内存中，之后的读取直接访问映射，不再经过缓冲池
+ * 压缩格式的文件或文件中缺少页面（有页面还没有写回）时无法映射，此时仍然通过缓冲池读取
+ */
+void RmFileHandle::map_file() {
+    if (disk_manager_->is_compressed(fd_)) {
+        return;
+    }
+    struct stat st;
+    size_t size = static_cast<size_t>(file_hdr_.num_pages) * PAGE_SIZE;
+    if (fstat(fd_, &st) == -1 || static_cast<size_t>(st.st_size) < size) {
+        return;
+    }
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+    mapping_ = static_cast<char *>(mapping);
+    mapping_size_ = size;
+}
+
+/**
+ * @description: 以只读方式打开的文件不允许修改，抛出TableReadOnlyError
+ */
+void RmFileHandle::check_writable() const {
+    if (read_only_) {
+        throw TableReadOnlyError(disk_manager_->get_file_name(fd_));
+    }
 }
 
 /**
@@ -142,9 +216,10 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
 /**
  * @description: 获取指定页面的页面句柄
  * @param {int} page_no 页面号
- * @return {RmPageHandle} 指定页面的句柄
+ * @param {BufferAccessStrategy*} strategy 缓冲池的访问策略，大表的顺序扫描使用BULK_READ策略
+ * @return {RmPageHandle} 指定页面的句柄，句柄析构时取消对页面的固定
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+RmPageHandle RmFileHandle::fetch_page_handle(int page_no, BufferAccessStrategy* strategy) const {
     // Todo:
     // 使用缓冲池获取指定页面，并生成page_handle返回给上层
     // if page_no is invalid, throw PageNotExistError exception
@@ -152,36 +227,42 @@ RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
     if (page_no == INVALID_PAGE_ID || page_no >= file_hdr_.num_pages) {
         throw PageNotExistError("page_no is invalid", page_no);
     }
+    // 只读方式打开的文件直接使用映射中的页面
+    if (mapping_ != nullptr) {
+        return RmPageHandle(&file_hdr_, mapping_ + static_cast<size_t>(page_no) * PAGE_SIZE);
+    }
     // 创建PageId对象
     PageId page_id;
     page_id.fd = fd_;
     page_id.page_no = page_no;
     // 从缓冲池中获取页面，并生成page_handle返回给上层
-    return RmPageHandle(&file_hdr_, buffer_pool_manager_->fetch_page(page_id));
+    return RmPageHandle(&file_hdr_, buffer_pool_manager_->fetch_page_basic(page_id, strategy));
 }
 
 /**
- * @description: 创建一个新的page handle
- * @return {RmPageHandle} 新的PageHandle
+ * @description: 创建一个新的page handle，新页面通过BULK_WRITE访问策略装入缓冲池
+ * @return {RmPageHandle} 新的PageHandle，新页面已被标记为脏页，句柄析构时取消对页面的固定
  */
 RmPageHandle RmFileHandle::create_new_page_handle() {
     // Todo:
     // 1.使用缓冲池来创建一个新page
     // 2.更新page handle中的相关信息
     // 3.更新file_hdr_
+    check_writable();
     // 创建新的页面
-    PageId* page_id = new PageId;
-    page_id->fd = fd_;
-    Page* page = buffer_pool_manager_->new_page(page_id);
-    RmPageHandle page_handle = RmPageHandle(&file_hdr_, page);
-    // 初始化页面头
-    page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
-    page_handle.page_hdr->num_records = 0;
-    // 初始化位图
-    Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    RmPageHandle page_handle(&file_hdr_, buffer_pool_manager_->new_page_guarded(&page_id, bulk_write_strategy_.get()));
+    // 初始化页面头和位图，槽式页面初始化页头
+    if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+        page_handle.slotted().init();
+    } else {
+        page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+        page_handle.page_hdr->num_records = 0;
+        Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
+    }
     // 更新文件头中的页面数量和第一个空闲页面的编号
     file_hdr_.num_pages++;
-    file_hdr_.first_free_page_no = page_id->page_no;
+    file_hdr_.first_free_page_no = page_id.page_no;
     return page_handle;
 }
 
@@ -189,7 +270,7 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
  * @brief 创建或获取一个空闲的page handle
  *
  * @return RmPageHandle 返回生成的空闲page handle
- * @note pin the page, remember to unpin it outside!
+ * @note 返回的句柄持有页面的固定，析构时取消固定
  */
 RmPageHandle RmFileHandle::create_page_handle() {
     // Todo:
@@ -214,4 +295,174 @@ void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
     // 更新页面头和文件头中的空闲页面信息
     page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
     file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
+}
+/**
+ * @description: 读取槽式页面中的记录，已转发的记录到新位置读取，并解码为定长的记录
+ * @param {RmPageHandle&} page_handle 记录原来所在页面的句柄
+ * @param {Rid&} rid 记录号
+ * @return {unique_ptr<RmRecord>} 记录对象指针，记录不存在时抛出RecordNotFoundError
+ */
+std::unique_ptr<RmRecord> RmFileHandle::get_slotted_record(const RmPageHandle& page_handle, const Rid& rid) const {
+    RmSlottedPage page = page_handle.slotted();
+    if (!page.is_record(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+    if (page.is_forward(rid.slot_no)) {
+        Rid target;
+        memcpy(&target, page.get_tuple(rid.slot_no), sizeof(Rid));
+        RmPageHandle target_handle = fetch_page_handle(target.page_no);
+        RmSlottedPage::decode(file_hdr_, target_handle.slotted().get_tuple(target.slot_no), record->data);
+    } else {
+        RmSlottedPage::decode(file_hdr_, page.get_tuple(rid.slot_no), record->data);
+    }
+    return record;
+}
+
+/**
+ * @description: 在槽式页面格式的表中插入一条记录，不指定插入位置
+ * 元组的位置在放入页面时才能确定，因此插入后再加锁，加锁失败时撤销插入
+ * @param {char*} buf 要插入的记录的数据
+ * @param {Context*} context
+ * @return {Rid} 插入的记录的记录号
+ */
+Rid RmFileHandle::insert_slotted_record(char* buf, Context* context) {
+    char tuple[PAGE_SIZE];
+    int len = RmSlottedPage::encode(file_hdr_, buf, tuple);
+    Rid rid = insert_tuple(tuple, len, 0);
+    if (context) {
+        try {
+            context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+        } catch (...) {
+            erase_tuple(rid);
+            throw;
+        }
+    }
+    return rid;
+}
+
+/**
+ * @description: 在槽式页面格式的表中的指定位置插入一条记录，用于事务回滚时恢复被删除的记录
+ * 原页面放不下时把元组放到其他页面，原来的槽中存放转发的Rid，记录号保持不变
+ * @param {Rid&} rid 要插入记录的位置
+ * @param {char*} buf 要插入记录的数据
+ */
+void RmFileHandle::insert_slotted_record(const Rid& rid, char* buf) {
+    char tuple[PAGE_SIZE];
+    int len = RmSlottedPage::encode(file_hdr_, buf, tuple);
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    RmSlottedPage page = page_handle.slotted();
+    if (!page.insert_at(rid.slot_no, tuple, len, 0)) {
+        Rid target = insert_tuple(tuple, len, RM_SLOT_MOVED);
+        if (!page.insert_at(rid.slot_no, reinterpret_cast<char*>(&target), sizeof(Rid), RM_SLOT_FORWARD)) {
+            erase_tuple(target);
+            throw InternalError("RmFileHandle::insert_record: no space to restore record");
+        }
+    }
+    // 页面剩余空间变少后仍可能留在空闲页面链表中，插入时发现放不下再移出
+    page_handle.mark_dirty();
+}
+
+/**
+ * @description: 删除槽式页面格式的表中的记录，已转发的记录同时删除新位置上的元组
+ * @param {Rid&} rid 要删除的记录的记录号
+ */
+void RmFileHandle::delete_slotted_record(const Rid& rid) {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    RmSlottedPage page = page_handle.slotted();
+    if (!page.is_record(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    if (page.is_forward(rid.slot_no)) {
+        Rid target;
+        memcpy(&target, page.get_tuple(rid.slot_no), sizeof(Rid));
+        erase_tuple(target);
+    }
+    page.erase(rid.slot_no);
+    update_free_list(page_handle);
+    page_handle.mark_dirty();
+}
+
+/**
+ * @description: 更新槽式页面格式的表中的记录，记录号保持不变
+ * 新元组在当前位置放不下时移到其他页面，原来的槽改为存放转发的Rid；已转发的记录优先在原页面中放回
+ * @param {Rid&} rid 要更新的记录的记录号
+ * @param {char*} buf 新记录的数据
+ */
+void RmFileHandle::update_slotted_record(const Rid& rid, char* buf) {
+    char tuple[PAGE_SIZE];
+    int len = RmSlottedPage::encode(file_hdr_, buf, tuple);
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    RmSlottedPage page = page_handle.slotted();
+    if (!page.is_record(rid.slot_no)) {
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    if (page.is_forward(rid.slot_no)) {
+        Rid target;
+        memcpy(&target, page.get_tuple(rid.slot_no), sizeof(Rid));
+        {
+            RmPageHandle target_handle = fetch_page_handle(target.page_no);
+            if (target_handle.slotted().update(target.slot_no, tuple, len, RM_SLOT_MOVED)) {
+                update_free_list(target_handle);
+                target_handle.mark_dirty();
+                return;
+            }
+        }
+        erase_tuple(target);
+    }
+    if (!page.update(rid.slot_no, tuple, len, 0)) {
+        // 原页面放不下，转发的Rid不超过元组的最小空间，总能放在原来的位置上
+        Rid target = insert_tuple(tuple, len, RM_SLOT_MOVED);
+        page.update(rid.slot_no, reinterpret_cast<char*>(&target), sizeof(Rid), RM_SLOT_FORWARD);
+    }
+    update_free_list(page_handle);
+    page_handle.mark_dirty();
+}
+
+/**
+ * @description: 把元组放入空闲页面链表中第一个能放下它的页面，链表头部放不下的页面移出链表
+ * @param {char*} tuple 元组的数据
+ * @param {int} len 元组的长度
+ * @param {uint16_t} flags 槽的标记
+ * @return {Rid} 元组的位置
+ */
+Rid RmFileHandle::insert_tuple(const char* tuple, int len, uint16_t flags) {
+    while (true) {
+        RmPageHandle page_handle = create_page_handle();
+        RmSlottedPage page = page_handle.slotted();
+        int slot_no = page.insert(tuple, len, flags);
+        // 插入失败或插入后剩余空间不足时，页面移出空闲页面链表；该页面一定是链表头
+        if (slot_no == RM_NO_SLOT || page.get_free_bytes() < free_space_threshold()) {
+            file_hdr_.first_free_page_no = page.get_hdr()->next_free_page_no;
+            page.get_hdr()->next_free_page_no = RM_NO_PAGE;
+            page.get_hdr()->in_free_list = 0;
+        }
+        page_handle.mark_dirty();
+        if (slot_no != RM_NO_SLOT) {
+            return Rid{page_handle.page->get_page_id().page_no, slot_no};
+        }
+    }
+}
+
+/**
+ * @description: 删除指定位置上的元组，不检查是否为转发的记录
+ * @param {Rid&} rid 元组的位置
+ */
+void RmFileHandle::erase_tuple(const Rid& rid) {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    page_handle.slotted().erase(rid.slot_no);
+    update_free_list(page_handle);
+    page_handle.mark_dirty();
+}
+
+/**
+ * @description: 槽式页面的剩余空间重新达到free_space_threshold()时，将其放回空闲页面链表
+ * @param {RmPageHandle&} page_handle 被修改的页面的句柄
+ */
+void RmFileHandle::update_free_list(RmPageHandle& page_handle) {
+    RmSlottedPage page = page_handle.slotted();
+    if (!page.get_hdr()->in_free_list && page.get_free_bytes() >= free_space_threshold()) {
+        release_page_handle(page_handle);
+        page.get_hdr()->in_free_list = 1;
+    }
 }
\ No newline at end of file
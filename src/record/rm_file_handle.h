@@ -17,27 +17,53 @@ See the Mulan PSL v2 for more details. */
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_slotted_page.h"
 
 class RmManager;
 
-/* 对表数据文件中的页面进行封装 */
+/* 对表数据文件中的页面进行封装，句柄持有页面的固定，析构时自动取消固定；只能移动，不能复制 */
 struct RmPageHandle {
     const RmFileHdr *file_hdr;  // 当前页面所在文件的文件头指针
+    BasicPageGuard guard;       // 固定页面的guard，修改页面后需调用mark_dirty()
     Page *page;                 // 页面的实际数据，包括页面存储的数据、元信息等
     RmPageHdr *page_hdr;        // page->data的第一部分，存储页面元信息，指针指向首地址，长度为sizeof(RmPageHdr)
     char *bitmap;               // page->data的第二部分，存储页面的bitmap，指针指向首地址，长度为file_hdr->bitmap_size
     char *slots;                // page->data的第三部分，存储表的记录，指针指向首地址，每个slot的长度为file_hdr->record_size
+                                // 槽式页面格式下bitmap和slots不使用，页面通过slotted()访问
 
-    RmPageHandle(const RmFileHdr *fhdr_, Page *page_) : file_hdr(fhdr_), page(page_) {
+    RmPageHandle(const RmFileHdr *fhdr_, BasicPageGuard &&guard_)
+        : file_hdr(fhdr_), guard(std::move(guard_)), page(guard.get_page()) {
         page_hdr = reinterpret_cast<RmPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR);
         bitmap = page->get_data() + sizeof(RmPageHdr) + page->OFFSET_PAGE_HDR;
         slots = bitmap + file_hdr->bitmap_size;
     }
 
+    // 只读映射中的页面，没有对应的Page，page为nullptr，数据不能修改
+    RmPageHandle(const RmFileHdr *fhdr_, char *data) : file_hdr(fhdr_), page(nullptr) {
+        page_hdr = reinterpret_cast<RmPageHdr *>(data + Page::OFFSET_PAGE_HDR);
+        bitmap = data + sizeof(RmPageHdr) + Page::OFFSET_PAGE_HDR;
+        slots = bitmap + file_hdr->bitmap_size;
+    }
+
+    // 标记页面被修改，句柄析构时页面作为脏页取消固定
+    void mark_dirty() { guard.mark_dirty(); }
+
     // 返回指定slot_no的slot存储收地址
     char* get_slot(int slot_no) const {
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // 槽式页面格式下页面的视图
+    RmSlottedPage slotted() const { return RmSlottedPage(reinterpret_cast<char *>(page_hdr) - Page::OFFSET_PAGE_HDR); }
+
+    // 返回slot_no之后下一条记录的槽号，没有时返回RM_NO_SLOT；传入-1时从第一个槽开始
+    int next_record(int slot_no) const {
+        if (file_hdr->format == RM_FORMAT_SLOTTED) {
+            return slotted().next_record(slot_no);
+        }
+        int next = Bitmap::next_bit(true, bitmap, file_hdr->num_records_per_page, slot_no);
+        return next < file_hdr->num_records_per_page ? next : RM_NO_SLOT;
+    }
 };
 
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
@@ -50,24 +76,46 @@ class RmFileHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    bool read_only_ = false;    // 以只读方式打开，不允许修改记录
+    char *mapping_ = nullptr;   // 只读方式打开时整个文件的内存映射，页面直接从映射中读取，不经过缓冲池
+    size_t mapping_size_ = 0;
+    std::unique_ptr<BufferAccessStrategy> bulk_write_strategy_;   // 新建页面使用的BULK_WRITE访问策略，批量插入不挤出缓冲池中的其他页面
 
    public:
-    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
-        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, bool read_only = false)
+        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd), read_only_(read_only) {
         // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
         // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
         // init file_hdr_
         disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        if (read_only_) {
+            map_file();
+        } else {
+            bulk_write_strategy_ = buffer_pool_manager_->create_access_strategy(BULK_WRITE);
+        }
     }
 
+    RmFileHandle(const RmFileHandle &) = delete;
+
+    ~RmFileHandle();
+
     RmFileHdr get_file_hdr() { return file_hdr_; }
     int GetFd() { return fd_; }
 
-    /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
+    bool is_read_only() const { return read_only_; }
+
+    bool is_mapped() const { return mapping_ != nullptr; }
+
+    void advise_sequential() const;
+
+    /* 判断指定位置上是否已经存在一条记录，定长格式通过Bitmap来判断，槽式页面格式通过槽目录来判断 */
     bool is_record(const Rid &rid) const {
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+        if (file_hdr_.format == RM_FORMAT_SLOTTED) {
+            return page_handle.slotted().is_record(rid.slot_no);
+        }
         return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
     }
 
@@ -83,10 +131,35 @@ class RmFileHandle {
 
     RmPageHandle create_new_page_handle();
 
-    RmPageHandle fetch_page_handle(int page_no) const;
+    RmPageHandle fetch_page_handle(int page_no, BufferAccessStrategy *strategy = nullptr) const;
 
    private:
+    void map_file();
+
+    void check_writable() const;
+
     RmPageHandle create_page_handle();
 
     void release_page_handle(RmPageHandle &page_handle);
+
+    std::unique_ptr<RmRecord> get_slotted_record(const RmPageHandle &page_handle, const Rid &rid) const;
+
+    Rid insert_slotted_record(char *buf, Context *context);
+
+    void insert_slotted_record(const Rid &rid, char *buf);
+
+    void delete_slotted_record(const Rid &rid);
+
+    void update_slotted_record(const Rid &rid, char *buf);
+
+    Rid insert_tuple(const char *tuple, int len, uint16_t flags);
+
+    void erase_tuple(const Rid &rid);
+
+    void update_free_list(RmPageHandle &page_handle);
+
+    // 槽式页面中剩余空间不少于该值时才放入空闲页面链表，保证链表中的页面能放下任意一条记录
+    int free_space_threshold() const {
+        return RmSlottedPage::max_tuple_size(file_hdr_) + static_cast<int>(sizeof(RmSlot));
+    }
 };
\ No newline at end of file
@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <vector>
+
 #include "bitmap.h"
 #include "rm_defs.h"
 #include "rm_file_handle.h"
@@ -30,28 +32,52 @@ class RmManager {
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
      * @param {int} record_size 表中记录的大小
+     * @param {bool} compressed 是否以页面压缩格式存储
      */ 
-    void create_file(const std::string& filename, int record_size) {
+    void create_file(const std::string& filename, int record_size, bool compressed = false) {
         if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
             throw InvalidRecordSizeError(record_size);
         }
-        disk_manager_->create_file(filename);
-        int fd = disk_manager_->open_file(filename);
-
         // 初始化file header
         RmFileHdr file_hdr{};
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+        file_hdr.format = RM_FORMAT_FIXED;
+        // 页面中除去页面LSN、页头和页尾的校验和之后的空间存放bitmap和记录
+        // We have: (n + 7) / 8 + n * record_size <= space
+        int space = PAGE_SIZE - Page::OFFSET_PAGE_HDR - (int)sizeof(RmPageHdr) - PAGE_CHECKSUM_SIZE;
+        file_hdr.num_records_per_page = (BITMAP_WIDTH * (space - 1) + 1) / (1 + record_size * BITMAP_WIDTH);
         file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        write_new_file(filename, file_hdr, compressed);
+    }
 
-        // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
-        // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
-        disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
-        disk_manager_->close_file(fd);
+    /**
+     * @description: 创建槽式页面格式的表数据文件，变长字段在页面中只存放实际长度，记录的最大长度只受页面大小限制
+     * @param {string&} filename 要创建的文件名称
+     * @param {int} record_size 表中记录在内存中的大小，变长字段按最大长度计算
+     * @param {vector<RmVarCol>&} var_cols 记录中的变长字段，按偏移量排序，最多RM_MAX_VAR_COLS个
+     * @param {bool} compressed 是否以页面压缩格式存储
+     */
+    void create_slotted_file(const std::string& filename, int record_size, const std::vector<RmVarCol>& var_cols,
+                             bool compressed = false) {
+        assert(var_cols.size() <= RM_MAX_VAR_COLS);
+        RmFileHdr file_hdr{};
+        file_hdr.record_size = record_size;
+        file_hdr.num_pages = 1;
+        file_hdr.first_free_page_no = RM_NO_PAGE;
+        file_hdr.format = RM_FORMAT_SLOTTED;
+        file_hdr.num_var_cols = static_cast<int>(var_cols.size());
+        std::copy(var_cols.begin(), var_cols.end(), file_hdr.var_cols);
+        // 一个页面至少要能放下一条最长的记录
+        if (record_size < 1 ||
+            RmSlottedPage::max_tuple_size(file_hdr) + (int)sizeof(RmSlot) > RM_SLOTTED_PAGE_CAPACITY) {
+            throw InvalidRecordSizeError(record_size);
+        }
+        // 槽号的上界，空槽只占用槽目录中的一项
+        file_hdr.num_records_per_page = RM_SLOTTED_PAGE_CAPACITY / (int)sizeof(RmSlot);
+        file_hdr.bitmap_size = 0;
+        write_new_file(filename, file_hdr, compressed);
     }
 
     /**
@@ -64,21 +90,43 @@ class RmManager {
     /**
      * @description: 打开表的数据文件，并返回文件句柄
      * @param {string&} filename 要打开的文件名称
+     * @param {bool} read_only 是否以只读方式打开，只读时页面通过内存映射直接读取，不经过缓冲池
      * @return {unique_ptr<RmFileHandle>} 文件句柄的指针
      */
-    std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
+    std::unique_ptr<RmFileHandle> open_file(const std::string& filename, bool read_only = false) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd, read_only);
     }
     /**
      * @description: 关闭表的数据文件
      * @param {RmFileHandle*} file_handle 要关闭文件的句柄
      */
     void close_file(const RmFileHandle* file_handle) {
-        disk_manager_->write_page(file_handle->fd_, RM_FILE_HDR_PAGE, (char *)&file_handle->file_hdr_,
-                                  sizeof(file_handle->file_hdr_));
+        // 只读方式打开时文件头没有修改，不需要写回
+        if (!file_handle->read_only_) {
+            disk_manager_->write_page(file_handle->fd_, RM_FILE_HDR_PAGE, (char *)&file_handle->file_hdr_,
+                                      sizeof(file_handle->file_hdr_));
+        }
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
+        // 关闭后fd可能被其他文件复用，不能在缓冲池中留下该文件的页面
+        buffer_pool_manager_->discard_file_pages(file_handle->fd_);
         disk_manager_->close_file(file_handle->fd_);
     }
+
+   private:
+    /**
+     * @description: 创建数据文件并写入文件头
+     * @param {string&} filename 要创建的文件名称
+     * @param {RmFileHdr&} file_hdr 初始化好的文件头
+     * @param {bool} compressed 是否以页面压缩格式存储
+     */
+    void write_new_file(const std::string& filename, const RmFileHdr& file_hdr, bool compressed) {
+        disk_manager_->create_file(filename, compressed);
+        int fd = disk_manager_->open_file(filename);
+        // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
+        // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
+        disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (const char *)&file_hdr, sizeof(file_hdr));
+        disk_manager_->close_file(fd);
+    }
 };
@@ -9,6 +9,9 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "rm_scan.h"
+
+#include <algorithm>
+
 #include "rm_file_handle.h"
 
 /**
@@ -18,6 +21,21 @@ See the Mulan PSL v2 for more details. */
 RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
+    file_handle_->advise_sequential();
+    BufferPoolManager *buffer_pool_manager = file_handle_->buffer_pool_manager_;
+    size_t num_pages = file_handle_->file_hdr_.num_pages;
+    if (!file_handle_->is_mapped() && num_pages > buffer_pool_manager->get_pool_size() / BULK_READ_THRESHOLD) {
+        strategy_ = buffer_pool_manager->create_access_strategy(BULK_READ);
+    }
+    if (!file_handle_->is_mapped()) {
+        // 使用环形缓冲区时，环中同时有正在扫描的窗口和预读的窗口，窗口过大时预读的页面还没扫描到就被环复用
+        read_ahead_max_ = READ_AHEAD_MAX_PAGES;
+        if (strategy_ != nullptr) {
+            read_ahead_max_ = std::max<int>(1, std::min<int>(read_ahead_max_, strategy_->get_ring_size() / 4));
+        }
+        read_ahead_size_ = std::min(READ_AHEAD_MIN_PAGES, read_ahead_max_);
+        read_ahead();
+    }
     rid_ = Rid{RM_FIRST_RECORD_PAGE, -1};
     next();
 }
@@ -29,10 +47,14 @@ void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
     // 对于当前页面，可以用bitmap来找bit为1的slot_no。如果当前页面的所有slot都没有存放record，就找下一个页面。
+    // 槽式页面格式通过槽目录查找，跳过从其他页面移来的元组，这些元组通过原来的槽返回
     while (true) {
-        RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
-        rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page, rid_.slot_no);
-        if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
+        if (rid_.page_no == read_ahead_trigger_) {
+            read_ahead();
+        }
+        RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no, strategy_.get());
+        rid_.slot_no = page_handle.next_record(rid_.slot_no);
+        if (rid_.slot_no != RM_NO_SLOT) {
             return;
         }
         rid_.slot_no = -1;
@@ -48,6 +70,25 @@ void RmScan::next() {
 /**
  * @brief ​ 判断是否到达文件末尾
  */
+/**
+ * @description: 提交下一个预读窗口，之后扫描到窗口的第一页时再提交再下一个窗口；
+ * 窗口中的页面都已在缓冲池中时，预读没有作用，窗口缩回初始大小，否则加倍，直到read_ahead_max_
+ */
+void RmScan::read_ahead() {
+    int num_pages = file_handle_->file_hdr_.num_pages;
+    if (read_ahead_next_ >= num_pages) {
+        read_ahead_trigger_ = RM_NO_PAGE;
+        return;
+    }
+    int size = std::min(read_ahead_size_, num_pages - read_ahead_next_);
+    int num_submitted = file_handle_->buffer_pool_manager_->prefetch({.fd = file_handle_->fd_, .page_no = read_ahead_next_},
+                                                                     size, strategy_.get());
+    read_ahead_trigger_ = read_ahead_next_;
+    read_ahead_next_ += size;
+    read_ahead_size_ = num_submitted == 0 ? std::min(READ_AHEAD_MIN_PAGES, read_ahead_max_)
+                                          : std::min(read_ahead_size_ * 2, read_ahead_max_);
+}
+
 bool RmScan::is_end() const {
     // Todo: 修改返回值
     return rid_.page_no == RM_NO_PAGE;
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+
 #include "rm_defs.h"
 
 class RmFileHandle;
@@ -17,6 +19,15 @@ class RmFileHandle;
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    std::unique_ptr<BufferAccessStrategy> strategy_;    // 大表使用BULK_READ访问策略，扫描只在一小圈帧中循环，不挤出缓冲池中的其他页面
+    // 预读：扫描到上一个窗口的第一页时提交下一个窗口，使始终有一个窗口的页面在异步读入
+    page_id_t read_ahead_next_ = RM_FIRST_RECORD_PAGE;  // 下一个预读窗口的第一页
+    page_id_t read_ahead_trigger_ = RM_NO_PAGE;         // 扫描到该页时提交下一个窗口
+    int read_ahead_size_ = 0;       // 下一个窗口的页面数，为0时不预读
+    int read_ahead_max_ = 0;        // 窗口的最大页面数
+
+    void read_ahead();
+
 public:
     RmScan(const RmFileHandle *file_handle);
 
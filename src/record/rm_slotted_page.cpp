@@ -0,0 +1,232 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "rm_slotted_page.h"
+
+#include <cassert>
+
+/**
+ * @description: 初始化一个新分配的槽式页面，新页面会被放入空闲页面链表
+ */
+void RmSlottedPage::init() {
+    hdr_->next_free_page_no = RM_NO_PAGE;
+    hdr_->num_records = 0;
+    hdr_->num_slots = 0;
+    hdr_->tuple_start = RM_SLOTTED_PAGE_END;
+    hdr_->free_bytes = RM_SLOTTED_PAGE_CAPACITY;
+    hdr_->in_free_list = 1;
+}
+
+/**
+ * @description: 获取slot_no之后的下一条记录的槽号，跳过空槽和从其他页面移来的元组
+ * @return {int} 下一条记录的槽号，没有时返回RM_NO_SLOT
+ * @param {int} slot_no 从该槽之后开始查找，传入-1时从第一个槽开始
+ */
+int RmSlottedPage::next_record(int slot_no) const {
+    for (int i = slot_no + 1; i < hdr_->num_slots; i++) {
+        if (is_record(i)) {
+            return i;
+        }
+    }
+    return RM_NO_SLOT;
+}
+
+/**
+ * @description: 在页面中插入一个元组，优先复用空槽
+ * @return {int} 元组所在的槽号，页面空间不足时返回RM_NO_SLOT
+ * @param {char*} tuple 元组的数据
+ * @param {int} len 元组的长度
+ * @param {uint16_t} flags 槽的标记，RM_SLOT_FORWARD或RM_SLOT_MOVED
+ */
+int RmSlottedPage::insert(const char *tuple, int len, uint16_t flags) {
+    int slot_no = 0;
+    while (slot_no < hdr_->num_slots && get_slot(slot_no)->offset != 0) {
+        slot_no++;
+    }
+    return insert_at(slot_no, tuple, len, flags) ? slot_no : RM_NO_SLOT;
+}
+
+/**
+ * @description: 在指定的槽中插入一个元组，槽号超出槽目录时扩展槽目录，用于事务回滚时恢复被删除的记录
+ * @return {bool} 页面空间不足时返回false，页面不做修改
+ * @param {int} slot_no 槽号，该槽必须为空
+ * @param {char*} tuple 元组的数据
+ * @param {int} len 元组的长度
+ * @param {uint16_t} flags 槽的标记
+ */
+bool RmSlottedPage::insert_at(int slot_no, const char *tuple, int len, uint16_t flags) {
+    assert(slot_no >= hdr_->num_slots || get_slot(slot_no)->offset == 0);
+    int new_slots = std::max(0, slot_no + 1 - static_cast<int>(hdr_->num_slots));
+    int need = alloc_size(len) + new_slots * static_cast<int>(sizeof(RmSlot));
+    if (hdr_->free_bytes < need) {
+        return false;
+    }
+    reserve(need);
+    for (int i = 0; i < new_slots; i++) {
+        RmSlot *slot = get_slot(hdr_->num_slots++);
+        slot->offset = 0;
+        slot->length = 0;
+    }
+    hdr_->free_bytes -= new_slots * sizeof(RmSlot);
+    place(slot_no, tuple, len, flags);
+    if ((flags & RM_SLOT_MOVED) == 0) {
+        hdr_->num_records++;
+    }
+    return true;
+}
+
+/**
+ * @description: 更新槽中的元组，槽号不变；新元组不比原来的长时原地覆盖，否则在页面中重新分配空间
+ * @return {bool} 页面空间不足时返回false，页面不做修改
+ * @param {int} slot_no 槽号，该槽必须存放了元组
+ * @param {char*} tuple 新元组的数据，不能指向当前页面
+ * @param {int} len 新元组的长度
+ * @param {uint16_t} flags 新的槽标记，更新不改变元组是否是移来的
+ */
+bool RmSlottedPage::update(int slot_no, const char *tuple, int len, uint16_t flags) {
+    RmSlot *slot = get_slot(slot_no);
+    assert(slot->offset != 0 && (slot->length & RM_SLOT_MOVED) == (flags & RM_SLOT_MOVED));
+    int old_size = alloc_size(slot->length & RM_SLOT_LENGTH_MASK);
+    int new_size = alloc_size(len);
+    if (new_size <= old_size) {
+        // 缩短的部分成为碎片，下次整理时回收
+        memcpy(data_ + slot->offset, tuple, len);
+        slot->length = static_cast<uint16_t>(len) | flags;
+        hdr_->free_bytes += old_size - new_size;
+        return true;
+    }
+    if (hdr_->free_bytes + old_size < new_size) {
+        return false;
+    }
+    // 先释放原来的空间，整理时该元组不再保留
+    slot->offset = 0;
+    hdr_->free_bytes += old_size;
+    reserve(new_size);
+    place(slot_no, tuple, len, flags);
+    return true;
+}
+
+/**
+ * @description: 删除槽中的元组，槽目录末尾的空槽会被回收
+ * @param {int} slot_no 槽号，该槽必须存放了元组
+ */
+void RmSlottedPage::erase(int slot_no) {
+    RmSlot *slot = get_slot(slot_no);
+    assert(slot->offset != 0);
+    if ((slot->length & RM_SLOT_MOVED) == 0) {
+        hdr_->num_records--;
+    }
+    hdr_->free_bytes += alloc_size(slot->length & RM_SLOT_LENGTH_MASK);
+    slot->offset = 0;
+    slot->length = 0;
+    while (hdr_->num_slots > 0 && get_slot(hdr_->num_slots - 1)->offset == 0) {
+        hdr_->num_slots--;
+        hdr_->free_bytes += sizeof(RmSlot);
+    }
+}
+
+/**
+ * @description: 保证槽目录和元组区之间至少有size字节的连续空间，调用者已确认free_bytes足够
+ * @param {int} size 需要的连续空间大小
+ */
+void RmSlottedPage::reserve(int size) {
+    if (contiguous_free_bytes() < size) {
+        compact();
+    }
+    assert(contiguous_free_bytes() >= size);
+}
+
+/**
+ * @description: 在元组区的起始处为元组分配空间并写入，调用者已通过reserve保证连续空间足够，free_bytes中尚未扣除这部分空间
+ */
+void RmSlottedPage::place(int slot_no, const char *tuple, int len, uint16_t flags) {
+    int size = alloc_size(len);
+    hdr_->tuple_start -= size;
+    hdr_->free_bytes -= size;
+    memcpy(data_ + hdr_->tuple_start, tuple, len);
+    RmSlot *slot = get_slot(slot_no);
+    slot->offset = hdr_->tuple_start;
+    slot->length = static_cast<uint16_t>(len) | flags;
+}
+
+/**
+ * @description: 整理元组区，把所有元组紧密地移到页尾，碎片合并到连续空闲空间中；槽号不变，只修改槽中的偏移
+ */
+void RmSlottedPage::compact() {
+    char buf[PAGE_SIZE];
+    int end = RM_SLOTTED_PAGE_END;
+    for (int i = 0; i < hdr_->num_slots; i++) {
+        RmSlot *slot = get_slot(i);
+        if (slot->offset == 0) {
+            continue;
+        }
+        int size = alloc_size(slot->length & RM_SLOT_LENGTH_MASK);
+        end -= size;
+        memcpy(buf + end, data_ + slot->offset, size);
+        slot->offset = end;
+    }
+    memcpy(data_ + end, buf + end, RM_SLOTTED_PAGE_END - end);
+    hdr_->tuple_start = end;
+    assert(contiguous_free_bytes() == hdr_->free_bytes);
+}
+
+/**
+ * @description: 把内存中定长的记录编码为元组，变长字段只保留去掉末尾填充0之后的内容
+ * @return {int} 元组的长度
+ * @param {RmFileHdr&} file_hdr 文件头，提供记录长度和变长字段的位置
+ * @param {char*} record 记录的数据，长度为record_size
+ * @param {char*} tuple 存放元组的缓冲区，至少为max_tuple_size字节
+ */
+int RmSlottedPage::encode(const RmFileHdr &file_hdr, const char *record, char *tuple) {
+    char *dst = tuple;
+    int pos = 0;
+    for (int i = 0; i < file_hdr.num_var_cols; i++) {
+        const RmVarCol &col = file_hdr.var_cols[i];
+        memcpy(dst, record + pos, col.offset - pos);
+        dst += col.offset - pos;
+        uint16_t len = static_cast<uint16_t>(col.len);
+        while (len > 0 && record[col.offset + len - 1] == '\0') {
+            len--;
+        }
+        memcpy(dst, &len, sizeof(len));
+        dst += sizeof(len);
+        memcpy(dst, record + col.offset, len);
+        dst += len;
+        pos = col.offset + col.len;
+    }
+    memcpy(dst, record + pos, file_hdr.record_size - pos);
+    dst += file_hdr.record_size - pos;
+    return static_cast<int>(dst - tuple);
+}
+
+/**
+ * @description: 把元组解码为内存中定长的记录，变长字段不足最大长度的部分填0
+ * @param {RmFileHdr&} file_hdr 文件头，提供记录长度和变长字段的位置
+ * @param {char*} tuple 元组的数据
+ * @param {char*} record 存放记录的缓冲区，长度为record_size
+ */
+void RmSlottedPage::decode(const RmFileHdr &file_hdr, const char *tuple, char *record) {
+    const char *src = tuple;
+    int pos = 0;
+    for (int i = 0; i < file_hdr.num_var_cols; i++) {
+        const RmVarCol &col = file_hdr.var_cols[i];
+        memcpy(record + pos, src, col.offset - pos);
+        src += col.offset - pos;
+        uint16_t len;
+        memcpy(&len, src, sizeof(len));
+        src += sizeof(len);
+        memcpy(record + col.offset, src, len);
+        memset(record + col.offset + len, 0, col.len - len);
+        src += len;
+        pos = col.offset + col.len;
+    }
+    memcpy(record + pos, src, file_hdr.record_size - pos);
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "rm_defs.h"
+
+/* 槽式页面的页头，前两个字段与RmPageHdr相同，空闲页面链表的维护与定长格式共用 */
+struct RmSlottedPageHdr {
+    int next_free_page_no;  // 下一个包含空闲空间的页面号
+    int num_records;        // 页面中的记录个数，不包括从其他页面移来的元组
+    uint16_t num_slots;     // 槽目录中的槽数，包括被删除记录留下的空槽
+    uint16_t tuple_start;   // 元组区的起始偏移，元组区为[tuple_start, RM_SLOTTED_PAGE_END)
+    uint16_t free_bytes;    // 空闲字节数，包括元组被删除或缩短后在元组区中留下的碎片
+    uint16_t in_free_list;  // 页面是否在文件的空闲页面链表中
+};
+
+/* 槽目录中的一项，槽号即Rid中的slot_no，元组在页面内移动时槽号不变 */
+struct RmSlot {
+    uint16_t offset;    // 元组在页面中的偏移，为0表示空槽
+    uint16_t length;    // 低14位为元组的长度，高两位为RM_SLOT_FORWARD/RM_SLOT_MOVED标记
+};
+
+constexpr uint16_t RM_SLOT_FORWARD = 0x8000;        // 元组更新后原页面放不下，已移到其他页面，槽中存放新位置的Rid
+constexpr uint16_t RM_SLOT_MOVED = 0x4000;          // 从其他页面移来的元组，只能通过原来的槽访问，扫描时跳过
+constexpr uint16_t RM_SLOT_LENGTH_MASK = 0x3fff;
+constexpr int RM_MIN_TUPLE_SIZE = sizeof(Rid);      // 元组至少占用的空间，保证原位置总能改写为转发的Rid
+constexpr int RM_SLOTTED_PAGE_BEGIN = Page::OFFSET_PAGE_HDR + sizeof(RmSlottedPageHdr);
+constexpr int RM_SLOTTED_PAGE_END = PAGE_SIZE - PAGE_CHECKSUM_SIZE;     // 页尾留给缓冲池存放校验和
+constexpr int RM_SLOTTED_PAGE_CAPACITY = RM_SLOTTED_PAGE_END - RM_SLOTTED_PAGE_BEGIN;
+
+/**
+ * @description: 槽式页面的视图，不持有页面；页头之后是向后增长的槽目录，元组从页尾开始向前存放，
+ * 两者之间是连续的空闲空间，空间不够但碎片足够时整理元组区
+ * 元组是记录的紧凑编码：定长字段原样存放，变长字段存放2字节的实际长度和去掉末尾填充0之后的内容
+ */
+class RmSlottedPage {
+   public:
+    explicit RmSlottedPage(char *data)
+        : data_(data), hdr_(reinterpret_cast<RmSlottedPageHdr *>(data + Page::OFFSET_PAGE_HDR)) {}
+
+    void init();
+
+    RmSlottedPageHdr *get_hdr() const { return hdr_; }
+
+    int get_num_slots() const { return hdr_->num_slots; }
+
+    int get_free_bytes() const { return hdr_->free_bytes; }
+
+    // 槽中是否存放了一条记录（包括已转发到其他页面的记录），从其他页面移来的元组不算
+    bool is_record(int slot_no) const {
+        return slot_no >= 0 && slot_no < hdr_->num_slots && get_slot(slot_no)->offset != 0 &&
+               (get_slot(slot_no)->length & RM_SLOT_MOVED) == 0;
+    }
+
+    bool is_forward(int slot_no) const { return (get_slot(slot_no)->length & RM_SLOT_FORWARD) != 0; }
+
+    char *get_tuple(int slot_no) const { return data_ + get_slot(slot_no)->offset; }
+
+    int get_tuple_len(int slot_no) const { return get_slot(slot_no)->length & RM_SLOT_LENGTH_MASK; }
+
+    int next_record(int slot_no) const;
+
+    int insert(const char *tuple, int len, uint16_t flags);
+
+    bool insert_at(int slot_no, const char *tuple, int len, uint16_t flags);
+
+    bool update(int slot_no, const char *tuple, int len, uint16_t flags);
+
+    void erase(int slot_no);
+
+    static int encode(const RmFileHdr &file_hdr, const char *record, char *tuple);
+
+    static void decode(const RmFileHdr &file_hdr, const char *tuple, char *record);
+
+    // 一条记录编码后最多占用的空间
+    static int max_tuple_size(const RmFileHdr &file_hdr) {
+        return alloc_size(file_hdr.record_size + file_hdr.num_var_cols * static_cast<int>(sizeof(uint16_t)));
+    }
+
+   private:
+    RmSlot *get_slot(int slot_no) const {
+        return reinterpret_cast<RmSlot *>(data_ + RM_SLOTTED_PAGE_BEGIN) + slot_no;
+    }
+
+    static int alloc_size(int len) { return std::max(len, RM_MIN_TUPLE_SIZE); }
+
+    // 槽目录和元组区之间连续的空闲空间
+    int contiguous_free_bytes() const {
+        return hdr_->tuple_start - RM_SLOTTED_PAGE_BEGIN - hdr_->num_slots * static_cast<int>(sizeof(RmSlot));
+    }
+
+    void reserve(int size);
+
+    void place(int slot_no, const char *tuple, int len, uint16_t flags);
+
+    void compact();
+
+    char *data_;
+    RmSlottedPageHdr *hdr_;
+};
@@ -0,0 +1,154 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "clock_pro_replacer.h"
+
+#include <algorithm>
+
+ClockProReplacer::ClockProReplacer(size_t num_pages)
+    : states_(new std::atomic<uint8_t>[num_pages]),
+      hot_(num_pages, 0),
+      in_test_(num_pages, 0),
+      max_size_(num_pages),
+      cold_target_(std::max<size_t>(1, static_cast<size_t>(num_pages * COLD_RATIO))) {
+    for (size_t i = 0; i < max_size_; i++) {
+        states_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+ClockProReplacer::~ClockProReplacer() = default;
+
+/**
+ * @description: 使用CLOCK-Pro策略选择一个victim frame，只淘汰没有被再次访问的冷帧
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockProReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+    // 冷帧最多被经过三次（开始测试期、转为热帧或被淘汰）；冷指针转完一圈都没有遇到可淘汰的冷帧时，
+    // 说明可淘汰的帧都是热帧，降级一个热帧
+    bool cold_seen = false;
+    for (size_t step = 1; step <= 4 * max_size_; step++) {
+        size_t frame = advance(hand_cold_);
+        uint8_t state = states_[frame].load(std::memory_order_relaxed);
+        if (!hot_[frame] && (state & EVICTABLE)) {
+            cold_seen = true;
+            if (run_hand_cold(frame, state)) {
+                *frame_id = static_cast<frame_id_t>(frame);
+                return true;
+            }
+        }
+        if (step % max_size_ == 0) {
+            if (!cold_seen) {
+                run_hand_hot();
+            }
+            cold_seen = false;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 冷指针经过一个可淘汰的冷帧：引用位为0则淘汰；引用位为1时，处于测试期的转为热帧，否则开始测试期
+ * @return {bool} 该帧是否被淘汰
+ * @param {size_t} frame 冷帧的帧号
+ * @param {uint8_t} state 读到的帧状态
+ */
+bool ClockProReplacer::run_hand_cold(size_t frame, uint8_t state) {
+    // 与并发的pin/unpin竞争时CAS失败，跳过该帧即可
+    if (!(state & REFERENCED)) {
+        if (!states_[frame].compare_exchange_strong(state, 0, std::memory_order_relaxed)) {
+            return false;
+        }
+        in_test_[frame] = 0;
+        return true;
+    }
+    if (!states_[frame].compare_exchange_strong(state, EVICTABLE, std::memory_order_relaxed)) {
+        return false;
+    }
+    if (in_test_[frame]) {
+        // 测试期内再次被访问，转为热帧；热帧超过配额时降级一个热帧
+        in_test_[frame] = 0;
+        hot_[frame] = 1;
+        num_hot_++;
+        if (num_hot_ > max_size_ - cold_target_) {
+            run_hand_hot();
+        }
+    } else {
+        in_test_[frame] = 1;
+    }
+    return false;
+}
+
+/**
+ * @description: 移动热指针，清除经过的热帧的引用位，把第一个引用位为0的可淘汰热帧降为冷帧；
+ * 经过的冷帧结束测试期
+ * @return {bool} 成功降级了一个热帧返回true
+ */
+bool ClockProReplacer::run_hand_hot() {
+    for (size_t step = 0; step < 2 * max_size_ + 1 && num_hot_ > 0; step++) {
+        size_t frame = advance(hand_hot_);
+        if (!hot_[frame]) {
+            in_test_[frame] = 0;
+            continue;
+        }
+        uint8_t state = states_[frame].load(std::memory_order_relaxed);
+        if (!(state & EVICTABLE)) {
+            continue;
+        }
+        if (state & REFERENCED) {
+            states_[frame].compare_exchange_strong(state, EVICTABLE, std::memory_order_relaxed);
+            continue;
+        }
+        hot_[frame] = 0;
+        num_hot_--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockProReplacer::pin(frame_id_t frame_id) { states_[frame_id].store(0, std::memory_order_relaxed); }
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，同时设置引用位
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockProReplacer::unpin(frame_id_t frame_id) {
+    states_[frame_id].store(EVICTABLE | REFERENCED, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 移除一个离开缓冲池的帧：不能被淘汰，并清除热帧和测试期标记，之后装入的页面重新作为冷帧开始
+ * @param {frame_id_t} frame_id 移除的frame的id
+ */
+void ClockProReplacer::remove(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    states_[frame_id].store(0, std::memory_order_relaxed);
+    in_test_[frame_id] = 0;
+    if (hot_[frame_id]) {
+        hot_[frame_id] = 0;
+        num_hot_--;
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量，需要遍历所有帧
+ */
+size_t ClockProReplacer::Size() {
+    size_t size = 0;
+    for (size_t i = 0; i < max_size_; i++) {
+        size += states_[i].load(std::memory_order_relaxed) & EVICTABLE;
+    }
+    return size;
+}
@@ -0,0 +1,72 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockProReplacer实现了CLOCK-Pro替换策略：帧分为热帧和冷帧，新读入的页面是冷帧，
+冷帧在测试期内（冷指针经过一次之后）再次被访问则转为热帧，只有冷帧会被淘汰；热帧超过配额时由热指针把不再被访问的热帧降为冷帧。
+一次性扫描读入的页面只会停留在冷帧中，不会挤掉被反复访问的热页面
+replacer只知道帧号而不知道页面，因此没有实现原算法中对已淘汰页面的测试期记录，冷帧配额固定为帧数的COLD_RATIO
+pin和unpin与ClockReplacer一样只是一次relaxed写入（缓冲池命中路径上的latch_不受影响）；remove要修改热帧计数，需要加锁
+*/
+class ClockProReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockProReplacer
+     * @param {size_t} num_pages ClockProReplacer最多需要存储的page数量，帧号需小于num_pages
+     */
+    explicit ClockProReplacer(size_t num_pages);
+
+    ~ClockProReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    size_t Size();
+
+    static constexpr uint8_t EVICTABLE = 1;     // 帧没有被固定，可以被淘汰
+    static constexpr uint8_t REFERENCED = 2;    // 引用位，帧在时钟指针上次经过之后被访问过
+    static constexpr double COLD_RATIO = 0.25;  // 冷帧配额占总帧数的比例
+
+   private:
+    bool run_hand_cold(size_t frame, uint8_t state);
+
+    bool run_hand_hot();
+
+    size_t advance(size_t &hand) {
+        size_t frame = hand;
+        hand = hand + 1 == max_size_ ? 0 : hand + 1;
+        return frame;
+    }
+
+    std::mutex latch_;                          // 串行化victim，保护以下非原子成员
+    std::unique_ptr<std::atomic<uint8_t>[]> states_;    // 各帧的状态，EVICTABLE和REFERENCED的组合
+    std::vector<uint8_t> hot_;          // 帧是否为热帧
+    std::vector<uint8_t> in_test_;      // 冷帧是否处于测试期
+    size_t max_size_;   // 最大容量（与缓冲池的容量相同）
+    size_t cold_target_;    // 冷帧配额，热帧数超过max_size_-cold_target_时降级热帧
+    size_t num_hot_ = 0;    // 热帧个数
+    size_t hand_cold_ = 0;  // 冷指针，寻找可淘汰的冷帧
+    size_t hand_hot_ = 0;   // 热指针，寻找可降级的热帧
+};
@@ -0,0 +1,71 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : states_(new std::atomic<uint8_t>[num_pages]), max_size_(num_pages) {
+    for (size_t i = 0; i < max_size_; i++) {
+        states_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * @description: 使用CLOCK策略选择一个victim frame：指针经过引用位为1的帧时将其清0，淘汰第一个引用位为0的可淘汰帧
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+    // 第一圈最多清除所有帧的引用位，第二圈一定能找到可淘汰的帧（如果存在）
+    for (size_t step = 0; step < 2 * max_size_ + 1; step++) {
+        size_t frame = hand_;
+        hand_ = hand_ + 1 == max_size_ ? 0 : hand_ + 1;
+        uint8_t state = states_[frame].load(std::memory_order_relaxed);
+        if (!(state & EVICTABLE)) {
+            continue;
+        }
+        // 与并发的pin/unpin竞争时CAS失败，跳过该帧即可
+        if (state & REFERENCED) {
+            states_[frame].compare_exchange_strong(state, EVICTABLE, std::memory_order_relaxed);
+        } else if (states_[frame].compare_exchange_strong(state, 0, std::memory_order_relaxed)) {
+            *frame_id = static_cast<frame_id_t>(frame);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) { states_[frame_id].store(0, std::memory_order_relaxed); }
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，同时设置引用位
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    states_[frame_id].store(EVICTABLE | REFERENCED, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量，需要遍历所有帧
+ */
+size_t ClockReplacer::Size() {
+    size_t size = 0;
+    for (size_t i = 0; i < max_size_; i++) {
+        size += states_[i].load(std::memory_order_relaxed) & EVICTABLE;
+    }
+    return size;
+}
@@ -0,0 +1,52 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK替换策略：每个帧的状态（是否可淘汰、引用位）存放在一个按帧号下标的数组中，
+pin和unpin只是对该帧状态的一次relaxed写入，替换器内部不加锁也不分配内存；victim移动时钟指针，清除引用位，
+淘汰第一个可淘汰且引用位为0的帧
+注意这只是替换器自身的开销：缓冲池命中时查页表、修改pin_count_仍然在BufferPoolInstance::latch_下进行
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量，帧号需小于num_pages
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+    static constexpr uint8_t EVICTABLE = 1;     // 帧没有被固定，可以被淘汰
+    static constexpr uint8_t REFERENCED = 2;    // 引用位，帧在时钟指针上次经过之后被访问过
+
+   private:
+    std::mutex latch_;                          // 串行化victim，保护hand_
+    std::unique_ptr<std::atomic<uint8_t>[]> states_;    // 各帧的状态，EVICTABLE和REFERENCED的组合
+    size_t max_size_;   // 最大容量（与缓冲池的容量相同）
+    size_t hand_ = 0;   // 时钟指针，下一个要检查的帧
+};
@@ -0,0 +1,162 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+#include <algorithm>
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period)
+    : max_size_(num_pages),
+      k_(std::clamp<size_t>(k, 1, UINT8_MAX)),
+      correlated_period_(correlated_period),
+      last_access_(num_pages, 0),
+      history_(num_pages * k_, 0),
+      history_size_(num_pages, 0),
+      history_head_(num_pages, 0),
+      loaded_(num_pages, 0),
+      evictable_(num_pages, 0),
+      keys_(num_pages, 0) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame：优先淘汰访问不足K次的帧，否则淘汰后向K距离最大的帧；
+ * 仍处于相关访问期内的帧跳过，只有所有可淘汰的帧都处于相关访问期内时才淘汰它们
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+    if (!pick_victim(young_set_, false, frame_id) && !pick_victim(old_set_, false, frame_id) &&
+        !pick_victim(young_set_, true, frame_id) && !pick_victim(old_set_, true, frame_id)) {
+        return false;
+    }
+    evictable_[*frame_id] = 0;
+    clear_history(*frame_id);
+    return true;
+}
+
+/**
+ * @description: 按排序键从小到大在集合中选择一个帧并移出集合
+ * @return {bool} 是否选到了帧
+ * @param {set&} set young_set_或old_set_
+ * @param {bool} allow_correlated 是否可以选择处于相关访问期内的帧
+ * @param {frame_id_t*} frame_id 选中的帧
+ */
+bool LRUKReplacer::pick_victim(std::set<std::pair<uint64_t, frame_id_t>> &set, bool allow_correlated,
+                               frame_id_t *frame_id) {
+    // 每个时刻只访问一个帧，处于相关访问期内的帧不超过correlated_period_个，检查这么多个之后就不必再找了
+    size_t num_checked = 0;
+    for (auto it = set.begin(); it != set.end() && num_checked <= correlated_period_; ++it, ++num_checked) {
+        if (allow_correlated || current_ts_ - last_access_[it->second] >= correlated_period_) {
+            *frame_id = it->second;
+            set.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，并记录一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_[frame_id]) {
+        auto &set = history_size_[frame_id] < k_ ? young_set_ : old_set_;
+        set.erase({keys_[frame_id], frame_id});
+        evictable_[frame_id] = 0;
+    }
+    record_access(frame_id);
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰；没有访问历史的帧（只被装入的页面）以当前时间登记，但不算作一次访问
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_[frame_id]) {
+        return;
+    }
+    if (history_size_[frame_id] == 0) {
+        history_[frame_id * k_] = current_ts_;
+        history_head_[frame_id] = static_cast<uint8_t>(1 % k_);
+        history_size_[frame_id] = 1;
+        loaded_[frame_id] = 1;
+    }
+    keys_[frame_id] = evict_key(frame_id);
+    auto &set = history_size_[frame_id] < k_ ? young_set_ : old_set_;
+    set.insert({keys_[frame_id], frame_id});
+    evictable_[frame_id] = 1;
+}
+
+/**
+ * @description: 移除一个离开缓冲池的帧，使其不能被淘汰并清空访问历史
+ * @param {frame_id_t} frame_id 移除的frame的id
+ */
+void LRUKReplacer::remove(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_[frame_id]) {
+        auto &set = history_size_[frame_id] < k_ ? young_set_ : old_set_;
+        set.erase({keys_[frame_id], frame_id});
+        evictable_[frame_id] = 0;
+    }
+    clear_history(frame_id);
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return young_set_.size() + old_set_.size();
+}
+
+/**
+ * @description: 把当前时间写入帧的环形缓冲区，满K次后覆盖最早的一次；相关访问期内的访问只更新最近一次访问的时间
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+    if (loaded_[frame_id]) {
+        clear_history(frame_id);
+    }
+    uint64_t ts = ++current_ts_;
+    if (history_size_[frame_id] > 0 && ts - last_access_[frame_id] <= correlated_period_) {
+        last_access_[frame_id] = ts;
+        return;
+    }
+    last_access_[frame_id] = ts;
+    uint8_t &head = history_head_[frame_id];
+    history_[frame_id * k_ + head] = ts;
+    head = static_cast<uint8_t>((head + 1) % k_);
+    if (history_size_[frame_id] < k_) {
+        history_size_[frame_id]++;
+    }
+}
+
+/**
+ * @description: 清空帧的访问历史，之后装入的页面重新开始记录
+ */
+void LRUKReplacer::clear_history(frame_id_t frame_id) {
+    history_size_[frame_id] = 0;
+    history_head_[frame_id] = 0;
+    loaded_[frame_id] = 0;
+    last_access_[frame_id] = 0;
+}
+
+/**
+ * @description: 帧的排序键：访问满K次时为倒数第K次访问的时间，即环形缓冲区中下一次要覆盖的位置；
+ * 不足K次时为最早一次访问的时间，即缓冲区的第一个位置
+ */
+uint64_t LRUKReplacer::evict_key(frame_id_t frame_id) const {
+    size_t slot = history_size_[frame_id] < k_ ? 0 : history_head_[frame_id];
+    return history_[frame_id * k_ + slot];
+}
@@ -0,0 +1,74 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略：淘汰倒数第K次访问距今最久的帧，访问次数不足K次的帧视为距离无穷大，优先淘汰，
+它们之间按最早一次访问的时间淘汰。只被顺序扫描访问一次的页面因此先于被反复访问的页面（如B+树内部结点）被淘汰
+每个帧最近K次访问的时间戳存放在一段长度为K的环形缓冲区中，所有帧的缓冲区连续存放在history_里
+pin视为一次访问，但距该帧上一次访问不超过correlated_period次访问的pin属于同一次相关访问（如顺序扫描对同一页面逐条记录的访问），
+只更新最近一次访问的时间而不计入历史；仍处于相关访问期内的帧不会被淘汰，除非没有其他可淘汰的帧
+unpin一个没有访问历史的帧（预读装入的页面）只为其登记排序位置，不推进时钟，之后的第一次pin取代这条记录
+victim淘汰或remove移除的帧清空访问历史，由之后装入的页面重新开始记录
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量，帧号需小于num_pages
+     * @param {size_t} k 计算后向K距离时使用的访问次数
+     * @param {size_t} correlated_period 相关访问期的长度（访问次数），为0时每次pin都是独立的访问
+     */
+    LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period = 0);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    void record_access(frame_id_t frame_id);
+
+    void clear_history(frame_id_t frame_id);
+
+    bool pick_victim(std::set<std::pair<uint64_t, frame_id_t>> &set, bool allow_correlated, frame_id_t *frame_id);
+
+    uint64_t evict_key(frame_id_t frame_id) const;
+
+    std::mutex latch_;                  // 互斥锁
+    size_t max_size_;   // 最大容量（与缓冲池的容量相同）
+    size_t k_;          // 访问历史的长度K
+    uint64_t correlated_period_;        // 相关访问期的长度
+    uint64_t current_ts_ = 0;           // 逻辑时钟，每次访问加1
+    std::vector<uint64_t> last_access_; // 各帧最近一次访问的时间，包括相关访问
+    std::vector<uint64_t> history_;     // 帧i的访问历史为history_[i*k_, (i+1)*k_)，按环形缓冲区写入
+    std::vector<uint8_t> history_size_; // 各帧已记录的访问次数，最多为k_
+    std::vector<uint8_t> history_head_; // 各帧环形缓冲区中下一次写入的位置
+    std::vector<uint8_t> loaded_;       // 帧的页面只是被装入、还没有被真正访问过
+    std::vector<uint8_t> evictable_;    // 帧是否没有被固定、在下面的集合中
+    std::vector<uint64_t> keys_;        // 可淘汰帧在集合中的排序键
+    std::set<std::pair<uint64_t, frame_id_t>> young_set_;  // 访问不足K次的可淘汰帧，按最早一次访问的时间排序
+    std::set<std::pair<uint64_t, frame_id_t>> old_set_;    // 访问已满K次的可淘汰帧，按倒数第K次访问的时间排序
+};
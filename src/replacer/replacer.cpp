@@ -0,0 +1,29 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "replacer/replacer.h"
+
+#include "replacer/clock_pro_replacer.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+
+std::unique_ptr<Replacer> Replacer::create(const std::string &type, size_t num_pages) {
+    if (type == "LRU_K") {
+        return std::make_unique<LRUKReplacer>(num_pages, LRU_K, LRU_K_CORRELATED_PERIOD);
+    }
+    if (type == "CLOCK") {
+        return std::make_unique<ClockReplacer>(num_pages);
+    }
+    if (type == "CLOCK_PRO") {
+        return std::make_unique<ClockProReplacer>(num_pages);
+    }
+    return std::make_unique<LRUReplacer>(num_pages);
+}
@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "common/config.h"
 
 /**
@@ -39,6 +42,21 @@ class Replacer {
      */
     virtual void unpin(frame_id_t frame_id) = 0;
 
+    /**
+     * Removes a frame whose page has left the buffer pool without going through victim(), e.g. a deleted page,
+     * a failed read or a frame reused for another page. The frame is not evictable afterwards and any access
+     * history kept for it is discarded, so the next page loaded into the frame starts fresh.
+     * @param frame_id the id of the frame to remove
+     */
+    virtual void remove(frame_id_t frame_id) { pin(frame_id); }
+
     /** @return the number of elements in the replacer that can be victimized */
     virtual size_t Size() = 0;
+
+    /**
+     * Creates a replacer of the given type: "LRU", "LRU_K", "CLOCK" or "CLOCK_PRO"; unknown types fall back to LRU.
+     * @param type the replacement policy, see REPLACER_TYPE
+     * @param num_pages the maximum number of frames the replacer will track
+     */
+    static std::unique_ptr<Replacer> create(const std::string &type, size_t num_pages);
 };
@@ -0,0 +1,70 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "page.h"
+
+enum AccessStrategyType { BULK_READ, BULK_WRITE };
+
+/**
+ * @description: 缓冲区访问策略，大表的顺序扫描（BULK_READ）和批量插入（BULK_WRITE）在缺页时优先复用一小圈私有的帧，
+ * 而不是从替换器中淘汰共享缓冲池里的页面，使共享缓冲池留给点查询的工作集
+ * 帧属于各个缓冲池实例，所以每个实例对应一个环，环中的帧只在该实例的latch_保护下访问
+ * 一个策略对象只能由一个扫描或一个文件句柄使用
+ */
+class BufferAccessStrategy {
+   public:
+    struct Ring {
+        std::vector<std::pair<frame_id_t, PageId>> slots;  // 环中的帧，以及本策略装入该帧的页面
+        size_t capacity = 0;    // 环的最大长度
+        size_t next = 0;        // 环满之后下一个要复用的位置
+        uint64_t num_reused = 0;    // 复用环中的帧的次数
+    };
+
+    /**
+     * @param {AccessStrategyType} type 策略类型
+     * @param {size_t} ring_size 所有环的帧数之和
+     * @param {size_t} num_instances 缓冲池实例个数，帧数平均分给各个实例的环
+     */
+    BufferAccessStrategy(AccessStrategyType type, size_t ring_size, size_t num_instances)
+        : type_(type), rings_(num_instances) {
+        size_t capacity = std::max<size_t>(1, (ring_size + num_instances - 1) / num_instances);
+        for (auto &ring : rings_) {
+            ring.capacity = capacity;
+            ring.slots.reserve(capacity);
+        }
+    }
+
+    AccessStrategyType get_type() const { return type_; }
+
+    Ring *ring(size_t instance_no) { return &rings_[instance_no]; }
+
+    /** @return 所有环的帧数之和 */
+    size_t get_ring_size() const { return rings_.size() * rings_.front().capacity; }
+
+    /** @return 复用环中的帧的总次数，只在没有并发访问时准确 */
+    uint64_t get_num_reused() const {
+        uint64_t num_reused = 0;
+        for (auto &ring : rings_) {
+            num_reused += ring.num_reused;
+        }
+        return num_reused;
+    }
+
+   private:
+    AccessStrategyType type_;
+    std::vector<Ring> rings_;
+};
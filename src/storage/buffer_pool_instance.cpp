@@ -0,0 +1,1019 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "buffer_pool_instance.h"
+
+#include <limits.h>  // for IOV_MAX
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+
+#include "checksum.h"
+
+/**
+ * @description: 计算页面数据的校验和并写入页尾，同时记录计算开销
+ * @param {char*} data 即将写入磁盘的页面数据，调用者需保证写入期间没有其他线程修改
+ */
+void BufferPoolShared::stamp_checksum(char* data) {
+    auto start = std::chrono::steady_clock::now();
+    set_page_checksum(data);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    num_checksum_computed.fetch_add(1, std::memory_order_relaxed);
+    checksum_compute_ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 校验从磁盘读入的页面数据，同时记录校验开销
+ * @return {bool} 校验通过返回true
+ * @param {char*} data 刚从磁盘读入的页面数据
+ */
+bool BufferPoolShared::verify_checksum(const char* data) {
+    auto start = std::chrono::steady_clock::now();
+    bool valid = verify_page_checksum(data);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    num_checksum_verified.fetch_add(1, std::memory_order_relaxed);
+    checksum_verify_ns.fetch_add(ns, std::memory_order_relaxed);
+    if (!valid) {
+        num_checksum_failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    return valid;
+}
+
+/**
+ * @description: 把一个页面写回原位置，启用双写缓冲区时先把它写入双写文件并落盘
+ * @param {PageId} page_id 页面的PageId
+ * @param {char*} data 要写入的页面数据，写回完成前不能被修改
+ */
+void BufferPoolShared::write_back_page(PageId page_id, char* data) {
+    auto start = std::chrono::steady_clock::now();
+    if (double_write != nullptr) {
+        double_write->stage(&page_id, &data, 1);
+    }
+    IoRequest req;
+    try {
+        disk_manager->submit_write_page(page_id.fd, page_id.page_no, data, PAGE_SIZE, &req);
+        disk_manager->wait_page_io(&req);
+    } catch (RMDBError &e) {
+        if (double_write != nullptr) {
+            double_write->finish();
+        }
+        throw;
+    }
+    if (double_write != nullptr) {
+        double_write->finish();
+    }
+    num_write_backs.fetch_add(1, std::memory_order_relaxed);
+    write_back_latency.record_since(start);
+}
+
+/**
+ * @description: 把同一个文件中的多个页面写回原位置：按页号排序后把页号连续的页面合并为一个向量化写请求(pwritev)，
+ * 再一次性提交一批请求，统一等待完成；启用双写缓冲区时每批页面先在双写文件中落盘，一批的页面数不超过双写缓冲区的容量
+ * @param {int} fd 文件句柄
+ * @param {vector<Page*>&} pages 该文件中要写回的页面，调用者需保证写回期间它们不会被淘汰；返回时已按页号排序
+ * @param {bool} in_place 页面是否由调用者独占；启用校验和时独占的页面直接在帧上写入校验和，否则写入带校验和的副本
+ * @param {unordered_set<Page*>*} failed_pages 写失败的页面插入其中
+ */
+void BufferPoolShared::write_back_pages(int fd, std::vector<Page*>& pages, bool in_place,
+                                        std::unordered_set<Page*>* failed_pages) {
+    auto start = std::chrono::steady_clock::now();
+    std::sort(pages.begin(), pages.end(),
+              [](Page* a, Page* b) { return a->get_page_id().page_no < b->get_page_id().page_no; });
+    // 页面可能正被持有者修改时，在副本上计算校验和，保证写入磁盘的数据与校验和一致
+    std::unique_ptr<char, decltype(&free)> snapshot(nullptr, &free);
+    if (enable_checksum && !in_place && !pages.empty()) {
+        snapshot.reset(static_cast<char*>(aligned_alloc(DIRECT_IO_ALIGNMENT, pages.size() * PAGE_SIZE)));
+        if (snapshot == nullptr) {
+            failed_pages->insert(pages.begin(), pages.end());
+            return;
+        }
+    }
+    size_t max_batch = double_write != nullptr ? double_write->capacity() : std::max<size_t>(pages.size(), 1);
+    std::vector<struct iovec> iovs(pages.size());
+    std::vector<std::pair<size_t, size_t>> runs;  // 每个写请求在pages中的[起始下标, 页面个数]
+    for (size_t i = 0; i < pages.size(); i++) {
+        Page* page = pages[i];
+        if (snapshot != nullptr) {
+            char* buf = snapshot.get() + i * PAGE_SIZE;
+            memcpy(buf, page->get_data(), PAGE_SIZE);
+            stamp_checksum(buf);
+            iovs[i] = {buf, PAGE_SIZE};
+        } else {
+            if (enable_checksum) {
+                stamp_checksum(page->get_data());
+            }
+            iovs[i] = {page->get_data(), PAGE_SIZE};
+        }
+        if (!runs.empty() && runs.back().second < std::min<size_t>(IOV_MAX, max_batch) &&
+            pages[i - 1]->get_page_id().page_no + 1 == page->get_page_id().page_no) {
+            runs.back().second++;
+        } else {
+            runs.emplace_back(i, 1);
+        }
+    }
+    std::vector<IoRequest> reqs(runs.size());
+    std::vector<bool> run_failed(runs.size(), false);
+    size_t last = 0;
+    for (size_t first = 0; first < runs.size(); first = last) {
+        // 写请求[first, last)组成一批
+        size_t batch_pages = 0;
+        for (last = first; last < runs.size() && batch_pages + runs[last].second <= max_batch; last++) {
+            batch_pages += runs[last].second;
+        }
+        if (double_write != nullptr) {
+            std::vector<PageId> page_ids;
+            std::vector<char*> bufs;
+            for (size_t i = runs[first].first; i < runs[first].first + batch_pages; i++) {
+                page_ids.push_back(pages[i]->get_page_id());
+                bufs.push_back(static_cast<char*>(iovs[i].iov_base));
+            }
+            try {
+                double_write->stage(page_ids.data(), bufs.data(), batch_pages);
+            } catch (RMDBError &e) {
+                std::fill(run_failed.begin() + first, run_failed.begin() + last, true);
+                continue;
+            }
+        }
+        for (size_t i = first; i < last; i++) {
+            auto [start, num_pages] = runs[i];
+            disk_manager->submit_write_pages(fd, pages[start]->get_page_id().page_no, &iovs[start], num_pages,
+                                             &reqs[i]);
+        }
+        for (size_t i = first; i < last; i++) {
+            try {
+                disk_manager->wait_page_io(&reqs[i]);
+            } catch (RMDBError &e) {
+                run_failed[i] = true;
+            }
+        }
+        if (double_write != nullptr) {
+            double_write->finish();
+        }
+    }
+    size_t num_written = 0;
+    for (size_t i = 0; i < runs.size(); i++) {
+        if (run_failed[i]) {
+            failed_pages->insert(pages.begin() + runs[i].first, pages.begin() + runs[i].first + runs[i].second);
+        } else {
+            num_written += runs[i].second;
+        }
+    }
+    num_write_backs.fetch_add(num_written, std::memory_order_relaxed);
+    write_back_latency.record_since(start);
+}
+
+BufferPoolInstance::BufferPoolInstance(size_t pool_size, size_t capacity, BufferPoolShared *shared,
+                                       const std::string &replacer_type)
+    : pool_size_(pool_size),
+      capacity_(std::max(pool_size, capacity)),
+      // 按capacity_预留地址空间，扩展缓冲池时不必移动已有的帧
+      frames_(capacity_ * PAGE_SIZE, ENABLE_HUGE_PAGE_FRAMES),
+      page_table_(capacity_),
+      shared_(shared) {
+    // 帧的元数据和页面数据分开存放：Page对象紧密排列，查找和固定页面时只访问元数据所在的缓存行
+    pages_ = new Page[capacity_];
+    for (size_t i = 0; i < capacity_; ++i) {
+        pages_[i].data_ = frames_.data() + i * PAGE_SIZE;
+    }
+    replacer_ = Replacer::create(replacer_type, capacity_);
+    access_stamps_.assign(capacity_, 0);
+    // 初始化时，前pool_size_个帧都在free_list_中
+    for (size_t i = 0; i < pool_size_; ++i) {
+        free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+    }
+}
+
+BufferPoolInstance::~BufferPoolInstance() { delete[] pages_; }
+
+/**
+ * @description: 扩展本实例，帧号在[pool_size_, new_pool_size)之内的帧加入free_list_；帧的内存在第一次使用时才由内核分配
+ * @param {size_t} new_pool_size 新的帧数，不超过capacity_
+ */
+void BufferPoolInstance::grow(size_t new_pool_size) {
+    auto lock = acquire_latch();
+    new_pool_size = std::min(new_pool_size, capacity_);
+    for (size_t i = pool_size_; i < new_pool_size; i++) {
+        free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = std::max(pool_size_, new_pool_size);
+}
+
+/**
+ * @description: 收缩本实例，停用帧号在[new_pool_size, pool_size_)之内的帧：空闲帧直接移出free_list_，
+ * 缓存的页面从页表中移除，其中的脏页先写回磁盘；帧的内存通过FrameArena::release()归还给操作系统
+ * 这些帧中有页面被固定、写回失败或在写回期间又被访问时放弃收缩，所有帧恢复原状，由调用者稍后重试
+ * @return {bool} 是否收缩成功
+ * @param {size_t} new_pool_size 新的帧数
+ */
+bool BufferPoolInstance::shrink(size_t new_pool_size) {
+    auto lock = acquire_latch();
+    if (new_pool_size >= pool_size_) {
+        return true;
+    }
+    size_t old_pool_size = pool_size_;
+    auto in_range = [&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_pool_size; };
+    // 等待这些帧上进行中的读入和写回完成
+    auto io_pending = [&]() {
+        for (size_t i = new_pool_size; i < old_pool_size; i++) {
+            if (pages_[i].io_pending_) {
+                return true;
+            }
+        }
+        return false;
+    };
+    while (io_pending()) {
+        wait_for_io(lock);
+    }
+    for (size_t i = new_pool_size; i < old_pool_size; i++) {
+        if (pages_[i].pin_count_ > 0) {
+            return false;
+        }
+    }
+    // 空闲帧移出free_list_，有页面的帧被固定，写回期间不会被淘汰或复用
+    std::list<frame_id_t> free_frames;
+    for (auto it = free_list_.begin(); it != free_list_.end();) {
+        auto next = std::next(it);
+        if (in_range(*it)) {
+            free_frames.splice(free_frames.end(), free_list_, it);
+        }
+        it = next;
+    }
+    std::vector<frame_id_t> mapped_frames;
+    std::map<int, std::vector<Page *>> dirty_pages;
+    for (size_t i = new_pool_size; i < old_pool_size; i++) {
+        Page *page = &pages_[i];
+        if (page->get_page_id().page_no == INVALID_PAGE_ID) {
+            continue;
+        }
+        replacer_->pin(i);
+        page->pin_count_++;
+        mapped_frames.push_back(i);
+        if (page->is_dirty_) {
+            page->is_dirty_ = false;
+            dirty_pages[page->get_page_id().fd].push_back(page);
+        }
+    }
+
+    std::unordered_set<Page *> failed_pages;
+    if (!dirty_pages.empty()) {
+        lock.unlock();
+        for (auto &[fd, pages] : dirty_pages) {
+            shared_->write_back_pages(fd, pages, false, &failed_pages);
+        }
+        lock.lock();
+    }
+
+    bool success = failed_pages.empty();
+    for (frame_id_t frame_id : mapped_frames) {
+        if (pages_[frame_id].pin_count_ != 1 || pages_[frame_id].is_dirty_) {
+            success = false;
+        }
+    }
+    if (!success) {
+        for (frame_id_t frame_id : mapped_frames) {
+            Page *page = &pages_[frame_id];
+            if (failed_pages.count(page)) {
+                page->is_dirty_ = true;
+            } else {
+                finish_write_back(page);
+            }
+            if (--page->pin_count_ == 0) {
+                replacer_->unpin(frame_id);
+            }
+        }
+        free_list_.splice(free_list_.end(), free_frames);
+        return false;
+    }
+    for (frame_id_t frame_id : mapped_frames) {
+        Page *page = &pages_[frame_id];
+        page_table_.erase(page->get_page_id());
+        page->id_ = PageId{};
+        page->pin_count_ = 0;
+        access_stamps_[frame_id] = 0;
+        dirty_frames_.erase(frame_id);
+        replacer_->remove(frame_id);
+    }
+    pool_size_ = new_pool_size;
+    frames_.release(new_pool_size * PAGE_SIZE, (old_pool_size - new_pool_size) * PAGE_SIZE);
+    return true;
+}
+
+/**
+ * @description: 获取latch_；latch_被其他线程持有时记录等待的次数和时间
+ * @return {unique_lock<mutex>} 持有latch_的锁
+ */
+std::unique_lock<std::mutex> BufferPoolInstance::acquire_latch() {
+    std::unique_lock lock{latch_, std::try_to_lock};
+    if (!lock.owns_lock()) {
+        auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        counters_.num_latch_waits.fetch_add(1, std::memory_order_relaxed);
+        counters_.latch_wait.record_since(start);
+    }
+    return lock;
+}
+
+/**
+ * @description: 取得本实例的统计信息，并按文件累计缓存的页面数
+ * @param {BufferPoolShardStats*} stats 返回本实例的统计信息
+ * @param {unordered_map<int, FileResidency>*} files 按文件句柄累加缓存的页面数和脏页数
+ */
+void BufferPoolInstance::get_stats(BufferPoolShardStats* stats, std::unordered_map<int, FileResidency>* files) {
+    {
+        auto lock = acquire_latch();
+        stats->pool_size = pool_size_;
+        stats->num_free_frames = free_list_.size();
+        for (size_t i = 0; i < pool_size_; i++) {
+            const Page* page = &pages_[i];
+            if (page->get_page_id().page_no == INVALID_PAGE_ID || page->io_pending_) {
+                continue;
+            }
+            FileResidency& file = (*files)[page->get_page_id().fd];
+            file.num_resident_pages++;
+            stats->num_resident_pages++;
+            if (page->is_dirty_) {
+                file.num_dirty_pages++;
+                stats->num_dirty_pages++;
+            }
+        }
+    }
+    stats->num_hits = counters_.num_hits.load(std::memory_order_relaxed);
+    stats->num_misses = counters_.num_misses.load(std::memory_order_relaxed);
+    stats->num_evictions = counters_.num_evictions.load(std::memory_order_relaxed);
+    stats->num_dirty_evictions = counters_.num_dirty_evictions.load(std::memory_order_relaxed);
+    stats->num_latch_waits = counters_.num_latch_waits.load(std::memory_order_relaxed);
+    stats->hit_latency = counters_.hit_latency.snapshot();
+    stats->miss_latency = counters_.miss_latency.snapshot();
+    stats->latch_wait = counters_.latch_wait.snapshot();
+}
+
+/**
+ * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ */
+bool BufferPoolInstance::find_victim_page(frame_id_t* frame_id) {
+    // Todo:
+    // 1 使用BufferPoolInstance::free_list_判断缓冲池是否已满需要淘汰页面
+    // 1.1 未满获得frame
+    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
+    // std::cout << "In find_victim_page" << std::endl;
+    // std::scoped_lock lock{latch_};
+    if (!free_list_.empty()) {
+        *frame_id = free_list_.front();
+        free_list_.pop_front();
+        return true;
+    }
+    // 空闲帧已经用完，后台写线程没有跟上，唤醒它提前准备空闲帧
+    if (shared_->background_writer_running.load(std::memory_order_relaxed)) {
+        shared_->background_writer_cv.notify_one();
+    }
+    return replacer_->victim(frame_id);
+}
+
+/**
+ * @description: 访问策略的环已满时，尝试复用环中下一个位置的帧：该帧仍然存放着本策略装入的页面且没有被固定
+ * 页面已被淘汰或正被其他线程使用时返回false，由调用者从free_list或replacer中另选一个帧，并用它替换环中的这个位置
+ * @return {bool} true: 复用成功，帧已从replacer中移除
+ * @param {Ring*} ring 访问策略在本实例中的环
+ * @param {frame_id_t*} frame_id 返回复用的帧
+ */
+bool BufferPoolInstance::find_ring_frame(BufferAccessStrategy::Ring *ring, frame_id_t *frame_id) {
+    if (ring->slots.size() < ring->capacity) {
+        return false;
+    }
+    auto &slot = ring->slots[ring->next];
+    frame_id_t mapped_frame_id;
+    if (!page_table_.find(slot.second, &mapped_frame_id) || mapped_frame_id != slot.first) {
+        return false;
+    }
+    Page *page = &pages_[slot.first];
+    if (page->pin_count_ > 0 || page->io_pending_) {
+        return false;
+    }
+    // 帧将装入另一个页面，旧页面的访问历史不能留给新页面
+    replacer_->remove(slot.first);
+    *frame_id = slot.first;
+    ring->num_reused++;
+    return true;
+}
+
+/**
+ * @description: 把按访问策略装入页面的帧记入环中，环满时替换下一个要复用的位置
+ */
+void BufferPoolInstance::add_to_ring(BufferAccessStrategy::Ring *ring, frame_id_t frame_id, PageId page_id) {
+    if (ring->slots.size() < ring->capacity) {
+        ring->slots.emplace_back(frame_id, page_id);
+        return;
+    }
+    ring->slots[ring->next] = {frame_id, page_id};
+    ring->next = ring->next + 1 == ring->capacity ? 0 : ring->next + 1;
+}
+
+/**
+ * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
+ * @param {Page*} page 写回页指针
+ * @param {PageId} new_page_id 新的page_id
+ * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {unique_lock&} lock 调用者持有的latch_，脏页写回期间会被释放
+ * @note 返回时page->io_pending_为true，调用者完成后续的读入/初始化后负责清除并唤醒io_cv_
+ */
+void BufferPoolInstance::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id,
+                                    std::unique_lock<std::mutex> &lock) {
+    // Todo:
+    // 1 如果是脏页，写回磁盘，并且把dirty置为false
+    // 2 更新page table
+    // 3 重置page的data，更新page id
+    PageId old_page_id = page->get_page_id();
+    bool need_write_back = page->is_dirty();
+    if (old_page_id.page_no != INVALID_PAGE_ID) {
+        counters_.num_evictions.fetch_add(1, std::memory_order_relaxed);
+        if (need_write_back) {
+            counters_.num_dirty_evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    page_table_.erase(old_page_id);
+    page_table_.insert(new_page_id, new_frame_id);
+    page->id_ = new_page_id;
+    page->pin_count_++;
+    page->io_pending_ = true;
+    if (need_write_back) {
+        // 写回期间释放latch_，其他线程的命中与缺页不必等待这次写盘；
+        // 在写回完成前，旧页面登记在write_back_set_中，防止其被重新从磁盘读入旧数据
+        page->is_dirty_ = false;
+        write_back_set_.insert(old_page_id);
+        shared_->num_foreground_writes.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+        if (shared_->enable_checksum) {
+            // 被淘汰的帧没有被固定，不会再被修改，可以直接在帧上写入校验和
+            shared_->stamp_checksum(page->get_data());
+        }
+        bool success = true;
+        try {
+            shared_->write_back_page(old_page_id, page->get_data());
+        } catch (RMDBError &e) {
+            success = false;
+        }
+        lock.lock();
+        write_back_set_.erase(old_page_id);
+        if (!success) {
+            // 写回失败，恢复帧原来的映射，旧页面仍为脏页留在缓冲池中
+            page_table_.erase(new_page_id);
+            page_table_.insert(old_page_id, new_frame_id);
+            page->id_ = old_page_id;
+            page->is_dirty_ = true;
+            page->pin_count_ = 0;
+            page->io_pending_ = false;
+            replacer_->unpin(new_frame_id);
+            io_cv_.notify_all();
+            throw InternalError("DiskManager::write_page Error");
+        }
+        dirty_frames_.erase(new_frame_id);
+    }
+    page->reset_memory();
+}
+
+/**
+ * @description: 从buffer pool获取需要的页。
+ *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
+ *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {Ring*} ring 缺页时优先复用的访问策略环，为nullptr时从整个缓冲池中淘汰
+ */
+Page* BufferPoolInstance::fetch_page(PageId page_id, BufferAccessStrategy::Ring *ring) {
+    //Todo:
+    // 1.     从page_table_中搜寻目标页
+    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
+    // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
+    // 2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
+    // 3.     调用disk_manager_的read_page读取目标页到frame
+    // 4.     固定目标页，更新pin_count_
+    // 5.     返回目标页
+    auto start = std::chrono::steady_clock::now();
+    auto lock = acquire_latch();
+    while (true) {
+        frame_id_t frame_id;
+        if (page_table_.find(page_id, &frame_id)) {
+            Page* page = &pages_[frame_id];
+            if (page->io_pending_) {
+                // 其他线程正在读入该页，等待其完成后重新查找
+                wait_for_io(lock);
+                continue;
+            }
+            replacer_->pin(frame_id);
+            page->pin_count_++;
+            access_stamps_[frame_id] = ++access_clock_;
+            counters_.num_hits.fetch_add(1, std::memory_order_relaxed);
+            counters_.hit_latency.record_since(start);
+            return page;
+        }
+        if (write_back_set_.count(page_id)) {
+            // 该页刚被淘汰且正在写回，等待写回完成后再从磁盘读取
+            wait_for_io(lock);
+            continue;
+        }
+        break;
+    }
+    counters_.num_misses.fetch_add(1, std::memory_order_relaxed);
+    frame_id_t frame_id = -1;
+    if (!(ring != nullptr && find_ring_frame(ring, &frame_id)) && !find_victim_page(&frame_id)) {
+        return nullptr;
+    }
+    Page* page = &pages_[frame_id];
+    update_page(page, page_id, frame_id, lock);
+    page->pin_count_ = 1;
+    // 读盘期间释放latch_，多个线程的缺页可以同时在途
+    lock.unlock();
+    IoRequest req;
+    bool success = true;
+    try {
+        shared_->disk_manager->submit_read_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE, &req);
+        shared_->disk_manager->wait_page_io(&req);
+    } catch (RMDBError &e) {
+        success = false;
+    }
+    bool checksum_ok = !success || !shared_->enable_checksum || shared_->verify_checksum(page->get_data());
+    lock.lock();
+    page->io_pending_ = false;
+    io_cv_.notify_all();
+    if (!success || !checksum_ok) {
+        page_table_.erase(page_id);
+        page->id_ = PageId{};
+        page->pin_count_ = 0;
+        page->reset_memory();
+        free_frame(frame_id);
+        if (!checksum_ok) {
+            throw PageChecksumError(page_id.fd, page_id.page_no);
+        }
+        throw InternalError("DiskManager::read_page Error");
+    }
+    replacer_->pin(frame_id);
+    access_stamps_[frame_id] = ++access_clock_;
+    if (ring != nullptr) {
+        add_to_ring(ring, frame_id, page_id);
+    }
+    counters_.miss_latency.record_since(start);
+    return page;
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
+ * @param {PageId} page_id 目标page的page_id
+ * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ */
+bool BufferPoolInstance::unpin_page(PageId page_id, bool is_dirty) {
+    // Todo:
+    // 0. lock latch
+    // 1. 尝试在page_table_中搜寻page_id对应的页P
+    // 1.1 P在页表中不存在 return false
+    // 1.2 P在页表中存在，获取其pin_count_
+    // 2.1 若pin_count_已经等于0，则返回false
+    // 2.2 若pin_count_大于0，则pin_count_自减一
+    // 2.2.1 若自减后等于0，则调用replacer_的Unpin
+    // 3 根据参数is_dirty，更改P的is_dirty_
+    // std::cout << "In unpin_page" << std::endl;
+    auto lock = acquire_latch();
+    frame_id_t frame_id;
+    if (!page_table_.find(page_id, &frame_id)) {
+        return false;
+    }
+    Page* page = &pages_[frame_id];
+    if (page->pin_count_ == 0) {
+        return false;
+    }
+    page->pin_count_--;
+    if (page->pin_count_ == 0) {
+        replacer_->unpin(frame_id);
+    }
+    if (is_dirty) {
+        mark_frame_dirty(page);
+    }
+    return true;
+}
+
+/**
+ * @description: 不加latch_地判断页面是否在本实例中（包括正在读入的页面），用于预取等只需要近似结果的场景；
+ * 结果只在查找的瞬间有效，之后页面可能被淘汰或读入
+ * @return {bool} 页面是否在页表中
+ * @param {PageId} page_id 目标页的page_id
+ */
+bool BufferPoolInstance::is_resident(PageId page_id) const {
+    frame_id_t frame_id;
+    return page_table_.find_optimistic(page_id, &frame_id);
+}
+
+/**
+ * @description: 取得本实例中所有已装入的页面及其最近一次被访问的时间，按从热到冷排序，用于转储缓冲池的内容
+ * @param {vector<pair<uint64_t, PageId>>*} pages 追加(访问计数, 页面)，访问计数越大越热
+ */
+void BufferPoolInstance::get_resident_pages(std::vector<std::pair<uint64_t, PageId>>* pages) {
+    std::vector<std::pair<uint64_t, PageId>> resident;
+    {
+        auto lock = acquire_latch();
+        for (size_t i = 0; i < pool_size_; i++) {
+            PageId page_id = pages_[i].get_page_id();
+            frame_id_t frame_id;
+            if (page_id.page_no != INVALID_PAGE_ID && !pages_[i].io_pending_ && page_table_.find(page_id, &frame_id) &&
+                frame_id == static_cast<frame_id_t>(i)) {
+                resident.emplace_back(access_stamps_[i], page_id);
+            }
+        }
+    }
+    std::sort(resident.begin(), resident.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    pages->insert(pages->end(), resident.begin(), resident.end());
+}
+
+/**
+ * @description: 为一个不需要固定的读入（预热、预读）准备帧，调用者读入页面后调用finish_load
+ * @return {Page*} 准备好的帧，读入完成前io_pending_为true；页面已在缓冲池中、正在写回或没有可用的帧时返回nullptr
+ * @param {PageId} page_id 要读入的页面
+ * @param {bool} allow_evict 为false时只使用free_list_中的帧，不淘汰已有的页面
+ * @param {Ring*} ring 优先复用的访问策略环，为nullptr时从整个缓冲池中取帧
+ */
+Page* BufferPoolInstance::begin_load(PageId page_id, bool allow_evict, BufferAccessStrategy::Ring* ring) {
+    auto lock = acquire_latch();
+    frame_id_t frame_id;
+    if (page_table_.find(page_id, &frame_id) || write_back_set_.count(page_id)) {
+        return nullptr;
+    }
+    if (!(ring != nullptr && find_ring_frame(ring, &frame_id)) &&
+        !((allow_evict || !free_list_.empty()) && find_victim_page(&frame_id))) {
+        return nullptr;
+    }
+    Page* page = &pages_[frame_id];
+    update_page(page, page_id, frame_id, lock);
+    page->pin_count_ = 1;
+    if (ring != nullptr) {
+        add_to_ring(ring, frame_id, page_id);
+    }
+    return page;
+}
+
+/**
+ * @description: 结束begin_load开始的读入：成功时页面以未固定的状态留在缓冲池中，作为最冷的页面；失败时释放帧
+ * @param {Page*} page begin_load返回的帧
+ * @param {bool} success 页面是否读入成功并通过校验
+ */
+void BufferPoolInstance::finish_load(Page* page, bool success) {
+    auto lock = acquire_latch();
+    frame_id_t frame_id = frame_of(page);
+    page->io_pending_ = false;
+    io_cv_.notify_all();
+    if (!success) {
+        page_table_.erase(page->get_page_id());
+        page->id_ = PageId{};
+        page->pin_count_ = 0;
+        page->reset_memory();
+        free_frame(frame_id);
+        return;
+    }
+    // 只登记到替换器中而不算作一次访问，预读的页面直到真正被访问之前都是最冷的；读入期间其他线程等待io_pending_，不会固定该页面
+    page->pin_count_ = 0;
+    replacer_->unpin(frame_id);
+    access_stamps_[frame_id] = 0;
+}
+
+/**
+ * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用；写盘期间不持有latch_，对该页面的fetch_page照常命中
+ * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
+ * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
+ */
+bool BufferPoolInstance::flush_page(PageId page_id) {
+    // Todo:
+    // 0. lock latch
+    // 1. 查找页表,尝试获取目标页P
+    // 1.1 目标页P没有被page_table_记录 ，返回false
+    // 2. 无论P是否为脏都将其写回磁盘。
+    // 3. 更新P的is_dirty_
+    // std::cout << "In flush_page" << std::endl;
+    // std::cout << "In flush_page: Page id " << page_id.fd << " " << page_id.page_no << std::endl;
+    auto lock = acquire_latch();
+    frame_id_t frame_id;
+    bool found = page_table_.find(page_id, &frame_id);
+    while (found && (pages_[frame_id].io_pending_ || pages_[frame_id].write_pending_)) {
+        wait_for_io(lock);
+        found = page_table_.find(page_id, &frame_id);
+    }
+    if (!found) {
+        return false;
+    }
+    Page* page = &pages_[frame_id];
+    // 写盘期间释放latch_：固定帧使其不会被淘汰，write_pending_只让同一页面的其他写回等待，fetch_page照常命中；
+    // 写入的是页面的副本，页面可能正被持有者修改，在副本上计算校验和，保证写入磁盘的数据与校验和一致
+    pin_for_write_back(page);
+    lock.unlock();
+    alignas(DIRECT_IO_ALIGNMENT) char buf[PAGE_SIZE];
+    std::exception_ptr error;
+    try {
+        memcpy(buf, page->get_data(), PAGE_SIZE);
+        if (shared_->enable_checksum) {
+            shared_->stamp_checksum(buf);
+        }
+        shared_->write_back_page(page_id, buf);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    lock.lock();
+    page->write_pending_ = false;
+    if (error) {
+        page->is_dirty_ = true;
+    } else {
+        finish_write_back(page);
+    }
+    if (--page->pin_count_ == 0) {
+        replacer_->unpin(frame_id);
+    }
+    io_cv_.notify_all();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return true;
+}
+
+/**
+ * @description: 为一个新分配的页面准备一个帧，页面内容初始化为全0
+ * @return {Page*} 返回新创建的page，若没有可用的帧则返回nullptr
+ * @param {PageId} page_id 由BufferPoolManager在磁盘文件中分配好的页面
+ * @param {Ring*} ring 优先复用的访问策略环，为nullptr时从整个缓冲池中淘汰
+ */
+Page* BufferPoolInstance::new_page(PageId page_id, BufferAccessStrategy::Ring *ring) {
+    // 1.   获得一个可用的frame，若无法获得则返回nullptr
+    // 2.   将frame的数据写回磁盘
+    // 3.   固定frame，更新pin_count_
+    // 4.   返回获得的page
+    auto lock = acquire_latch();
+    frame_id_t frame_id = -1;
+    if (!(ring != nullptr && find_ring_frame(ring, &frame_id)) && !find_victim_page(&frame_id)) {
+        return nullptr;
+    }
+    Page* page = &pages_[frame_id];
+    update_page(page, page_id, frame_id, lock);
+    page->io_pending_ = false;
+    io_cv_.notify_all();
+    replacer_->pin(frame_id);
+    page->pin_count_ = 1;
+    access_stamps_[frame_id] = ++access_clock_;
+    if (ring != nullptr) {
+        add_to_ring(ring, frame_id, page_id);
+    }
+    return page;
+}
+
+/**
+ * @description: 从buffer_pool删除目标页，并在磁盘文件中释放该页面，之后可以被new_page重新分配
+ * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolInstance::delete_page(PageId page_id) {
+    // 1.   在page_table_中查找目标页，若不存在返回true
+    // 2.   若目标页的pin_count不为0，则返回false
+    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
+    auto lock = acquire_latch();
+    frame_id_t frame_id;
+    bool found = page_table_.find(page_id, &frame_id);
+    // 等待该页面上进行中的读入或写回完成，避免释放后重新分配的页面被旧的写回覆盖
+    while ((found && pages_[frame_id].io_pending_) || write_back_set_.count(page_id)) {
+        wait_for_io(lock);
+        found = page_table_.find(page_id, &frame_id);
+    }
+    if (!found) {
+        shared_->disk_manager->deallocate_page(page_id.fd, page_id.page_no);
+        return true;
+    }
+    Page* page = &pages_[frame_id];
+    if (page->pin_count_ > 0) {
+        return false;
+    }
+    shared_->disk_manager->deallocate_page(page_id.fd, page_id.page_no);
+    // 页面已被删除，其内容无需写回
+    page_table_.erase(page_id);
+    page->id_ = PageId{};
+    page->is_dirty_ = false;
+    dirty_frames_.erase(frame_id);
+    page->reset_memory();
+    free_frame(frame_id);
+    return true;
+}
+
+/**
+ * @description: 固定本实例中属于指定文件的所有脏页并清除其脏标记，防止写盘期间被淘汰，供flush_all_pages使用；
+ * 只遍历脏页表，干净的页面与磁盘上的内容相同，不需要写回
+ * @param {int} fd 文件句柄
+ * @param {vector<Page*>*} pages 被固定的页面追加到其中
+ */
+void BufferPoolInstance::pin_file_pages(int fd, std::vector<Page*>* pages) {
+    auto lock = acquire_latch();
+    // 等待该文件中已被淘汰、正在写回的页面写完，保证返回后该文件在缓冲池之外没有进行中的写
+    // flush_page或检查点正在写的页面仍在脏页表中，帧的write_pending_为true，同样需要等待
+    auto writing_back = [&]() {
+        return std::any_of(write_back_set_.begin(), write_back_set_.end(),
+                           [fd](const PageId& page_id) { return page_id.fd == fd; }) ||
+               std::any_of(dirty_frames_.begin(), dirty_frames_.end(), [&](frame_id_t frame_id) {
+                   const Page& page = pages_[frame_id];
+                   return page.write_pending_ && page.get_page_id().fd == fd;
+               });
+    };
+    while (writing_back()) {
+        wait_for_io(lock);
+    }
+    for (frame_id_t frame_id : dirty_frames_) {
+        Page* page = &pages_[frame_id];
+        if (page->get_page_id().fd == fd && page->is_dirty_ && !page->io_pending_) {
+            pin_for_write_back(page);
+            pages->push_back(page);
+        }
+    }
+}
+
+/**
+ * @description: 从本实例中移除属于指定文件的所有未被固定的干净页面，在flush_all_pages之后、关闭文件之前调用；
+ * 关闭后同一个fd可能分配给另一个文件，留在页表中的旧页面会被当作新文件的页面返回
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolInstance::discard_file_pages(int fd) {
+    auto lock = acquire_latch();
+    for (size_t i = 0; i < pool_size_; i++) {
+        Page* page = &pages_[i];
+        PageId page_id = page->get_page_id();
+        frame_id_t frame_id;
+        if (page_id.fd != fd || page_id.page_no == INVALID_PAGE_ID || page->pin_count_ > 0 || page->is_dirty_ ||
+            page->io_pending_ || !page_table_.find(page_id, &frame_id) || frame_id != static_cast<frame_id_t>(i)) {
+            continue;
+        }
+        page_table_.erase(page_id);
+        page->id_ = PageId{};
+        access_stamps_[frame_id] = 0;
+        dirty_frames_.erase(frame_id);
+        free_frame(frame_id);
+    }
+}
+
+/**
+ * @description: 固定本实例中仍为脏页的指定页面并清除其脏标记，供checkpoint按批写回；
+ * 已被淘汰、已写回或正在读写的页面跳过
+ * @param {vector<PageId>&} page_ids 要写回的页面，都属于本实例
+ * @param {vector<Page*>*} pages 被固定的页面追加到其中
+ */
+void BufferPoolInstance::pin_dirty_pages(const std::vector<PageId>& page_ids, std::vector<Page*>* pages) {
+    auto lock = acquire_latch();
+    for (PageId page_id : page_ids) {
+        frame_id_t frame_id;
+        if (!page_table_.find(page_id, &frame_id)) {
+            continue;
+        }
+        Page* page = &pages_[frame_id];
+        if (page->is_dirty_ && !page->io_pending_ && !page->write_pending_) {
+            pin_for_write_back(page);
+            pages->push_back(page);
+        }
+    }
+}
+
+/**
+ * @description: 取得本实例的脏页表
+ * @param {vector<PageId>*} dirty_pages 脏页追加到其中，不包括正在写回的页面
+ */
+void BufferPoolInstance::get_dirty_pages(std::vector<PageId>* dirty_pages) {
+    auto lock = acquire_latch();
+    for (frame_id_t frame_id : dirty_frames_) {
+        // 正在读写的帧上是被淘汰的脏页，其PageId可能已被新页面覆盖，写回完成后就会离开脏页表
+        if (!pages_[frame_id].io_pending_) {
+            dirty_pages->push_back(pages_[frame_id].get_page_id());
+        }
+    }
+}
+
+/**
+ * @description: 标记一个被固定的页面为脏页
+ * @param {Page*} page 本实例中被调用者固定的页面
+ */
+void BufferPoolInstance::mark_dirty(Page* page) {
+    auto lock = acquire_latch();
+    mark_frame_dirty(page);
+}
+
+/**
+ * @description: 标记页面为脏页并记入脏页表，页面在写回期间再次被修改时仍留在脏页表中
+ */
+void BufferPoolInstance::mark_frame_dirty(Page* page) {
+    page->is_dirty_ = true;
+    dirty_frames_.insert(frame_of(page));
+}
+
+/**
+ * @description: 把不再存放页面的帧放回free_list_，并从替换器中移除，清空其访问历史
+ */
+void BufferPoolInstance::free_frame(frame_id_t frame_id) {
+    replacer_->remove(frame_id);
+    free_list_.push_back(frame_id);
+}
+
+/**
+ * @description: 页面写回成功后，写回期间没有再被修改的页面从脏页表中移除
+ */
+void BufferPoolInstance::finish_write_back(Page* page) {
+    if (!page->is_dirty_) {
+        dirty_frames_.erase(frame_of(page));
+    }
+}
+
+/**
+ * @description: 为写回固定页面并清除其脏标记，写回期间再被修改的页面会重新被标记为脏页；页面仍留在脏页表中，直到写回成功
+ * 同一页面同时只能有一次写回，否则先复制的旧内容可能后写入磁盘
+ */
+void BufferPoolInstance::pin_for_write_back(Page* page) {
+    replacer_->pin(frame_of(page));
+    page->pin_count_++;
+    page->is_dirty_ = false;
+    page->write_pending_ = true;
+}
+
+/**
+ * @description: 写盘结束后取消pin_file_pages对页面的固定，写失败的页面重新标记为脏页
+ * @param {vector<Page*>&} pages pin_file_pages固定的页面
+ * @param {unordered_set<Page*>&} failed_pages 写失败的页面
+ */
+void BufferPoolInstance::unpin_flushed_pages(const std::vector<Page*>& pages,
+                                             const std::unordered_set<Page*>& failed_pages) {
+    auto lock = acquire_latch();
+    for (Page* page : pages) {
+        page->write_pending_ = false;
+        if (failed_pages.count(page)) {
+            page->is_dirty_ = true;
+        } else {
+            finish_write_back(page);
+        }
+        if (--page->pin_count_ == 0) {
+            replacer_->unpin(frame_of(page));
+        }
+    }
+    io_cv_.notify_all();
+}
+
+/**
+ * @description: 后台写线程提前淘汰页面，使本实例至少有num_free_frames个空闲帧，缺页时可以直接使用而不必等待写盘
+ * 干净的页面直接从页表中移除，帧放入free_list_；脏页从页表中移除后登记在write_back_set_中，
+ * 由调用者写回后调用finish_evict_ahead把帧放入free_list_
+ * @param {size_t} num_free_frames 目标空闲帧数
+ * @param {vector<Page*>*} dirty_pages 需要写回的脏页追加到其中，写回完成前帧不会被使用
+ */
+void BufferPoolInstance::evict_ahead(size_t num_free_frames, std::vector<Page*>* dirty_pages) {
+    auto lock = acquire_latch();
+    frame_id_t frame_id;
+    while (free_list_.size() + dirty_pages->size() < num_free_frames && replacer_->victim(&frame_id)) {
+        Page* page = &pages_[frame_id];
+        PageId page_id = page->get_page_id();
+        page_table_.erase(page_id);
+        counters_.num_evictions.fetch_add(1, std::memory_order_relaxed);
+        if (page->is_dirty_) {
+            counters_.num_dirty_evictions.fetch_add(1, std::memory_order_relaxed);
+            // 写回期间帧不在页表和free_list_中，只能由后台写线程访问
+            page->is_dirty_ = false;
+            page->io_pending_ = true;
+            write_back_set_.insert(page_id);
+            dirty_pages->push_back(page);
+        } else {
+            page->id_ = PageId{};
+            free_frame(frame_id);
+        }
+    }
+}
+
+/**
+ * @description: evict_ahead淘汰的脏页写回之后，把帧放入free_list_；写失败的页面恢复到页表中，仍为脏页
+ * @param {vector<Page*>&} dirty_pages evict_ahead返回的脏页
+ * @param {unordered_set<Page*>&} failed_pages 写失败的页面
+ */
+void BufferPoolInstance::finish_evict_ahead(const std::vector<Page*>& dirty_pages,
+                                            const std::unordered_set<Page*>& failed_pages) {
+    auto lock = acquire_latch();
+    for (Page* page : dirty_pages) {
+        frame_id_t frame_id = frame_of(page);
+        write_back_set_.erase(page->get_page_id());
+        page->io_pending_ = false;
+        if (failed_pages.count(page)) {
+            page_table_.insert(page->get_page_id(), frame_id);
+            page->is_dirty_ = true;
+            replacer_->unpin(frame_id);
+        } else {
+            page->id_ = PageId{};
+            dirty_frames_.erase(frame_id);
+            free_frame(frame_id);
+        }
+    }
+    io_cv_.notify_all();
+}
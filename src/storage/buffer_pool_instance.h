@@ -0,0 +1,159 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "buffer_access_strategy.h"
+#include "buffer_pool_stats.h"
+#include "disk_manager.h"
+#include "double_write_buffer.h"
+#include "frame_arena.h"
+#include "page.h"
+#include "page_table.h"
+#include "replacer/replacer.h"
+
+/**
+ * @description: 缓冲池各个实例共享的状态：磁盘管理器、页面校验和的设置与统计、双写缓冲区
+ */
+struct BufferPoolShared {
+    DiskManager *disk_manager;
+    bool enable_checksum;   // 是否在写回时计算、读入时校验页尾的CRC32C校验和
+    std::atomic<uint64_t> num_checksum_computed{0};
+    std::atomic<uint64_t> checksum_compute_ns{0};
+    std::atomic<uint64_t> num_checksum_verified{0};
+    std::atomic<uint64_t> checksum_verify_ns{0};
+    std::atomic<uint64_t> num_checksum_failed{0};
+    std::unique_ptr<DoubleWriteBuffer> double_write;  // 双写缓冲区，为空时脏页直接写回原位置
+    std::atomic<uint64_t> num_foreground_writes{0};    // 缺页时淘汰脏页、在前台同步写回的页面数
+    std::atomic<uint64_t> num_background_writes{0};    // 后台写线程提前写回的页面数
+    std::atomic<bool> background_writer_running{false};
+    std::condition_variable background_writer_cv;      // 实例的空闲帧用完时唤醒后台写线程
+    std::atomic<uint64_t> num_write_backs{0};          // 写回磁盘的页面数
+    LatencyHistogram write_back_latency;               // 每次写回请求的耗时
+
+    BufferPoolShared(DiskManager *disk_manager_, bool enable_checksum_)
+        : disk_manager(disk_manager_), enable_checksum(enable_checksum_) {}
+
+    void stamp_checksum(char *data);
+
+    bool verify_checksum(const char *data);
+
+    void write_back_page(PageId page_id, char *data);
+
+    void write_back_pages(int fd, std::vector<Page *> &pages, bool in_place, std::unordered_set<Page *> *failed_pages);
+};
+
+/**
+ * @description: 缓冲池的一个实例，拥有自己的帧、页表、空闲链表、替换策略和latch_；
+ * BufferPoolManager按PageId的哈希值把页面分到各个实例，不同实例上的操作互不阻塞
+ */
+class BufferPoolInstance {
+   public:
+    BufferPoolInstance(size_t pool_size, size_t capacity, BufferPoolShared *shared, const std::string &replacer_type);
+
+    ~BufferPoolInstance();
+
+    Page *fetch_page(PageId page_id, BufferAccessStrategy::Ring *ring = nullptr);
+
+    bool unpin_page(PageId page_id, bool is_dirty);
+
+    bool flush_page(PageId page_id);
+
+    Page *new_page(PageId page_id, BufferAccessStrategy::Ring *ring = nullptr);
+
+    bool delete_page(PageId page_id);
+
+    void mark_dirty(Page *page);
+
+    void pin_file_pages(int fd, std::vector<Page *> *pages);
+
+    void discard_file_pages(int fd);
+
+    void pin_dirty_pages(const std::vector<PageId> &page_ids, std::vector<Page *> *pages);
+
+    void get_dirty_pages(std::vector<PageId> *dirty_pages);
+
+    void unpin_flushed_pages(const std::vector<Page *> &pages, const std::unordered_set<Page *> &failed_pages);
+
+    void evict_ahead(size_t num_free_frames, std::vector<Page *> *dirty_pages);
+
+    void finish_evict_ahead(const std::vector<Page *> &dirty_pages, const std::unordered_set<Page *> &failed_pages);
+
+    bool is_resident(PageId page_id) const;
+
+    void get_resident_pages(std::vector<std::pair<uint64_t, PageId>> *pages);
+
+    Page *begin_load(PageId page_id, bool allow_evict, BufferAccessStrategy::Ring *ring = nullptr);
+
+    void finish_load(Page *page, bool success);
+
+    void grow(size_t new_pool_size);
+
+    bool shrink(size_t new_pool_size);
+
+    size_t get_pool_size() {
+        std::scoped_lock lock{latch_};
+        return pool_size_;
+    }
+
+    size_t get_capacity() const { return capacity_; }
+
+    void get_stats(BufferPoolShardStats *stats, std::unordered_map<int, FileResidency> *files);
+
+   private:
+    bool find_victim_page(frame_id_t *frame_id);
+
+    bool find_ring_frame(BufferAccessStrategy::Ring *ring, frame_id_t *frame_id);
+
+    void add_to_ring(BufferAccessStrategy::Ring *ring, frame_id_t frame_id, PageId page_id);
+
+    void update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id, std::unique_lock<std::mutex> &lock);
+
+    void mark_frame_dirty(Page *page);
+
+    void free_frame(frame_id_t frame_id);
+
+    void finish_write_back(Page *page);
+
+    void pin_for_write_back(Page *page);
+
+    void wait_for_io(std::unique_lock<std::mutex> &lock) { io_cv_.wait(lock); }
+
+    std::unique_lock<std::mutex> acquire_latch();
+
+    frame_id_t frame_of(const Page *page) const { return static_cast<frame_id_t>(page - pages_); }
+
+    size_t pool_size_;      // 本实例当前可用的帧数，帧号在[0, pool_size_)之内的帧参与缓存，由latch_保护
+    size_t capacity_;       // 本实例最多可以扩展到的帧数，元数据和地址空间按它预留
+    FrameArena frames_;     // 本实例所有帧的页面数据，一块按大页对齐的连续内存，pages_[i]的data_指向第i帧，可以直接用于O_DIRECT读写
+    Page *pages_;           // 本实例的Page对象数组，只包含帧的元数据
+    PageTable page_table_;  // 帧号和页面号的映射表，用于根据页面的PageId定位该页面的帧编号
+    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    std::unique_ptr<Replacer> replacer_;    // 本实例的置换策略
+    std::mutex latch_;      // 用于本实例共享数据结构的并发控制
+    std::condition_variable io_cv_;     // 帧上的磁盘I/O完成时唤醒等待该帧的线程
+    std::unordered_set<PageId, PageIdHash> write_back_set_;    // 已被淘汰、正在写回磁盘的脏页，写回完成前不能从磁盘读取
+    std::unordered_set<frame_id_t> dirty_frames_;      // 脏页表：脏页所在的帧，写回成功后移除
+    std::vector<uint64_t> access_stamps_;   // 各帧最近一次被fetch_page/new_page访问时access_clock_的值，转储时据此按热度排序
+    uint64_t access_clock_ = 0;             // 本实例的访问计数
+    BufferPoolCounters counters_;           // 本实例的命中、缺页、淘汰和latch等待统计
+    BufferPoolShared *shared_;
+};
@@ -10,219 +10,576 @@ See the Mulan PSL v2 for more details. */
 
 #include "buffer_pool_manager.h"
 
+#include <limits.h>  // for IOV_MAX
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
- * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
- * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
- */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
-    // Todo:
-    // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
-    // 1.1 未满获得frame
-    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
-    // std::cout << "In find_victim_page" << std::endl;
-    // std::scoped_lock lock{latch_};
-    if (!free_list_.empty()) {
-        *frame_id = free_list_.front();
-        free_list_.pop_front();
-        return true;
-    }
-    return replacer_->victim(frame_id);
-}
-
-/**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
- * @param {PageId} new_page_id 新的page_id
- * @param {frame_id_t} new_frame_id 新的帧frame_id
- */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    // Todo:
-    // 1 如果是脏页，写回磁盘，并且把dirty置为false
-    // 2 更新page table
-    // 3 重置page的data，更新page id
-    if (page->is_dirty()) {
-        page->is_dirty_ = false;
-        disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-    }
-    page_table_.erase(page->get_page_id());
-    page_table_[new_page_id] = new_frame_id;
-    page->pin_count_++;
-    page->reset_memory();
-    page->id_ = new_page_id;
-}
-
-/**
- * @description: 从buffer pool获取需要的页。
- *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
- *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
- * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
- * @param {PageId} page_id 需要获取的页的PageId
- */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
-    //Todo:
-    // 1.     从page_table_中搜寻目标页
-    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
-    // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    // 2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
-    // 3.     调用disk_manager_的read_page读取目标页到frame
-    // 4.     固定目标页，更新pin_count_
-    // 5.     返回目标页
-    // std::cout << "In fetch_page" << std::endl;
-    // std::cout << "In fetch_page: Page id " << page_id.fd << " " << page_id.page_no << std::endl;
-    std::scoped_lock lock{latch_};
-    auto iter = page_table_.find(page_id);
-    if (iter != page_table_.end()) {
-        frame_id_t frame_id = iter->second;
-        replacer_->pin(frame_id);
-        Page* page = &pages_[frame_id];
-        page->pin_count_++;
-        return page;
-    }
-    frame_id_t frame_id = -1;
-    if (!find_victim_page(&frame_id)) {
+ * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
+ * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
+ * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {BufferAccessStrategy*} strategy 访问策略，优先复用其私有环中的帧；为nullptr时使用整个缓冲池
+ */
+Page* BufferPoolManager::new_page(PageId* page_id, BufferAccessStrategy *strategy) {
+    // 先分配页号才能确定页面所在的实例；该实例没有可用的帧时释放刚分配的页号
+    PageId new_page_id = {.fd = page_id->fd, .page_no = disk_manager_->allocate_page(page_id->fd)};
+    size_t instance_no = instance_index(new_page_id);
+    Page* page;
+    try {
+        page = instances_[instance_no]->new_page(new_page_id, ring_of(strategy, instance_no));
+    } catch (RMDBError &e) {
+        disk_manager_->deallocate_page(new_page_id.fd, new_page_id.page_no);
+        throw;
+    }
+    if (page == nullptr) {
+        disk_manager_->deallocate_page(new_page_id.fd, new_page_id.page_no);
         return nullptr;
     }
-    Page* page = &pages_[frame_id];
-    // if (page->is_dirty()) {
-    //     update_page(page, page_id, frame_id);
-    // }
-    update_page(page, page_id, frame_id);
-    disk_manager_->read_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE);
-    replacer_->pin(frame_id);
-    page->pin_count_ = 1;
+    page_id->page_no = new_page_id.page_no;
     return page;
 }
 
 /**
- * @description: 取消固定pin_count>0的在缓冲池中的page
- * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
- * @param {PageId} page_id 目标page的page_id
- * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ * @description: 创建一个访问策略，环的大小由配置决定，但不超过缓冲池帧数的1/8
+ * @return {unique_ptr<BufferAccessStrategy>} 新的访问策略，由调用者持有，在其生命期内传给fetch_page/new_page
+ * @param {AccessStrategyType} type BULK_READ用于大表的顺序扫描，BULK_WRITE用于批量插入
+ */
+std::unique_ptr<BufferAccessStrategy> BufferPoolManager::create_access_strategy(AccessStrategyType type) const {
+    size_t ring_size = type == BULK_READ ? BULK_READ_RING_SIZE : BULK_WRITE_RING_SIZE;
+    ring_size = std::max<size_t>(1, std::min(ring_size, pool_size_ / 8));
+    return std::make_unique<BufferAccessStrategy>(type, ring_size, instances_.size());
+}
+
+/**
+ * @description: 在线调整缓冲池的帧数：按构造时的方式把新的帧数分给各个实例，每个实例每次扩展或收缩
+ * BUFFER_POOL_RESIZE_CHUNK个帧，每一步只在对应实例的latch_下短暂停顿，其他实例上的访问不受影响
+ * 收缩时被停用的帧中的脏页先写回磁盘；帧中有页面一直被固定时该实例停止收缩，返回实际达到的帧数
+ * @return {size_t} 调整后缓冲池的帧数
+ * @param {size_t} new_pool_size 目标帧数，限制在[实例个数, max_pool_size_]之内
  */
-bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    // Todo:
-    // 0. lock latch
-    // 1. 尝试在page_table_中搜寻page_id对应的页P
-    // 1.1 P在页表中不存在 return false
-    // 1.2 P在页表中存在，获取其pin_count_
-    // 2.1 若pin_count_已经等于0，则返回false
-    // 2.2 若pin_count_大于0，则pin_count_自减一
-    // 2.2.1 若自减后等于0，则调用replacer_的Unpin
-    // 3 根据参数is_dirty，更改P的is_dirty_
-    // std::cout << "In unpin_page" << std::endl;
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return false;
+size_t BufferPoolManager::resize(size_t new_pool_size) {
+    std::scoped_lock lock{resize_latch_};
+    size_t num_instances = instances_.size();
+    new_pool_size = std::max(num_instances, std::min(new_pool_size, max_pool_size_));
+    size_t achieved = 0;
+    for (size_t i = 0; i < num_instances; i++) {
+        BufferPoolInstance *instance = instances_[i].get();
+        size_t target = new_pool_size / num_instances + (i < new_pool_size % num_instances ? 1 : 0);
+        size_t current = instance->get_pool_size();
+        while (current < target) {
+            current = std::min(target, current + BUFFER_POOL_RESIZE_CHUNK);
+            instance->grow(current);
+        }
+        while (current > target) {
+            size_t next = current > target + BUFFER_POOL_RESIZE_CHUNK ? current - BUFFER_POOL_RESIZE_CHUNK : target;
+            // 被停用的帧中的页面可能正被短暂地固定，稍等后重试
+            bool success = instance->shrink(next);
+            for (int retry = 0; !success && retry < BUFFER_POOL_SHRINK_RETRIES; retry++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                success = instance->shrink(next);
+            }
+            if (!success) {
+                break;
+            }
+            current = next;
+        }
+        achieved += current;
     }
-    Page* page = &pages_[it->second];
-    if (page->pin_count_ == 0) {
-        return false;
+    pool_size_ = achieved;
+    if (background_writer_.joinable()) {
+        // 每个实例的目标空闲帧数随实例帧数变化
+        start_background_writer(background_requested_frames_, static_cast<int>(background_interval_.count()));
     }
-    page->pin_count_--;
-    if (page->pin_count_ == 0) {
-        replacer_->unpin(it->second);
+    return achieved;
+}
+
+/**
+ * @description: 收集各实例的命中、缺页、淘汰、latch等待的计数与延迟分布，写回的统计，以及各文件缓存的页面数
+ * 计数器由各实例独立更新，快照不是在同一时刻取得的，只用于观察趋势
+ * @return {BufferPoolStats} 统计信息快照
+ */
+BufferPoolStats BufferPoolManager::get_stats() {
+    BufferPoolStats stats;
+    std::unordered_map<int, FileResidency> files;
+    for (auto &instance : instances_) {
+        BufferPoolShardStats shard;
+        instance->get_stats(&shard, &files);
+        stats.total.merge(shard);
+        stats.shards.push_back(shard);
     }
-    if (is_dirty) {
-        page->is_dirty_ = true;
+    stats.num_write_backs = shared_.num_write_backs.load(std::memory_order_relaxed);
+    stats.write_back_latency = shared_.write_back_latency.snapshot();
+    for (auto &[fd, file] : files) {
+        try {
+            file.file_name = disk_manager_->get_file_name(fd);
+        } catch (RMDBError &e) {
+            // 文件已被关闭，其页面正在被丢弃
+            continue;
+        }
+        stats.files.push_back(file);
     }
-    return true;
+    std::sort(stats.files.begin(), stats.files.end(), [](const FileResidency &a, const FileResidency &b) {
+        return a.num_resident_pages > b.num_resident_pages;
+    });
+    return stats;
 }
 
 /**
- * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
- * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
- * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
+ * @description: 将buffer_pool中该文件的所有脏页写回到磁盘，干净的页面不再重复写入
+ * @param {int} fd 文件句柄
  */
-bool BufferPoolManager::flush_page(PageId page_id) {
-    // Todo:
-    // 0. lock latch
-    // 1. 查找页表,尝试获取目标页P
-    // 1.1 目标页P没有被page_table_记录 ，返回false
-    // 2. 无论P是否为脏都将其写回磁盘。
-    // 3. 更新P的is_dirty_
-    // std::cout << "In flush_page" << std::endl;
-    // std::cout << "In flush_page: Page id " << page_id.fd << " " << page_id.page_no << std::endl;
-    std::scoped_lock lock{latch_};
-    auto iter = page_table_.find(page_id);
-    if (iter == page_table_.end()) {
-        return false;
+void BufferPoolManager::flush_all_pages(int fd) {
+    // 文件即将关闭，等待进行中的预读完成，之后不会再有该文件上的读请求
+    wait_prefetch();
+    // 在各实例的latch_保护下固定该文件的所有脏页，防止写盘期间被淘汰
+    std::vector<std::vector<Page*>> pinned(instances_.size());
+    std::vector<Page*> pages;
+    for (size_t i = 0; i < instances_.size(); i++) {
+        instances_[i]->pin_file_pages(fd, &pinned[i]);
+        pages.insert(pages.end(), pinned[i].begin(), pinned[i].end());
+    }
+    // 相邻的页面通常属于不同的实例，因此在所有实例的页面上统一排序合并写请求；页面可能正被持有者修改，不能就地写入校验和
+    std::unordered_set<Page*> failed_pages;
+    shared_.write_back_pages(fd, pages, false, &failed_pages);
+    for (size_t i = 0; i < instances_.size(); i++) {
+        instances_[i]->unpin_flushed_pages(pinned[i], failed_pages);
+    }
+    if (!failed_pages.empty()) {
+        throw InternalError("DiskManager::write_page Error");
     }
-    frame_id_t frame_id = iter->second;
-    Page* page = &pages_[frame_id];
-    disk_manager_->write_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE);
-    page->is_dirty_ = false;
-    return true;
 }
 
 /**
- * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
- * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
- * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @description: 关闭文件前从缓冲池中移除该文件的页面，调用者需先用flush_all_pages写回脏页；
+ * 仍被固定或写回后又被修改的页面保留在缓冲池中
+ * @param {int} fd 即将关闭的文件
  */
-Page* BufferPoolManager::new_page(PageId* page_id) {
-    // 1.   获得一个可用的frame，若无法获得则返回nullptr
-    // 2.   在fd对应的文件分配一个新的page_id
-    // 3.   将frame的数据写回磁盘
-    // 4.   固定frame，更新pin_count_
-    // 5.   返回获得的page
-    std::scoped_lock lock{latch_};
-    frame_id_t frame_id = -1;
-    if (!find_victim_page(&frame_id)) {
-        return nullptr;
+void BufferPoolManager::discard_file_pages(int fd) {
+    for (auto &instance : instances_) {
+        instance->discard_file_pages(fd);
     }
-    page_id->page_no = disk_manager_->allocate_page(page_id->fd);
-    Page* page = &pages_[frame_id];
-    update_page(page, *page_id, frame_id);
-    replacer_->pin(frame_id);
-    page->pin_count_ = 1;
-    return page;
 }
 
 /**
- * @description: 从buffer_pool删除目标页
- * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
- * @param {PageId} page_id 目标页
+ * @description: 增量检查点：取得开始时各实例脏页表的快照，按(文件, 页号)排序后每次固定CHECKPOINT_BATCH_PAGES个
+ * 仍为脏页的页面，按文件合并为向量化写请求写回；每批之后按max_pages_per_second限速，不会长时间占用大量帧或磁盘带宽
+ * 快照之后才变脏的页面留给下一次检查点
+ * @return {size_t} 写回的页面数
+ * @param {size_t} max_pages_per_second 每秒最多写回的页面数，为0时不限速
+ */
+size_t BufferPoolManager::checkpoint(size_t max_pages_per_second) {
+    std::vector<PageId> dirty_pages = get_dirty_page_table();
+    std::sort(dirty_pages.begin(), dirty_pages.end(), [](const PageId &a, const PageId &b) {
+        return a.fd != b.fd ? a.fd < b.fd : a.page_no < b.page_no;
+    });
+    auto start = std::chrono::steady_clock::now();
+    size_t num_written = 0;
+    size_t num_failed = 0;
+    for (size_t first = 0; first < dirty_pages.size(); first += CHECKPOINT_BATCH_PAGES) {
+        size_t last = std::min(dirty_pages.size(), first + CHECKPOINT_BATCH_PAGES);
+        std::vector<std::vector<PageId>> page_ids(instances_.size());
+        for (size_t i = first; i < last; i++) {
+            page_ids[instance_index(dirty_pages[i])].push_back(dirty_pages[i]);
+        }
+        std::vector<std::vector<Page*>> pinned(instances_.size());
+        std::map<int, std::vector<Page*>> file_pages;
+        for (size_t i = 0; i < instances_.size(); i++) {
+            if (page_ids[i].empty()) {
+                continue;
+            }
+            instances_[i]->pin_dirty_pages(page_ids[i], &pinned[i]);
+            for (Page *page : pinned[i]) {
+                file_pages[page->get_page_id().fd].push_back(page);
+            }
+        }
+        // 页面仍可能被持有者修改，不能就地写入校验和
+        std::unordered_set<Page*> failed_pages;
+        size_t batch_pages = 0;
+        for (auto &[fd, pages] : file_pages) {
+            shared_.write_back_pages(fd, pages, false, &failed_pages);
+            batch_pages += pages.size();
+        }
+        for (size_t i = 0; i < instances_.size(); i++) {
+            if (!pinned[i].empty()) {
+                instances_[i]->unpin_flushed_pages(pinned[i], failed_pages);
+            }
+        }
+        num_written += batch_pages - failed_pages.size();
+        num_failed += failed_pages.size();
+        if (max_pages_per_second > 0) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(num_written * 1000000 / max_pages_per_second));
+        }
+    }
+    if (num_failed > 0) {
+        throw InternalError("DiskManager::write_page Error");
+    }
+    return num_written;
+}
+
+/**
+ * @description: 取得所有实例的脏页表，用于检查点
+ * @return {vector<PageId>} 脏页，不包括正在被淘汰、写回的页面
+ */
+std::vector<PageId> BufferPoolManager::get_dirty_page_table() {
+    std::vector<PageId> dirty_pages;
+    for (auto &instance : instances_) {
+        instance->get_dirty_pages(&dirty_pages);
+    }
+    return dirty_pages;
+}
+
+/**
+ * @description: 打开数据库目录下的双写文件，并用其中的页面副本修复上次崩溃时写坏的页面，需要在打开数据文件之前调用
+ * @return {int} 被修复的页面个数
+ * @param {string&} path 双写文件路径
+ */
+int BufferPoolManager::open_double_write(const std::string& path) {
+    if (!shared_.enable_checksum) {
+        throw InternalError("BufferPoolManager: double write buffer requires page checksums");
+    }
+    auto double_write = std::make_unique<DoubleWriteBuffer>(disk_manager_);
+    int restored = double_write->open(path);
+    shared_.double_write = std::move(double_write);
+    return restored;
+}
+
+/**
+ * @description: 关闭双写缓冲区，需要在所有数据文件的页面都写回之后调用
+ */
+void BufferPoolManager::close_double_write() {
+    if (shared_.double_write != nullptr) {
+        shared_.double_write->close();
+        shared_.double_write.reset();
+    }
+}
+
+/**
+ * @description: 启动后台写线程，它周期性地（或在某个实例的空闲帧用完时）提前淘汰页面，使每个实例保持一定数量的空闲帧，
+ * 被淘汰的脏页按文件和页号排序后批量写回，缺页时几乎不需要在前台等待脏页写盘
+ * @param {size_t} num_free_frames 每个实例的目标空闲帧数，不超过实例帧数的1/4
+ * @param {int} interval_ms 两轮之间的最长间隔（毫秒）
+ */
+void BufferPoolManager::start_background_writer(size_t num_free_frames, int interval_ms) {
+    stop_background_writer();
+    size_t min_instance_size = pool_size_ / instances_.size();
+    background_requested_frames_ = num_free_frames;
+    background_free_frames_ = std::max<size_t>(1, std::min(num_free_frames, min_instance_size / 4));
+    background_interval_ = std::chrono::milliseconds(interval_ms);
+    background_stop_ = false;
+    shared_.background_writer_running = true;
+    background_writer_ = std::thread(&BufferPoolManager::background_writer, this);
+}
+
+/**
+ * @description: 停止后台写线程并等待其退出，没有启动时不做任何事
+ */
+void BufferPoolManager::stop_background_writer() {
+    if (!background_writer_.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{background_latch_};
+        background_stop_ = true;
+    }
+    shared_.background_writer_cv.notify_all();
+    background_writer_.join();
+    shared_.background_writer_running = false;
+}
+
+void BufferPoolManager::background_writer() {
+    std::unique_lock lock{background_latch_};
+    while (!background_stop_) {
+        lock.unlock();
+        try {
+            run_background_writer(background_free_frames_);
+        } catch (RMDBError &e) {
+            // 写失败的页面已经恢复为脏页，下一轮或前台淘汰时重试
+        }
+        lock.lock();
+        if (!background_stop_) {
+            shared_.background_writer_cv.wait_for(lock, background_interval_);
+        }
+    }
+}
+
+/**
+ * @description: 后台写线程的一轮：在每个实例中提前淘汰页面直到空闲帧数达到目标，再把被淘汰的脏页按文件分组批量写回
+ * 也可以在没有启动后台写线程时直接调用
+ * @param {size_t} num_free_frames 每个实例的目标空闲帧数
+ */
+void BufferPoolManager::run_background_writer(size_t num_free_frames) {
+    bool failed = false;
+    for (auto &instance : instances_) {
+        std::vector<Page*> dirty_pages;
+        instance->evict_ahead(num_free_frames, &dirty_pages);
+        std::unordered_map<int, std::vector<Page*>> files;
+        for (Page* page : dirty_pages) {
+            files[page->get_page_id().fd].push_back(page);
+        }
+        // 被淘汰的页面只有后台写线程能访问，可以直接在帧上写入校验和
+        std::unordered_set<Page*> failed_pages;
+        for (auto &[fd, pages] : files) {
+            shared_.write_back_pages(fd, pages, true, &failed_pages);
+        }
+        shared_.num_background_writes.fetch_add(dirty_pages.size() - failed_pages.size(), std::memory_order_relaxed);
+        instance->finish_evict_ahead(dirty_pages, failed_pages);
+        failed = failed || !failed_pages.empty();
+    }
+    if (failed) {
+        throw InternalError("DiskManager::write_page Error");
+    }
+}
+
+/**
+ * @description: 把缓冲池中的页面按从热到冷的顺序转储到文件中，每行为"文件路径 页号"，下次打开数据库时由start_warmup读入
+ * 各实例的访问计数互相独立，因此按各实例内的名次交错合并；需要在关闭数据文件之前调用
+ * @return {size_t} 转储的页面个数
+ * @param {string&} path 转储文件的路径
+ */
+size_t BufferPoolManager::dump_resident_pages(const std::string& path) {
+    std::vector<std::vector<std::pair<uint64_t, PageId>>> resident(instances_.size());
+    for (size_t i = 0; i < instances_.size(); i++) {
+        instances_[i]->get_resident_pages(&resident[i]);
+    }
+    std::ofstream ofs(path, std::ios::out | std::ios::trunc);
+    if (!ofs.is_open()) {
+        throw UnixError();
+    }
+    std::unordered_map<int, std::string> file_names;
+    size_t num_dumped = 0;
+    for (size_t rank = 0; num_dumped < pool_size_; rank++) {
+        bool has_more = false;
+        for (auto &pages : resident) {
+            if (rank >= pages.size()) {
+                continue;
+            }
+            has_more = true;
+            PageId page_id = pages[rank].second;
+            auto it = file_names.find(page_id.fd);
+            if (it == file_names.end()) {
+                // 已经关闭的文件的页面没有对应的路径，不转储
+                std::string name;
+                try {
+                    name = disk_manager_->get_file_name(page_id.fd);
+                } catch (RMDBError &e) {
+                }
+                it = file_names.emplace(page_id.fd, name).first;
+            }
+            if (!it->second.empty()) {
+                ofs << it->second << ' ' << page_id.page_no << '\n';
+                num_dumped++;
+            }
+        }
+        if (!has_more) {
+            break;
+        }
+    }
+    return num_dumped;
+}
+
+/**
+ * @description: 读入dump_resident_pages转储的页面列表，启动预热线程在后台把其中最热的页面读入缓冲池：
+ * 页面按文件和页号排序，连续的页面合并为一次读请求；预热只使用空闲帧，不会淘汰客户端已经访问的页面
+ * 需要在打开所有数据文件之后调用，转储文件不存在或其中的文件没有打开时跳过
+ * @param {string&} path 转储文件的路径
  */
-bool BufferPoolManager::delete_page(PageId page_id) {
-    // 1.   在page_table_中查找目标页，若不存在返回true
-    // 2.   若目标页的pin_count不为0，则返回false
-    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
-    // std::cout << "In delete_page" << std::endl;
-    // std::cout << "In delete_page: Page id " << page_id.fd << " " << page_id.page_no << std::endl;
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return true;
+void BufferPoolManager::start_warmup(const std::string& path) {
+    stop_warmup();
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        return;
+    }
+    std::map<int, std::vector<page_id_t>> files;
+    std::unordered_map<std::string, int> fds;
+    std::string name;
+    page_id_t page_no;
+    for (size_t i = 0; i < pool_size_ && ifs >> name >> page_no; i++) {
+        auto it = fds.find(name);
+        if (it == fds.end()) {
+            it = fds.emplace(name, disk_manager_->find_open_file(name)).first;
+        }
+        if (it->second >= 0) {
+            files[it->second].push_back(page_no);
+        }
+    }
+    for (auto &[fd, page_nos] : files) {
+        std::sort(page_nos.begin(), page_nos.end());
+        page_nos.erase(std::unique(page_nos.begin(), page_nos.end()), page_nos.end());
+        // 上次关闭之后文件可能被截断，超出文件末尾的页面不读
+        while (!page_nos.empty() && !disk_manager_->has_page(fd, page_nos.back())) {
+            page_nos.pop_back();
+        }
     }
-    frame_id_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
-    if (page->pin_count_ > 0) {
-        return false;
+    warmup_stop_ = false;
+    warmup_thread_ = std::thread([this, files = std::move(files)]() {
+        for (auto &[fd, page_nos] : files) {
+            num_warmup_pages_.fetch_add(load_pages(fd, page_nos), std::memory_order_relaxed);
+        }
+    });
+}
+
+/**
+ * @description: 停止预热线程并等待其退出，没有启动时不做任何事；关闭或删除数据文件之前需要调用
+ */
+void BufferPoolManager::stop_warmup() {
+    if (!warmup_thread_.joinable()) {
+        return;
     }
-    disk_manager_->deallocate_page(page_id.page_no);
-    page_id.page_no = INVALID_PAGE_ID;
-    update_page(page, page->get_page_id(), frame_id);
-    free_list_.push_back(frame_id);
-    return true;
+    warmup_stop_ = true;
+    warmup_thread_.join();
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 把文件中的一组页面读入缓冲池但不固定，已在缓冲池中或所在实例没有空闲帧的页面跳过；
+ * 页号连续的页面最多WARMUP_BATCH_PAGES个合并为一次读请求，读入失败或校验失败的页面被丢弃
+ * @return {size_t} 读入的页面个数
  * @param {int} fd 文件句柄
+ * @param {vector<page_id_t>&} page_nos 按升序排列的页号
  */
-void BufferPoolManager::flush_all_pages(int fd) {
-    // std::cout << "In flush_all_pages" << std::endl;
-    // std::cout << "In flush_all_pages: fd " << fd << std::endl;
-    // std::scoped_lock lock{latch_};
-    
-    for (size_t i = 0; i < pool_size_; i++) {
-        // std::cout << "Page " << i << " fd " << pages_[i].get_page_id().fd << std::endl;
-        Page* page = &pages_[i];
-        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID) {
-            disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-            page->is_dirty_ = false;
-        }
-    }
-}
\ No newline at end of file
+size_t BufferPoolManager::load_pages(int fd, const std::vector<page_id_t>& page_nos) {
+    size_t num_loaded = 0;
+    std::vector<Page*> run;     // 页号连续、已经准备好帧的页面
+    auto read_run = [&]() {
+        if (run.empty()) {
+            return;
+        }
+        std::vector<char*> bufs;
+        for (Page* page : run) {
+            bufs.push_back(page->get_data());
+        }
+        bool success = true;
+        try {
+            disk_manager_->read_pages(fd, run.front()->get_page_id().page_no, bufs.data(), static_cast<int>(run.size()));
+        } catch (RMDBError &e) {
+            success = false;
+        }
+        num_loaded += finish_loads(run, success);
+        run.clear();
+    };
+    for (page_id_t page_no : page_nos) {
+        if (warmup_stop_.load(std::memory_order_relaxed)) {
+            break;
+        }
+        PageId page_id = {.fd = fd, .page_no = page_no};
+        Page* page = instance_of(page_id)->begin_load(page_id, false);
+        if (page == nullptr) {
+            read_run();
+            continue;
+        }
+        if (!run.empty() && (run.back()->get_page_id().page_no + 1 != page_no ||
+                             run.size() >= static_cast<size_t>(WARMUP_BATCH_PAGES))) {
+            read_run();
+        }
+        run.push_back(page);
+    }
+    read_run();
+    return num_loaded;
+}
+
+/**
+ * @description: 结束一批不固定的读入，通过校验的页面留在缓冲池中，其余的帧被释放
+ * @return {size_t} 成功读入的页面个数
+ * @param {vector<Page*>&} pages begin_load准备好的帧
+ * @param {bool} success 读请求是否成功
+ */
+size_t BufferPoolManager::finish_loads(const std::vector<Page*>& pages, bool success) {
+    size_t num_loaded = 0;
+    for (Page* page : pages) {
+        bool loaded = success && (!shared_.enable_checksum || shared_.verify_checksum(page->get_data()));
+        instance_of(page->get_page_id())->finish_load(page, loaded);
+        num_loaded += loaded ? 1 : 0;
+    }
+    return num_loaded;
+}
+
+/**
+ * @description: 异步地把文件中从page_id开始的连续页面读入缓冲池，不固定页面、不等待读入完成；
+ * 已在缓冲池中的页面跳过，其余页面中页号连续的合并为一个向量化读请求，读入完成后由I/O引擎的完成线程放入缓冲池
+ * 读入期间其他线程fetch_page这些页面时会等待读入完成，而不会重复读盘
+ * @return {int} 提交了读请求的页面个数，为0说明这些页面都已在缓冲池中（或没有可用的帧）
+ * @param {PageId} page_id 第一个页面
+ * @param {int} num_pages 页面个数
+ * @param {BufferAccessStrategy*} strategy 访问策略，读入的页面优先使用其私有环中的帧；为nullptr时使用整个缓冲池
+ */
+int BufferPoolManager::prefetch(PageId page_id, int num_pages, BufferAccessStrategy *strategy) {
+    int num_submitted = 0;
+    std::vector<Page*> run;     // 页号连续、已经准备好帧的页面
+    auto submit_run = [&]() {
+        if (run.empty()) {
+            return;
+        }
+        auto *req = new PrefetchRequest;
+        req->pages = std::move(run);
+        run.clear();
+        for (Page* page : req->pages) {
+            req->iovs.push_back({page->get_data(), PAGE_SIZE});
+        }
+        req->io.callback = [this, req](IoRequest *io) {
+            finish_loads(req->pages, io->result == io->num_bytes);
+            delete req;
+            std::scoped_lock lock{prefetch_latch_};
+            if (--num_prefetch_inflight_ == 0) {
+                prefetch_cv_.notify_all();
+            }
+        };
+        {
+            std::scoped_lock lock{prefetch_latch_};
+            num_prefetch_inflight_++;
+        }
+        int num_run_pages = static_cast<int>(req->pages.size());
+        try {
+            disk_manager_->submit_read_pages(page_id.fd, req->pages.front()->get_page_id().page_no, req->iovs.data(),
+                                             num_run_pages, &req->io);
+        } catch (...) {
+            // 请求没有提交，回调不会执行：释放准备好的帧并撤销在途计数，避免wait_prefetch永远等待
+            finish_loads(req->pages, false);
+            delete req;
+            {
+                std::scoped_lock lock{prefetch_latch_};
+                num_prefetch_inflight_--;
+            }
+            prefetch_cv_.notify_all();
+            throw;
+        }
+        num_submitted += num_run_pages;
+    };
+    for (int i = 0; i < num_pages; i++) {
+        PageId curr_page_id = {.fd = page_id.fd, .page_no = page_id.page_no + i};
+        // 先不加latch地检查页表，预读的页面大多已经在缓冲池中
+        if (is_resident(curr_page_id)) {
+            submit_run();
+            continue;
+        }
+        size_t instance_no = instance_index(curr_page_id);
+        Page* page;
+        try {
+            page = instances_[instance_no]->begin_load(curr_page_id, true, ring_of(strategy, instance_no));
+        } catch (RMDBError &e) {
+            // 淘汰的脏页写回失败，放弃剩下的预读
+            break;
+        }
+        if (page == nullptr) {
+            submit_run();
+            continue;
+        }
+        if (run.size() >= static_cast<size_t>(IOV_MAX)) {
+            submit_run();
+        }
+        run.push_back(page);
+    }
+    submit_run();
+    return num_submitted;
+}
+
+/**
+ * @description: 等待所有进行中的预读完成
+ */
+void BufferPoolManager::wait_prefetch() {
+    std::unique_lock lock{prefetch_latch_};
+    prefetch_cv_.wait(lock, [this]() { return num_prefetch_inflight_ == 0; });
+}
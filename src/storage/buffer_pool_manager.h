@@ -10,74 +10,246 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <list>
-#include <unordered_map>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "buffer_pool_instance.h"
+#include "checksum.h"
 #include "disk_manager.h"
 #include "errors.h"
 #include "page.h"
-#include "replacer/lru_replacer.h"
-#include "replacer/replacer.h"
+#include "page_guard.h"
 
+/**
+ * @description: 页面校验和的统计信息，用于观察计算与校验的开销
+ */
+struct ChecksumStats {
+    uint64_t num_computed = 0;  // 写回时计算校验和的页面数
+    uint64_t compute_ns = 0;    // 计算校验和的总耗时（纳秒）
+    uint64_t num_verified = 0;  // 读入时校验的页面数
+    uint64_t verify_ns = 0;     // 校验的总耗时（纳秒）
+    uint64_t num_failed = 0;    // 校验失败的页面数
+};
+
+/**
+ * @description: 脏页写回的统计信息，用于观察后台写线程是否跟上了缺页的速度
+ */
+struct WriterStats {
+    uint64_t num_foreground_writes = 0;     // 缺页时淘汰脏页、在前台同步写回的页面数
+    uint64_t num_background_writes = 0;     // 后台写线程提前写回的页面数
+};
+
+/**
+ * @description: 缓冲池，由若干个BufferPoolInstance组成，按PageId的哈希值选择页面所在的实例，
+ * 各实例有独立的页表和latch_，多个线程访问不同实例上的页面时不会互相阻塞
+ */
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    std::atomic<size_t> pool_size_;     // buffer_pool中可容纳页面的个数，即所有实例的帧数之和，resize()时改变
+    size_t max_pool_size_;  // 缓冲池最多可以扩展到的帧数
+    std::mutex resize_latch_;   // 串行化resize()
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    BufferPoolShared shared_;   // 各实例共享的校验和设置、统计与双写缓冲区
+    std::vector<std::unique_ptr<BufferPoolInstance>> instances_;
+    std::thread background_writer_;     // 后台写线程，没有启动时不可join
+    std::mutex background_latch_;       // 保护background_stop_
+    bool background_stop_ = false;
+    size_t background_free_frames_ = 0;     // 每个实例的目标空闲帧数
+    size_t background_requested_frames_ = 0;    // 启动后台写线程时请求的空闲帧数，缓冲池大小改变后据此重新计算
+    std::chrono::milliseconds background_interval_{0};
+    std::thread warmup_thread_;         // 预热线程，没有启动时不可join
+    std::atomic<bool> warmup_stop_{false};
+    std::atomic<size_t> num_warmup_pages_{0};   // 预热读入的页面数
+    std::mutex prefetch_latch_;         // 保护num_prefetch_inflight_
+    std::condition_variable prefetch_cv_;
+    size_t num_prefetch_inflight_ = 0;  // 已提交、尚未完成的预读请求数
+
+    // 一个预读请求，完成回调中释放
+    struct PrefetchRequest {
+        IoRequest io;
+        std::vector<Page*> pages;
+        std::vector<struct iovec> iovs;
+    };
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
-        }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+    /**
+     * @param {size_t} pool_size 缓冲池的帧数
+     * @param {DiskManager*} disk_manager 磁盘管理器
+     * @param {bool} enable_checksum 是否启用页面校验和，启用后页尾PAGE_CHECKSUM_SIZE个字节由缓冲池使用，上层不能存放数据
+     * @param {size_t} num_instances 缓冲池实例个数，帧数平均分给各个实例
+     * @param {string&} replacer_type 替换策略，"LRU"、"LRU_K"、"CLOCK"或"CLOCK_PRO"，每个实例各有一个替换器
+     * @param {size_t} max_pool_size 运行时通过resize()最多可以扩展到的帧数，为0或小于pool_size时不能扩展
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, bool enable_checksum = false,
+                      size_t num_instances = 1, const std::string &replacer_type = REPLACER_TYPE,
+                      size_t max_pool_size = 0)
+        : pool_size_(pool_size),
+          max_pool_size_(std::max(pool_size, max_pool_size)),
+          disk_manager_(disk_manager),
+          shared_(disk_manager, enable_checksum) {
+        num_instances = std::max<size_t>(1, std::min(num_instances, pool_size));
+        for (size_t i = 0; i < num_instances; i++) {
+            size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+            size_t capacity = max_pool_size_ / num_instances + (i < max_pool_size_ % num_instances ? 1 : 0);
+            instances_.push_back(
+                std::make_unique<BufferPoolInstance>(instance_size, capacity, &shared_, replacer_type));
         }
     }
 
     ~BufferPoolManager() {
-        delete[] pages_;
-        delete replacer_;
+        stop_warmup();
+        wait_prefetch();
+        stop_background_writer();
     }
 
     /**
-     * @description: 将目标页面标记为脏页
-     * @param {Page*} page 脏页
+     * @description: 将目标页面标记为脏页，并记入其所在实例的脏页表
+     * @param {Page*} page 调用者固定的页面
      */
-    static void mark_dirty(Page* page) { page->is_dirty_ = true; }
+    void mark_dirty(Page* page) { instance_of(page->get_page_id())->mark_dirty(page); }
 
    public: 
-    Page* fetch_page(PageId page_id);
+    /**
+     * @param {PageId} page_id 需要获取的页的PageId
+     * @param {BufferAccessStrategy*} strategy 访问策略，缺页时优先复用其私有环中的帧；为nullptr时使用整个缓冲池
+     */
+    Page* fetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr) {
+        size_t instance_no = instance_index(page_id);
+        return instances_[instance_no]->fetch_page(page_id, ring_of(strategy, instance_no));
+    }
+
+    /**
+     * @description: 固定页面，不获取latch
+     * @return {BasicPageGuard} 析构时取消固定；缓冲池没有可用的帧时返回无效的guard
+     * @param {PageId} page_id 需要获取的页的PageId
+     * @param {BufferAccessStrategy*} strategy 访问策略，含义同fetch_page
+     */
+    BasicPageGuard fetch_page_basic(PageId page_id, BufferAccessStrategy *strategy = nullptr) {
+        return BasicPageGuard(this, fetch_page(page_id, strategy));
+    }
+
+    /**
+     * @description: 固定页面并获取其读latch，多个读者可以同时持有，与写者互斥
+     * @return {ReadPageGuard} 析构时释放latch并取消固定；缓冲池没有可用的帧时返回无效的guard
+     */
+    ReadPageGuard fetch_page_read(PageId page_id, BufferAccessStrategy *strategy = nullptr) {
+        return fetch_page_basic(page_id, strategy).upgrade_read();
+    }
+
+    /**
+     * @description: 固定页面并获取其写latch，持有期间其他线程不能通过guard读写该页面
+     * @return {WritePageGuard} 析构时释放latch并取消固定；缓冲池没有可用的帧时返回无效的guard
+     */
+    WritePageGuard fetch_page_write(PageId page_id, BufferAccessStrategy *strategy = nullptr) {
+        return fetch_page_basic(page_id, strategy).upgrade_write();
+    }
+
+    bool unpin_page(PageId page_id, bool is_dirty) { return instance_of(page_id)->unpin_page(page_id, is_dirty); }
+
+    bool flush_page(PageId page_id) { return instance_of(page_id)->flush_page(page_id); }
+
+    Page* new_page(PageId* page_id, BufferAccessStrategy *strategy = nullptr);
+
+    /**
+     * @description: 同new_page，新页面由返回的guard固定，并且已经被标记为脏页
+     * @return {BasicPageGuard} 析构时取消固定；创建失败时返回无效的guard
+     */
+    BasicPageGuard new_page_guarded(PageId* page_id, BufferAccessStrategy *strategy = nullptr) {
+        BasicPageGuard guard(this, new_page(page_id, strategy));
+        if (guard.is_valid()) {
+            guard.mark_dirty();
+        }
+        return guard;
+    }
 
-    bool unpin_page(PageId page_id, bool is_dirty);
+    bool delete_page(PageId page_id) { return instance_of(page_id)->delete_page(page_id); }
 
-    bool flush_page(PageId page_id);
+    // 不加latch地判断页面是否已在缓冲池中，结果只在查找的瞬间有效
+    bool is_resident(PageId page_id) { return instance_of(page_id)->is_resident(page_id); }
 
-    Page* new_page(PageId* page_id);
+    int prefetch(PageId page_id, int num_pages = 1, BufferAccessStrategy *strategy = nullptr);
 
-    bool delete_page(PageId page_id);
+    void wait_prefetch();
 
     void flush_all_pages(int fd);
 
+    void discard_file_pages(int fd);
+
+    size_t checkpoint(size_t max_pages_per_second = CHECKPOINT_MAX_PAGES_PER_SECOND);
+
+    std::vector<PageId> get_dirty_page_table();
+
+    size_t get_pool_size() const { return pool_size_.load(std::memory_order_relaxed); }
+
+    size_t get_max_pool_size() const { return max_pool_size_; }
+
+    size_t resize(size_t new_pool_size);
+
+    std::unique_ptr<BufferAccessStrategy> create_access_strategy(AccessStrategyType type) const;
+
+    size_t get_num_instances() const { return instances_.size(); }
+
+    bool is_checksum_enabled() const { return shared_.enable_checksum; }
+
+    int open_double_write(const std::string& path);
+
+    void close_double_write();
+
+    void start_background_writer(size_t num_free_frames, int interval_ms);
+
+    void stop_background_writer();
+
+    void run_background_writer(size_t num_free_frames);
+
+    size_t dump_resident_pages(const std::string& path);
+
+    void start_warmup(const std::string& path);
+
+    void stop_warmup();
+
+    size_t load_pages(int fd, const std::vector<page_id_t>& page_nos);
+
+    size_t get_num_warmup_pages() const { return num_warmup_pages_.load(std::memory_order_relaxed); }
+
+    WriterStats get_writer_stats() const {
+        WriterStats stats;
+        stats.num_foreground_writes = shared_.num_foreground_writes.load(std::memory_order_relaxed);
+        stats.num_background_writes = shared_.num_background_writes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    BufferPoolStats get_stats();
+
+    ChecksumStats get_checksum_stats() const {
+        ChecksumStats stats;
+        stats.num_computed = shared_.num_checksum_computed.load(std::memory_order_relaxed);
+        stats.compute_ns = shared_.checksum_compute_ns.load(std::memory_order_relaxed);
+        stats.num_verified = shared_.num_checksum_verified.load(std::memory_order_relaxed);
+        stats.verify_ns = shared_.checksum_verify_ns.load(std::memory_order_relaxed);
+        stats.num_failed = shared_.num_checksum_failed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    void background_writer();
+
+    size_t finish_loads(const std::vector<Page*>& pages, bool success);
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+    size_t instance_index(PageId page_id) const { return PageIdHash()(page_id) % instances_.size(); }
+
+    BufferPoolInstance* instance_of(PageId page_id) { return instances_[instance_index(page_id)].get(); }
+
+    static BufferAccessStrategy::Ring* ring_of(BufferAccessStrategy *strategy, size_t instance_no) {
+        return strategy == nullptr ? nullptr : strategy->ring(instance_no);
+    }
 };
\ No newline at end of file
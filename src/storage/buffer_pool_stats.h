@@ -0,0 +1,163 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @description: 延迟直方图的一份快照，可以把多个分片的快照合并后计算分位数
+ */
+struct HistogramSnapshot {
+    static constexpr int NUM_BUCKETS = 40;  // 第i个桶统计[2^i, 2^(i+1))纳秒的样本，第0个桶也包括0
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    std::array<uint64_t, NUM_BUCKETS> buckets{};
+
+    void merge(const HistogramSnapshot &that) {
+        count += that.count;
+        sum_ns += that.sum_ns;
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            buckets[i] += that.buckets[i];
+        }
+    }
+
+    uint64_t mean_ns() const { return count == 0 ? 0 : sum_ns / count; }
+
+    /**
+     * @description: 估算分位数，返回样本所在桶的上界
+     * @param {double} p 分位点，取值(0, 1]
+     */
+    uint64_t percentile_ns(double p) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p * count);
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen > rank || seen == count) {
+                return (uint64_t{1} << (i + 1)) - 1;
+            }
+        }
+        return (uint64_t{1} << NUM_BUCKETS) - 1;
+    }
+};
+
+/**
+ * @description: 按2的幂分桶的延迟直方图，记录只需要几次relaxed原子加，可以在持有latch时调用
+ */
+class LatencyHistogram {
+   public:
+    void record(uint64_t ns) {
+        int bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+        if (bucket >= HistogramSnapshot::NUM_BUCKETS) {
+            bucket = HistogramSnapshot::NUM_BUCKETS - 1;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void record_since(std::chrono::steady_clock::time_point start) {
+        record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot snapshot;
+        snapshot.count = count_.load(std::memory_order_relaxed);
+        snapshot.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+        for (int i = 0; i < HistogramSnapshot::NUM_BUCKETS; i++) {
+            snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::NUM_BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+};
+
+/**
+ * @description: 一个缓冲池实例的计数器，各实例独立更新，读取时不需要加锁
+ */
+struct alignas(64) BufferPoolCounters {
+    std::atomic<uint64_t> num_hits{0};              // fetch_page命中的次数
+    std::atomic<uint64_t> num_misses{0};            // fetch_page缺页、从磁盘读入的次数
+    std::atomic<uint64_t> num_evictions{0};         // 被淘汰的页面数，包括后台写线程提前淘汰的页面
+    std::atomic<uint64_t> num_dirty_evictions{0};   // 被淘汰时是脏页、需要写回的页面数
+    std::atomic<uint64_t> num_latch_waits{0};       // 获取latch_时需要等待的次数
+    LatencyHistogram hit_latency;       // fetch_page命中的耗时
+    LatencyHistogram miss_latency;      // fetch_page缺页的耗时，包括淘汰脏页的写回和读盘
+    LatencyHistogram latch_wait;        // 获取latch_时等待的时间，只记录需要等待的情况
+};
+
+/**
+ * @description: 一个缓冲池实例的统计信息快照
+ */
+struct BufferPoolShardStats {
+    size_t pool_size = 0;           // 帧数
+    size_t num_free_frames = 0;     // 空闲帧数
+    size_t num_resident_pages = 0;  // 缓存的页面数
+    size_t num_dirty_pages = 0;     // 其中的脏页数
+    uint64_t num_hits = 0;
+    uint64_t num_misses = 0;
+    uint64_t num_evictions = 0;
+    uint64_t num_dirty_evictions = 0;
+    uint64_t num_latch_waits = 0;
+    HistogramSnapshot hit_latency;
+    HistogramSnapshot miss_latency;
+    HistogramSnapshot latch_wait;
+
+    void merge(const BufferPoolShardStats &that) {
+        pool_size += that.pool_size;
+        num_free_frames += that.num_free_frames;
+        num_resident_pages += that.num_resident_pages;
+        num_dirty_pages += that.num_dirty_pages;
+        num_hits += that.num_hits;
+        num_misses += that.num_misses;
+        num_evictions += that.num_evictions;
+        num_dirty_evictions += that.num_dirty_evictions;
+        num_latch_waits += that.num_latch_waits;
+        hit_latency.merge(that.hit_latency);
+        miss_latency.merge(that.miss_latency);
+        latch_wait.merge(that.latch_wait);
+    }
+
+    double hit_ratio() const {
+        return num_hits + num_misses == 0 ? 0 : static_cast<double>(num_hits) / (num_hits + num_misses);
+    }
+};
+
+/**
+ * @description: 一个文件在缓冲池中缓存的页面数
+ */
+struct FileResidency {
+    std::string file_name;
+    size_t num_resident_pages = 0;
+    size_t num_dirty_pages = 0;
+};
+
+/**
+ * @description: 整个缓冲池的统计信息快照，由BufferPoolManager::get_stats()生成
+ */
+struct BufferPoolStats {
+    std::vector<BufferPoolShardStats> shards;   // 各实例的统计
+    BufferPoolShardStats total;                 // 所有实例之和
+    uint64_t num_write_backs = 0;               // 写回磁盘的页面数，包括淘汰、刷盘和后台写线程的写回
+    HistogramSnapshot write_back_latency;       // 每次写回请求（一个页面或一批页面）的耗时
+    std::vector<FileResidency> files;           // 各文件缓存的页面数，按页面数从多到少排序
+};
@@ -0,0 +1,125 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82f63b78;  // Castagnoli多项式的反射形式
+
+/**
+ * @description: slice-by-8所用的查找表，table[k][b]为字节b之后再跟k个0字节的CRC
+ */
+struct Crc32cTable {
+    uint32_t table[8][256];
+
+    Crc32cTable() {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; i++) {
+                crc = (crc >> 1) ^ (CRC32C_POLY & (0 - (crc & 1)));
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+            }
+        }
+    }
+};
+
+const Crc32cTable crc32c_table;
+
+uint32_t crc32c_software(const char *data, size_t len, uint32_t crc) {
+    const auto &t = crc32c_table.table;
+    const auto *p = reinterpret_cast<const uint8_t *>(data);
+    crc = ~crc;
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        word ^= crc;
+        crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff] ^
+              t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t crc32c_sse42(const char *data, size_t len, uint32_t crc) {
+    uint64_t crc64 = ~crc;
+    // 每次处理8个字节，页面数据总是8字节对齐，无需先处理未对齐的前缀
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        len -= 8;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    while (len-- > 0) {
+        crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data++));
+    }
+    return ~crc32;
+}
+#endif
+
+using Crc32cFunc = uint32_t (*)(const char *, size_t, uint32_t);
+
+/**
+ * @description: 运行时检测CPU是否支持SSE4.2，选择对应的实现
+ */
+Crc32cFunc choose_crc32c() {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42;
+    }
+#endif
+    return crc32c_software;
+}
+
+const Crc32cFunc crc32c_impl = choose_crc32c();
+
+}  // namespace
+
+uint32_t crc32c(const char *data, size_t len, uint32_t crc) { return crc32c_impl(data, len, crc); }
+
+bool crc32c_hardware_enabled() { return crc32c_impl != crc32c_software; }
+
+void set_page_checksum(char *data) {
+    uint32_t checksum = crc32c(data, OFFSET_PAGE_CHECKSUM);
+    memcpy(data + OFFSET_PAGE_CHECKSUM, &checksum, sizeof(checksum));
+}
+
+bool verify_page_checksum(const char *data) {
+    uint32_t stored;
+    memcpy(&stored, data + OFFSET_PAGE_CHECKSUM, sizeof(stored));
+    if (crc32c(data, OFFSET_PAGE_CHECKSUM) == stored) {
+        return true;
+    }
+    // 只有校验失败时才检查是否为全0页面，不影响正常路径的开销
+    for (int i = 0; i < PAGE_SIZE; i++) {
+        if (data[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * @description: 计算CRC32C（Castagnoli多项式），CPU支持SSE4.2时使用crc32指令每次处理8个字节，否则使用slice-by-8查表
+ * @return {uint32_t} 校验和
+ * @param {char*} data 数据首地址
+ * @param {size_t} len 数据长度
+ * @param {uint32_t} crc 之前数据的校验和，用于分段计算
+ */
+uint32_t crc32c(const char *data, size_t len, uint32_t crc = 0);
+
+/** @return 当前是否使用SSE4.2硬件指令计算CRC32C */
+bool crc32c_hardware_enabled();
+
+/**
+ * 页面校验和存放在页面的最后4个字节，覆盖页面中除此之外的全部数据
+ * 上层的页面格式需要保证不使用这4个字节
+ */
+static constexpr int PAGE_CHECKSUM_SIZE = sizeof(uint32_t);
+static constexpr int OFFSET_PAGE_CHECKSUM = PAGE_SIZE - PAGE_CHECKSUM_SIZE;
+
+/**
+ * @description: 计算页面的校验和并写入页尾
+ * @param {char*} data 大小为PAGE_SIZE的页面数据
+ */
+void set_page_checksum(char *data);
+
+/**
+ * @description: 校验页面的校验和；全0的页面（新分配或预分配后尚未写入的页面）视为有效
+ * @return {bool} 校验通过返回true
+ * @param {char*} data 大小为PAGE_SIZE的页面数据
+ */
+bool verify_page_checksum(const char *data);
@@ -0,0 +1,349 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/compressed_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "errors.h"
+#include "storage/checksum.h"
+#include "storage/io_engine.h"
+#include "storage/page_codec.h"
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'R', 'M', 'D', 'B', 'C', 'P', 'G', '1'};  // 压缩格式数据文件的文件头
+constexpr char MAP_MAGIC[8] = {'R', 'M', 'D', 'B', 'C', 'M', 'A', 'P'};   // 页面映射文件的文件头
+constexpr uint32_t BLOB_MAGIC = 0x424f4c42;                             // "BLOB"
+constexpr uint16_t BLOB_RAW = 1;                                        // 页面不可压缩，按原样存放
+
+// 一个压缩页面最多占用的字节数：头部加上未压缩的整页
+constexpr int MAX_BLOB_SIZE =
+    (32 + PAGE_SIZE + CompressedFile::SECTOR_SIZE - 1) / CompressedFile::SECTOR_SIZE * CompressedFile::SECTOR_SIZE;
+
+/**
+ * @description: 页面映射文件的格式：| MapHeader | MapEntry * num_slots |
+ */
+struct MapHeader {
+    char magic[8];
+    uint64_t next_gen;
+    int64_t end_offset;
+    int64_t file_size;     // 写入映射时数据文件的大小，用于识别过期的映射文件
+    uint32_t num_slots;
+    uint32_t crc;          // 覆盖本结构其余字段和所有MapEntry
+};
+
+struct MapEntry {
+    int64_t offset;
+    uint32_t alloc_sectors;
+    uint32_t corrupt;
+};
+
+}  // namespace
+
+/**
+ * @description: 打开一个压缩格式的数据文件，从映射文件或扫描数据文件得到页面映射
+ * @param {int} fd 数据文件的文件句柄，不能以O_DIRECT打开
+ * @param {string&} path 数据文件路径
+ */
+CompressedFile::CompressedFile(int fd, const std::string &path) : fd_(fd), path_(path) {
+    if (!load_map()) {
+        scan();
+    }
+}
+
+/**
+ * @description: 把一个新创建的空文件初始化为压缩格式
+ * @param {int} fd 数据文件的文件句柄
+ */
+void CompressedFile::format(int fd) {
+    char header[SECTOR_SIZE] = {};
+    memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    if (pwrite(fd, header, SECTOR_SIZE, 0) != SECTOR_SIZE) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 根据文件头判断数据文件是否为压缩格式
+ * @param {string&} path 数据文件路径
+ */
+bool CompressedFile::is_compressed(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    char magic[sizeof(FILE_MAGIC)];
+    bool compressed = pread(fd, magic, sizeof(magic), 0) == sizeof(magic) && memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0;
+    ::close(fd);
+    return compressed;
+}
+
+/**
+ * @description: 读取一个页面并解压
+ * @return {int} 从磁盘读取的字节数
+ * @param {page_id_t} page_no 页号
+ * @param {char*} buf 大小为PAGE_SIZE的缓冲区
+ */
+int CompressedFile::read_page(page_id_t page_no, char *buf) {
+    Slot slot;
+    {
+        std::scoped_lock lock{latch_};
+        if (page_no >= 0 && page_no < static_cast<page_id_t>(slots_.size())) {
+            slot = slots_[page_no];
+        }
+    }
+    if (slot.offset < 0 || slot.corrupt || slot.alloc_sectors * SECTOR_SIZE > MAX_BLOB_SIZE) {
+        throw InternalError("DiskManager::read_page Error");
+    }
+    char blob[MAX_BLOB_SIZE];
+    ssize_t bytes_read = pread(fd_, blob, slot.alloc_sectors * SECTOR_SIZE, slot.offset);
+    BlobHeader header;
+    if (bytes_read < static_cast<ssize_t>(sizeof(header))) {
+        throw InternalError("DiskManager::read_page Error");
+    }
+    memcpy(&header, blob, sizeof(header));
+    const char *data = blob + sizeof(header);
+    if (header.magic != BLOB_MAGIC || header.header_crc != header_crc(header) || header.page_no != page_no ||
+        header.stored_len > PAGE_SIZE || bytes_read < static_cast<ssize_t>(sizeof(header) + header.stored_len) ||
+        header.data_crc != crc32c(data, header.stored_len)) {
+        throw InternalError("DiskManager::read_page Error");
+    }
+    if (header.flags & BLOB_RAW) {
+        if (header.stored_len != PAGE_SIZE) {
+            throw InternalError("DiskManager::read_page Error");
+        }
+        memcpy(buf, data, PAGE_SIZE);
+    } else if (lz_decompress(data, header.stored_len, buf, PAGE_SIZE) != PAGE_SIZE) {
+        throw InternalError("DiskManager::read_page Error");
+    }
+    return static_cast<int>(bytes_read);
+}
+
+/**
+ * @description: 压缩并写入一个页面；原来的空间放不下时追加到文件末尾，原来的空间不再使用
+ * @return {int} 写入磁盘的字节数
+ * @param {page_id_t} page_no 页号
+ * @param {char*} buf 大小为PAGE_SIZE的页面数据
+ */
+int CompressedFile::write_page(page_id_t page_no, const char *buf) {
+    char blob[MAX_BLOB_SIZE];
+    BlobHeader header{};
+    char *data = blob + sizeof(header);
+    int stored_len = lz_compress(buf, PAGE_SIZE, data, PAGE_SIZE);
+    if (stored_len < 0) {
+        memcpy(data, buf, PAGE_SIZE);
+        stored_len = PAGE_SIZE;
+        header.flags = BLOB_RAW;
+    }
+    uint32_t needed_sectors = (sizeof(header) + stored_len + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    off_t offset;
+    {
+        std::scoped_lock lock{latch_};
+        if (page_no >= static_cast<page_id_t>(slots_.size())) {
+            slots_.resize(page_no + 1);
+        }
+        Slot &slot = slots_[page_no];
+        if (slot.offset < 0 || slot.alloc_sectors < needed_sectors) {
+            slot.offset = end_offset_;
+            slot.alloc_sectors = needed_sectors;
+            end_offset_ += static_cast<off_t>(needed_sectors) * SECTOR_SIZE;
+        }
+        slot.corrupt = false;
+        offset = slot.offset;
+        header.alloc_sectors = static_cast<uint16_t>(slot.alloc_sectors);
+        header.gen = next_gen_++;
+    }
+    header.magic = BLOB_MAGIC;
+    header.page_no = page_no;
+    header.stored_len = stored_len;
+    header.data_crc = crc32c(data, stored_len);
+    header.header_crc = header_crc(header);
+    memcpy(blob, &header, sizeof(header));
+    struct iovec iov = {blob, sizeof(header) + stored_len};
+    if (positional_io(fd_, &iov, 1, offset, true) != static_cast<ssize_t>(iov.iov_len)) {
+        throw InternalError("DiskManager::write_page Error");
+    }
+    return static_cast<int>(iov.iov_len);
+}
+
+/**
+ * @description: 判断页面是否已经写入过文件（包括写入时损坏的页面）
+ */
+bool CompressedFile::has_page(page_id_t page_no) {
+    std::scoped_lock lock{latch_};
+    return page_no >= 0 && page_no < static_cast<page_id_t>(slots_.size()) && slots_[page_no].offset >= 0;
+}
+
+/**
+ * @description: 关闭前把数据落盘并保存页面映射，下次打开时不必扫描整个文件
+ */
+void CompressedFile::close() {
+    if (fdatasync(fd_) < 0) {
+        throw UnixError();
+    }
+    save_map();
+}
+
+uint32_t CompressedFile::header_crc(const BlobHeader &header) {
+    return crc32c(reinterpret_cast<const char *>(&header), offsetof(BlobHeader, header_crc));
+}
+
+/**
+ * @description: 读入上次正常关闭时保存的页面映射，读入后删除映射文件，使崩溃后的下次打开会重新扫描
+ * @return {bool} 映射文件不存在或已经过期时返回false
+ */
+bool CompressedFile::load_map() {
+    std::string map_file = map_path(path_);
+    int map_fd = ::open(map_file.c_str(), O_RDONLY);
+    if (map_fd < 0) {
+        return false;
+    }
+    struct stat map_st, st;
+    std::vector<char> content;
+    if (fstat(map_fd, &map_st) == 0 && map_st.st_size >= static_cast<off_t>(sizeof(MapHeader))) {
+        content.resize(map_st.st_size);
+        if (pread(map_fd, content.data(), content.size(), 0) != map_st.st_size) {
+            content.clear();
+        }
+    }
+    ::close(map_fd);
+    unlink(map_file.c_str());
+
+    if (content.empty() || fstat(fd_, &st) < 0) {
+        return false;
+    }
+    MapHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    size_t entries_size = static_cast<size_t>(header.num_slots) * sizeof(MapEntry);
+    if (memcmp(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC)) != 0 || content.size() != sizeof(header) + entries_size ||
+        header.file_size != st.st_size) {
+        return false;
+    }
+    uint32_t crc = crc32c(content.data() + sizeof(header), entries_size);
+    if (header.crc != crc32c(content.data(), offsetof(MapHeader, crc), crc)) {
+        return false;
+    }
+    slots_.assign(header.num_slots, Slot());
+    for (uint32_t i = 0; i < header.num_slots; i++) {
+        MapEntry entry;
+        memcpy(&entry, content.data() + sizeof(header) + i * sizeof(MapEntry), sizeof(entry));
+        slots_[i].offset = entry.offset;
+        slots_[i].alloc_sectors = entry.alloc_sectors;
+        slots_[i].corrupt = entry.corrupt != 0;
+    }
+    end_offset_ = header.end_offset;
+    next_gen_ = header.next_gen;
+    return true;
+}
+
+/**
+ * @description: 顺序扫描整个数据文件，根据各扇区开头的BlobHeader重建页面映射
+ */
+void CompressedFile::scan() {
+    struct stat st;
+    if (fstat(fd_, &st) < 0) {
+        throw UnixError();
+    }
+    off_t file_size = st.st_size;
+    std::vector<uint64_t> gens;
+    slots_.clear();
+    end_offset_ = (file_size + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE;
+    end_offset_ = std::max<off_t>(end_offset_, SECTOR_SIZE);
+    next_gen_ = 1;
+
+    // 每次读入一个窗口，页面跨越窗口末尾时从该页面处重新读入
+    constexpr size_t WINDOW_SIZE = 1 << 20;
+    std::vector<char> window(WINDOW_SIZE);
+    off_t window_start = 0;
+    ssize_t window_len = 0;
+    for (off_t offset = SECTOR_SIZE; offset < file_size;) {
+        if (offset + MAX_BLOB_SIZE > window_start + window_len && window_start + window_len < file_size) {
+            window_start = offset;
+            window_len = pread(fd_, window.data(), WINDOW_SIZE, window_start);
+            if (window_len < 0) {
+                throw UnixError();
+            }
+        }
+        const char *sector = window.data() + (offset - window_start);
+        off_t available = window_start + window_len - offset;
+        BlobHeader header;
+        if (available < static_cast<off_t>(sizeof(header))) {
+            break;
+        }
+        memcpy(&header, sector, sizeof(header));
+        if (header.magic != BLOB_MAGIC || header.header_crc != header_crc(header) || header.page_no < 0 ||
+            header.alloc_sectors == 0 || header.stored_len > PAGE_SIZE) {
+            offset += SECTOR_SIZE;
+            continue;
+        }
+        bool corrupt = available < static_cast<off_t>(sizeof(header) + header.stored_len) ||
+                       header.data_crc != crc32c(sector + sizeof(header), header.stored_len);
+        if (header.page_no >= static_cast<page_id_t>(slots_.size())) {
+            slots_.resize(header.page_no + 1);
+            gens.resize(header.page_no + 1, 0);
+        }
+        if (header.gen > gens[header.page_no]) {
+            gens[header.page_no] = header.gen;
+            slots_[header.page_no] = {offset, header.alloc_sectors, corrupt};
+        }
+        next_gen_ = std::max(next_gen_, header.gen + 1);
+        off_t alloc_end = offset + static_cast<off_t>(header.alloc_sectors) * SECTOR_SIZE;
+        end_offset_ = std::max(end_offset_, alloc_end);
+        offset = alloc_end;
+    }
+}
+
+/**
+ * @description: 把页面映射写入临时文件并落盘，再原子地替换映射文件
+ */
+void CompressedFile::save_map() {
+    struct stat st;
+    if (fstat(fd_, &st) < 0) {
+        throw UnixError();
+    }
+    std::scoped_lock lock{latch_};
+    MapHeader header;
+    memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+    header.next_gen = next_gen_;
+    header.end_offset = end_offset_;
+    header.file_size = st.st_size;
+    header.num_slots = slots_.size();
+    std::vector<char> content(sizeof(header) + slots_.size() * sizeof(MapEntry));
+    for (size_t i = 0; i < slots_.size(); i++) {
+        MapEntry entry = {slots_[i].offset, slots_[i].alloc_sectors, slots_[i].corrupt};
+        memcpy(content.data() + sizeof(header) + i * sizeof(MapEntry), &entry, sizeof(entry));
+    }
+    header.crc = 0;
+    memcpy(content.data(), &header, sizeof(header));
+    uint32_t crc = crc32c(content.data() + sizeof(header), content.size() - sizeof(header));
+    header.crc = crc32c(content.data(), offsetof(MapHeader, crc), crc);
+    memcpy(content.data(), &header, sizeof(header));
+
+    std::string map_file = map_path(path_);
+    std::string tmp_file = map_file + ".tmp";
+    int map_fd = ::open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (map_fd < 0) {
+        throw UnixError();
+    }
+    struct iovec iov = {content.data(), content.size()};
+    bool success = positional_io(map_fd, &iov, 1, 0, true) == static_cast<ssize_t>(content.size()) && fsync(map_fd) == 0;
+    ::close(map_fd);
+    if (!success || rename(tmp_file.c_str(), map_file.c_str()) < 0) {
+        unlink(tmp_file.c_str());
+        throw InternalError("CompressedFile: failed to save page map of " + path_);
+    }
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 页面压缩格式的数据文件，页面压缩后按512字节的扇区对齐存放，页号到文件位置的映射保存在内存中
+ * 文件格式：| 文件头(1个扇区) | 压缩页面 | 压缩页面 | ... |
+ * 每个压缩页面由BlobHeader和压缩数据组成，占用alloc_sectors个扇区；页面重写时若原来的空间放得下则原地写入，否则追加到文件末尾
+ * 页面映射在正常关闭时写入同名的.cmap文件，打开时读入后即删除该文件；若打开时没有.cmap文件（上次没有正常关闭），
+ * 则扫描整个文件，根据BlobHeader重建映射，同一页面以代数(gen)最大的版本为准
+ */
+class CompressedFile {
+   public:
+    static constexpr int SECTOR_SIZE = 512;
+
+    CompressedFile(int fd, const std::string &path);
+
+    static void format(int fd);
+
+    static bool is_compressed(const std::string &path);
+
+    /** @return 数据文件对应的页面映射文件路径 */
+    static std::string map_path(const std::string &path) { return path + ".cmap"; }
+
+    int read_page(page_id_t page_no, char *buf);
+
+    int write_page(page_id_t page_no, const char *buf);
+
+    bool has_page(page_id_t page_no);
+
+    void close();
+
+   private:
+    /**
+     * @description: 每个压缩页面之前的头部，位于一个扇区的开头
+     */
+    struct BlobHeader {
+        uint32_t magic;
+        page_id_t page_no;
+        uint64_t gen;              // 写入时的代数，每次写入递增
+        uint32_t stored_len;       // 头部之后的数据长度
+        uint16_t alloc_sectors;    // 占用的扇区数，不小于头部和数据所需
+        uint16_t flags;            // BLOB_RAW表示数据没有压缩
+        uint32_t data_crc;         // 数据的校验和
+        uint32_t header_crc;       // 头部其余字段的校验和
+    };
+    static_assert(sizeof(BlobHeader) == 32, "CompressedFile::BlobHeader must be 32 bytes");
+
+    /**
+     * @description: 一个页面在文件中的位置
+     */
+    struct Slot {
+        off_t offset = -1;         // 为-1时页面不存在
+        uint32_t alloc_sectors = 0;
+        bool corrupt = false;      // 头部完整但数据损坏（写入时崩溃），读取时报错
+    };
+
+    static uint32_t header_crc(const BlobHeader &header);
+
+    bool load_map();
+
+    void scan();
+
+    void save_map();
+
+    int fd_;
+    std::string path_;
+    std::mutex latch_;             // 保护slots_、end_offset_和next_gen_
+    std::vector<Slot> slots_;      // 按页号下标的页面位置
+    off_t end_offset_ = SECTOR_SIZE;  // 文件中已使用空间的末尾，新的页面从这里追加
+    uint64_t next_gen_ = 1;
+};
@@ -11,13 +11,37 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <errno.h>     // for errno
+#include <fcntl.h>     // for fallocate
+#include <stdlib.h>    // for aligned_alloc
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for iovec
+#include <unistd.h>    // for pread/pwrite
 
 #include "defs.h"
+#include "storage/compressed_file.h"
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+DiskManager::DiskManager() {
+    io_engine_ = IoEngine::create(IO_ENGINE_TYPE, IO_QUEUE_DEPTH, IO_THREAD_NUM);
+}
+
+/**
+ * @description: 判断缓冲区和长度是否满足O_DIRECT的对齐要求，页面的文件偏移量总是对齐的
+ */
+static inline bool is_direct_io_aligned(const void *buf, size_t num_bytes) {
+    return reinterpret_cast<uintptr_t>(buf) % DIRECT_IO_ALIGNMENT == 0 && num_bytes % DIRECT_IO_ALIGNMENT == 0;
+}
+
+/**
+ * @description: 获取当前线程的对齐中转缓冲区，O_DIRECT文件上未对齐或不足一页的读写经由它完成
+ * @return {char*} 大小为PAGE_SIZE、按DIRECT_IO_ALIGNMENT对齐的缓冲区
+ */
+static char *direct_io_bounce_buffer() {
+    static thread_local std::unique_ptr<char, decltype(&free)> buffer(
+        static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)), &free);
+    return buffer.get();
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -27,15 +51,36 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
-    // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用write()函数
+    // 使用pwrite按页面偏移量直接写入，不修改fd共享的文件读写位置，多个线程可以同时读写同一个文件
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
-    off_t offset_position = lseek(fd, page_no * PAGE_SIZE, SEEK_SET);
-    if (offset_position == -1) {
-        throw InternalError("DiskManager::write_page Error");
+    off_t file_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        write_compressed_page(file.get(), page_no, offset, num_bytes);
+        return;
+    }
+    if (file != nullptr) {
+        file->count_io(true, num_bytes);
     }
-    ssize_t bytes_written = write(fd, offset, num_bytes);
+    if (file != nullptr && file->direct && !is_direct_io_aligned(offset, num_bytes)) {
+        // O_DIRECT只能整块写入：先读出整页（文件末尾之后视为全0），覆盖前num_bytes个字节后再写回整页
+        char *bounce = direct_io_bounce_buffer();
+        struct iovec iov = {bounce, PAGE_SIZE};
+        if (num_bytes < PAGE_SIZE) {
+            ssize_t bytes_read = positional_io(fd, &iov, 1, file_offset, false);
+            if (bytes_read < 0) {
+                throw InternalError("DiskManager::write_page Error");
+            }
+            memset(bounce + bytes_read, 0, PAGE_SIZE - bytes_read);
+        }
+        memcpy(bounce, offset, num_bytes);
+        if (positional_io(fd, &iov, 1, file_offset, true) != PAGE_SIZE) {
+            throw InternalError("DiskManager::write_page Error");
+        }
+        return;
+    }
+    struct iovec iov = {const_cast<char *>(offset), static_cast<size_t>(num_bytes)};
+    ssize_t bytes_written = positional_io(fd, &iov, 1, file_offset, true);
     if (bytes_written != num_bytes) {
         throw InternalError("DiskManager::write_page Error");
     }
@@ -49,32 +94,390 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  * @param {int} num_bytes 读取的数据量大小
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
-    // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用read()函数
+    // 使用pread按页面偏移量直接读取，不修改fd共享的文件读写位置
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
-    off_t offset_position = lseek(fd, page_no * PAGE_SIZE, SEEK_SET);
-    if (offset_position == -1) {
-        throw InternalError("DiskManager::read_page Error");
+    off_t file_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        read_compressed_page(file.get(), page_no, offset, num_bytes);
+        return;
+    }
+    if (file != nullptr) {
+        file->count_io(false, num_bytes);
     }
-    ssize_t bytes_read = read(fd, offset, num_bytes);
+    if (file != nullptr && file->direct && !is_direct_io_aligned(offset, num_bytes)) {
+        // O_DIRECT只能整块读取：读出整页后复制需要的部分
+        char *bounce = direct_io_bounce_buffer();
+        struct iovec iov = {bounce, PAGE_SIZE};
+        if (positional_io(fd, &iov, 1, file_offset, false) < num_bytes) {
+            throw InternalError("DiskManager::read_page Error");
+        }
+        memcpy(offset, bounce, num_bytes);
+        return;
+    }
+    struct iovec iov = {offset, static_cast<size_t>(num_bytes)};
+    ssize_t bytes_read = positional_io(fd, &iov, 1, file_offset, false);
     if (bytes_read != num_bytes) {
         throw InternalError("DiskManager::read_page Error");
     }
 }
 
 /**
- * @description: 分配一个新的页号
+ * @description: 将多个页面写入文件中从start_page_no开始的连续页面，一次pwritev完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {char*} *bufs 各页面的数据，bufs[i]写入页面start_page_no+i
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::write_pages(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages) {
+    std::vector<struct iovec> iovs(num_pages);
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        // 压缩后的页面在文件中不连续，逐页写入
+        for (int i = 0; i < num_pages; i++) {
+            write_compressed_page(file.get(), start_page_no + i, bufs[i], PAGE_SIZE);
+        }
+        return;
+    }
+    for (int i = 0; i < num_pages; i++) {
+        if (file != nullptr && file->direct && !is_direct_io_aligned(bufs[i], PAGE_SIZE)) {
+            // 存在未对齐的缓冲区时无法一次完成O_DIRECT写入，退化为逐页写入
+            for (int j = 0; j < num_pages; j++) {
+                write_page(fd, start_page_no + j, bufs[j], PAGE_SIZE);
+            }
+            return;
+        }
+        iovs[i] = {const_cast<char *>(bufs[i]), PAGE_SIZE};
+    }
+    if (file != nullptr) {
+        file->count_io(true, static_cast<uint64_t>(num_pages) * PAGE_SIZE);
+    }
+    ssize_t bytes_written = positional_io(fd, iovs.data(), num_pages, static_cast<off_t>(start_page_no) * PAGE_SIZE, true);
+    if (bytes_written != static_cast<ssize_t>(num_pages) * PAGE_SIZE) {
+        throw InternalError("DiskManager::write_pages Error");
+    }
+}
+
+/**
+ * @description: 读取文件中从start_page_no开始的连续页面，一次preadv完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {char*} *bufs 页面start_page_no+i的内容读入bufs[i]
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    std::vector<struct iovec> iovs(num_pages);
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        for (int i = 0; i < num_pages; i++) {
+            read_compressed_page(file.get(), start_page_no + i, bufs[i], PAGE_SIZE);
+        }
+        return;
+    }
+    for (int i = 0; i < num_pages; i++) {
+        if (file != nullptr && file->direct && !is_direct_io_aligned(bufs[i], PAGE_SIZE)) {
+            // 存在未对齐的缓冲区时无法一次完成O_DIRECT读取，退化为逐页读取
+            for (int j = 0; j < num_pages; j++) {
+                read_page(fd, start_page_no + j, bufs[j], PAGE_SIZE);
+            }
+            return;
+        }
+        iovs[i] = {bufs[i], PAGE_SIZE};
+    }
+    if (file != nullptr) {
+        file->count_io(false, static_cast<uint64_t>(num_pages) * PAGE_SIZE);
+    }
+    ssize_t bytes_read = positional_io(fd, iovs.data(), num_pages, static_cast<off_t>(start_page_no) * PAGE_SIZE, false);
+    if (bytes_read != static_cast<ssize_t>(num_pages) * PAGE_SIZE) {
+        throw InternalError("DiskManager::read_pages Error");
+    }
+}
+
+/**
+ * @description: 异步读取文件中指定编号的页面，不等待完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 指定的页面编号
+ * @param {char} *offset 读取的内容写入到offset中，在请求完成之前必须保持有效；O_DIRECT文件要求其按页对齐
+ * @param {int} num_bytes 读取的数据量大小；O_DIRECT文件要求为PAGE_SIZE
+ * @param {IoRequest} *req 由调用者分配的请求，可以预先设置req->callback
+ */
+void DiskManager::submit_read_page(int fd, page_id_t page_no, char *offset, int num_bytes, IoRequest *req) {
+    req->fd = fd;
+    req->offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    req->buf = offset;
+    req->iov_cnt = 0;
+    req->num_bytes = num_bytes;
+    req->is_write = false;
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        // 压缩文件的页面需要解压，在提交线程中同步读取后直接完成请求
+        int result = num_bytes;
+        try {
+            read_compressed_page(file.get(), page_no, offset, num_bytes);
+        } catch (RMDBError &e) {
+            result = -EIO;
+        }
+        io_engine_->complete(req, result);
+        return;
+    }
+    if (file != nullptr) {
+        file->count_io(false, num_bytes);
+    }
+    io_engine_->submit(req);
+}
+
+/**
+ * @description: 异步将数据写入文件的指定页面，不等待完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 写入目标页面的page_id
+ * @param {char} *offset 要写入磁盘的数据，在请求完成之前必须保持有效；O_DIRECT文件要求其按页对齐
+ * @param {int} num_bytes 要写入磁盘的数据大小；O_DIRECT文件要求为PAGE_SIZE
+ * @param {IoRequest} *req 由调用者分配的请求，可以预先设置req->callback
+ */
+void DiskManager::submit_write_page(int fd, page_id_t page_no, const char *offset, int num_bytes, IoRequest *req) {
+    req->fd = fd;
+    req->offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    req->buf = const_cast<char *>(offset);
+    req->iov_cnt = 0;
+    req->num_bytes = num_bytes;
+    req->is_write = true;
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        int result = num_bytes;
+        try {
+            write_compressed_page(file.get(), page_no, offset, num_bytes);
+        } catch (RMDBError &e) {
+            result = -EIO;
+        }
+        io_engine_->complete(req, result);
+        return;
+    }
+    if (file != nullptr) {
+        file->count_io(true, num_bytes);
+    }
+    io_engine_->submit(req);
+}
+
+/**
+ * @description: 异步读取文件中从start_page_no开始的连续页面，作为一个向量化请求提交，不等待完成
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {iovec} *iovs 各页面的缓冲区，每个长度为PAGE_SIZE，在请求完成之前必须保持有效；O_DIRECT文件要求其按页对齐
+ * @param {int} num_pages 页面个数，不能超过IOV_MAX
+ * @param {IoRequest} *req 由调用者分配的请求，可以预先设置req->callback
+ */
+void DiskManager::submit_read_pages(int fd, page_id_t start_page_no, struct iovec *iovs, int num_pages,
+                                    IoRequest *req) {
+    req->fd = fd;
+    req->offset = static_cast<off_t>(start_page_no) * PAGE_SIZE;
+    req->buf = nullptr;
+    req->iovs = iovs;
+    req->iov_cnt = num_pages;
+    req->num_bytes = num_pages * PAGE_SIZE;
+    req->is_write = false;
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        int result = req->num_bytes;
+        try {
+            for (int i = 0; i < num_pages; i++) {
+                read_compressed_page(file.get(), start_page_no + i, static_cast<char *>(iovs[i].iov_base), PAGE_SIZE);
+            }
+        } catch (RMDBError &e) {
+            result = -EIO;
+        }
+        io_engine_->complete(req, result);
+        return;
+    }
+    if (file != nullptr) {
+        file->count_io(false, req->num_bytes);
+    }
+    io_engine_->submit(req);
+}
+
+/**
+ * @description: 异步将多个页面写入文件中从start_page_no开始的连续页面，作为一个向量化请求提交
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {iovec} *iovs 各页面的缓冲区，每个长度为PAGE_SIZE，在请求完成之前必须保持有效
+ * @param {int} num_pages 页面个数，不能超过IOV_MAX
+ * @param {IoRequest} *req 由调用者分配的请求
+ */
+void DiskManager::submit_write_pages(int fd, page_id_t start_page_no, struct iovec *iovs, int num_pages,
+                                     IoRequest *req) {
+    req->fd = fd;
+    req->offset = static_cast<off_t>(start_page_no) * PAGE_SIZE;
+    req->buf = nullptr;
+    req->iovs = iovs;
+    req->iov_cnt = num_pages;
+    req->num_bytes = num_pages * PAGE_SIZE;
+    req->is_write = true;
+    OpenFileRef file = files_.get(fd);
+    if (file != nullptr && file->compressed != nullptr) {
+        int result = req->num_bytes;
+        try {
+            for (int i = 0; i < num_pages; i++) {
+                write_compressed_page(file.get(), start_page_no + i, static_cast<const char *>(iovs[i].iov_base), PAGE_SIZE);
+            }
+        } catch (RMDBError &e) {
+            result = -EIO;
+        }
+        io_engine_->complete(req, result);
+        return;
+    }
+    if (file != nullptr) {
+        file->count_io(true, req->num_bytes);
+    }
+    io_engine_->submit(req);
+}
+
+/**
+ * @description: 等待一个异步页面请求完成
+ * @param {IoRequest} *req 通过submit_read_page/submit_write_page提交的请求
+ * 注意读写的字节数与num_bytes不等时 throw InternalError
+ */
+void DiskManager::wait_page_io(IoRequest *req) {
+    io_engine_->wait(req);
+    if (req->result != req->num_bytes) {
+        throw InternalError(req->is_write ? "DiskManager::write_page Error" : "DiskManager::read_page Error");
+    }
+}
+
+/**
+ * @description: 分配一个新的页号，优先复用文件中已释放的页面
  * @return {page_id_t} 分配的新页号
  * @param {int} fd 指定文件的文件句柄
  */
 page_id_t DiskManager::allocate_page(int fd) {
-    // 简单的自增分配策略，指定文件的页面编号加1
-    assert(fd >= 0 && fd < MAX_FD);
-    return fd2pageno_[fd]++;
+    OpenFileRef file = get_open_file(fd);
+    {
+        // 选择页号最小的空闲页面，使数据集中在文件前部
+        std::scoped_lock lock{file->free_pages_latch};
+        if (!file->free_pages.empty()) {
+            page_id_t page_no = *file->free_pages.begin();
+            file->free_pages.erase(file->free_pages.begin());
+            return page_no;
+        }
+    }
+    // 没有空闲页面时使用简单的自增分配策略，指定文件的页面编号加1
+    page_id_t page_no = file->num_pages++;
+    reserve_extent(fd, page_no);
+    return page_no;
 }
 
-void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
+/**
+ * @description: 保证文件中page_no所在的区域已经分配了磁盘空间：超出已预分配的范围时，
+ * 用fallocate一次预分配FILE_EXTENT_SIZE大小的连续空间，使文件按extent增长而不是逐页增长
+ * @param {int} fd 指定文件的文件句柄
+ * @param {page_id_t} page_no 即将使用的页号
+ */
+void DiskManager::reserve_extent(int fd, page_id_t page_no) {
+    constexpr int pages_per_extent = FILE_EXTENT_SIZE / PAGE_SIZE;
+    OpenFileRef file = get_open_file(fd);
+    // 压缩文件中页面的位置与页号无关，不做预分配
+    if (pages_per_extent == 0 || page_no < file->extent_end || file->compressed != nullptr) {
+        return;
+    }
+    std::scoped_lock lock{extent_latch_};
+    page_id_t extent_end = file->extent_end;
+    if (page_no < extent_end) {
+        return;
+    }
+    page_id_t new_extent_end = (page_no / pages_per_extent + 1) * pages_per_extent;
+    // FALLOC_FL_KEEP_SIZE只分配磁盘块而不改变文件大小，尚未写入的页面读取时仍然视为超出文件末尾；
+    // 文件系统不支持fallocate时忽略错误，文件照常随写入逐页增长
+    off_t offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, offset, static_cast<off_t>(new_extent_end) * PAGE_SIZE - offset);
+    file->extent_end = new_extent_end;
+}
+
+/**
+ * @description: 释放文件中的一个页面，之后allocate_page可以将其重新分配
+ * @param {int} fd 指定文件的文件句柄
+ * @param {page_id_t} page_no 要释放的页号，调用者需保证该页面不再被引用
+ */
+void DiskManager::deallocate_page(int fd, page_id_t page_no) {
+    OpenFileRef file = get_open_file(fd);
+    std::scoped_lock lock{file->free_pages_latch};
+    file->free_pages.insert(page_no);
+}
+
+/**
+ * @description: 将文件的空闲页面列表序列化，由上层写入文件头页中持久化
+ * 格式为 | num_free_pages(int) | next_page_no(page_id_t) | page_no(page_id_t) * num_free_pages |，
+ * 文件头页中容纳不下的部分按同样的格式写入溢出页，溢出页本身取自空闲页面，用next_page_no串成链表
+ * @return {int} 写入dest的字节数
+ * @param {int} fd 指定文件的文件句柄
+ * @param {char*} dest 序列化的目标地址
+ * @param {int} max_size dest的可用空间大小
+ */
+int DiskManager::save_free_pages(int fd, char *dest, int max_size) {
+    OpenFileRef file = get_open_file(fd);
+    std::vector<page_id_t> free_pages;
+    {
+        std::scoped_lock lock{file->free_pages_latch};
+        free_pages.assign(file->free_pages.begin(), file->free_pages.end());
+    }
+    const int hdr_size = sizeof(int) + sizeof(page_id_t);
+    const int per_page = (PAGE_SIZE - hdr_size) / sizeof(page_id_t);
+    // 页号最小的空闲页面留在文件头页中，其余的放入溢出页；溢出页从页号最大的空闲页面中选取，
+    // 直到剩余的空闲页面都能放下，重新打开文件时溢出页也会被当作空闲页面恢复
+    int hdr_capacity = std::max(0, (max_size - hdr_size) / static_cast<int>(sizeof(page_id_t)));
+    size_t in_hdr = std::min(free_pages.size(), static_cast<size_t>(hdr_capacity));
+    std::vector<page_id_t> chain;
+    while (free_pages.size() - in_hdr > chain.size() * per_page) {
+        chain.push_back(free_pages.back());
+        free_pages.pop_back();
+    }
+
+    auto serialize = [](char *buf, const page_id_t *pages, int num_pages, page_id_t next_page_no) {
+        memcpy(buf, &num_pages, sizeof(int));
+        memcpy(buf + sizeof(int), &next_page_no, sizeof(page_id_t));
+        memcpy(buf + sizeof(int) + sizeof(page_id_t), pages, num_pages * sizeof(page_id_t));
+    };
+    std::vector<char> buf(PAGE_SIZE);
+    size_t pos = in_hdr;
+    for (size_t i = 0; i < chain.size(); i++) {
+        int num_pages = static_cast<int>(std::min(free_pages.size() - pos, static_cast<size_t>(per_page)));
+        page_id_t next_page_no = i + 1 < chain.size() ? chain[i + 1] : INVALID_PAGE_ID;
+        memset(buf.data(), 0, PAGE_SIZE);
+        serialize(buf.data(), free_pages.data() + pos, num_pages, next_page_no);
+        write_page(fd, chain[i], buf.data(), PAGE_SIZE);
+        pos += num_pages;
+    }
+    serialize(dest, free_pages.data(), static_cast<int>(in_hdr), chain.empty() ? INVALID_PAGE_ID : chain.front());
+    return hdr_size + static_cast<int>(in_hdr * sizeof(page_id_t));
+}
+
+/**
+ * @description: 从文件头页中读出的数据恢复文件的空闲页面列表，并沿溢出页链表读入其余部分，格式见save_free_pages
+ * @param {int} fd 指定文件的文件句柄
+ * @param {char*} src 序列化的空闲页面列表
+ */
+void DiskManager::load_free_pages(int fd, const char *src) {
+    std::set<page_id_t> free_pages;
+    auto deserialize = [&free_pages](const char *buf) {
+        int num_pages;
+        memcpy(&num_pages, buf, sizeof(int));
+        for (int i = 0; i < num_pages; i++) {
+            page_id_t page_no;
+            memcpy(&page_no, buf + sizeof(int) + sizeof(page_id_t) + i * sizeof(page_id_t), sizeof(page_id_t));
+            free_pages.insert(page_no);
+        }
+        page_id_t next_page_no;
+        memcpy(&next_page_no, buf + sizeof(int), sizeof(page_id_t));
+        return next_page_no;
+    };
+    page_id_t next_page_no = deserialize(src);
+    std::vector<char> buf(PAGE_SIZE);
+    // 溢出页读完后同样是空闲页面；遇到已经出现过的页号说明链表损坏，停止读取
+    while (next_page_no != INVALID_PAGE_ID && free_pages.insert(next_page_no).second) {
+        read_page(fd, next_page_no, buf.data(), PAGE_SIZE);
+        next_page_no = deserialize(buf.data());
+    }
+    OpenFileRef file = get_open_file(fd);
+    std::scoped_lock lock{file->free_pages_latch};
+    file->free_pages = std::move(free_pages);
+}
 
 bool DiskManager::is_dir(const std::string& path) {
     struct stat st;
@@ -111,18 +514,28 @@ bool DiskManager::is_file(const std::string &path) {
  * @description: 用于创建指定路径文件
  * @return {*}
  * @param {string} &path
+ * @param {bool} compressed 是否创建页面压缩格式的文件，之后打开该文件时自动按压缩格式读写
  */
-void DiskManager::create_file(const std::string &path) {
+void DiskManager::create_file(const std::string &path, bool compressed) {
     // Todo:
     // 调用open()函数，使用O_CREAT模式
     // 注意不能重复创建相同文件
     if (is_file(path)) {
         throw FileExistsError(path);
     }
-    int fd = open(path.c_str(), O_CREAT, S_IRUSR | S_IWUSR);
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
     if (fd == -1) {
         throw UnixError();
     }
+    if (compressed) {
+        try {
+            CompressedFile::format(fd);
+        } catch (RMDBError &e) {
+            close(fd);
+            unlink(path.c_str());
+            throw;
+        }
+    }
     close(fd);
 }
 
@@ -140,6 +553,8 @@ void DiskManager::destroy_file(const std::string &path) {
     if (unlink(path.c_str()) == -1) {
         throw UnixError();
     }
+    // 压缩文件正常关闭时留下的页面映射，普通文件没有该文件
+    unlink(CompressedFile::map_path(path).c_str());
 }
 
 
@@ -147,20 +562,39 @@ void DiskManager::destroy_file(const std::string &path) {
  * @description: 打开指定路径文件 
  * @return {int} 返回打开的文件的文件句柄
  * @param {string} &path 文件所在路径
+ * @param {bool} allow_direct_io 开启了direct I/O时是否对该文件使用O_DIRECT，日志等非按页读写的文件应传入false
  */
-int DiskManager::open_file(const std::string &path) {
+int DiskManager::open_file(const std::string &path, bool allow_direct_io) {
     // Todo:
     // 调用open()函数，使用O_RDWR模式。/
     // 注意不能重复打开相同文件，并且需要更新文件打开列表
-    if (path2fd_.count(path)) {
-        throw FileNotOpenError(path2fd_[path]);
+    int opened_fd = files_.find(path);
+    if (opened_fd >= 0) {
+        throw FileNotOpenError(opened_fd);
+    }
+    // 压缩页面的长度不是扇区的整数倍，压缩文件总是经过页缓存读写
+    bool compressed = CompressedFile::is_compressed(path);
+    bool direct = direct_io_ && allow_direct_io && !compressed;
+    int fd = open(path.c_str(), O_RDWR | (direct ? O_DIRECT : 0));
+    if (fd == -1 && direct && errno == EINVAL) {
+        // 文件系统不支持O_DIRECT（如tmpfs），退化为经过页缓存的普通读写
+        direct = false;
+        fd = open(path.c_str(), O_RDWR);
     }
-    int fd = open(path.c_str(), O_RDWR);
     if (fd == -1) {
         throw FileNotFoundError(path);
     }
-    path2fd_[path] = fd;
-    fd2path_[fd] = path;
+    try {
+        // 压缩文件的页面映射在登记之前建立，登记后OpenFile的内容不再修改
+        std::unique_ptr<CompressedFile> compressed_file;
+        if (compressed) {
+            compressed_file = std::make_unique<CompressedFile>(fd, path);
+        }
+        files_.add(fd, path, direct, std::move(compressed_file));
+    } catch (RMDBError &e) {
+        close(fd);
+        throw;
+    }
     return fd;
 }
 
@@ -172,15 +606,17 @@ void DiskManager::close_file(int fd) {
     // Todo:
     // 调用close()函数
     // 注意不能关闭未打开的文件，并且需要更新文件打开列表
-    if (!fd2path_.count(fd)) {
-        throw FileNotOpenError(fd);
+    {
+        OpenFileRef file = get_open_file(fd);
+        if (file->compressed != nullptr) {
+            file->compressed->close();
+        }
     }
+    // 先注销再关闭：close之后内核可能立即把同一个fd分配给其他线程新打开的文件
+    files_.remove(fd);
     if (close(fd) == -1) {
         throw UnixError();
     }
-    std::string path = fd2path_[fd];
-    path2fd_.erase(path);
-    fd2path_.erase(fd);
 }
 
 
@@ -200,12 +636,7 @@ int DiskManager::get_file_size(const std::string &file_name) {
  * @return {string} 文件句柄对应文件的文件名
  * @param {int} fd 文件句柄
  */
-std::string DiskManager::get_file_name(int fd) {
-    if (!fd2path_.count(fd)) {
-        throw FileNotOpenError(fd);
-    }
-    return fd2path_[fd];
-}
+std::string DiskManager::get_file_name(int fd) { return get_open_file(fd)->path; }
 
 /**
  * @description:  获得文件名对应的文件句柄
@@ -213,10 +644,106 @@ std::string DiskManager::get_file_name(int fd) {
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_fd(const std::string &file_name) {
-    if (!path2fd_.count(file_name)) {
+    int fd = files_.find(file_name);
+    if (fd < 0) {
         return open_file(file_name);
     }
-    return path2fd_[file_name];
+    return fd;
+}
+
+/**
+ * @description: 获得已打开文件的描述信息
+ * @return {OpenFileRef} fd对应的文件描述信息
+ * @param {int} fd 文件句柄，未打开时抛出FileNotOpenError
+ */
+OpenFileRef DiskManager::get_open_file(int fd) {
+    OpenFileRef file = files_.get(fd);
+    if (file == nullptr) {
+        throw FileNotOpenError(fd);
+    }
+    return file;
+}
+
+/**
+ * @description: 判断文件中是否已经写入过指定的页面
+ * @return {bool} 页面已写入时返回true；普通文件中页面超出文件末尾时返回false
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 页号
+ */
+bool DiskManager::has_page(int fd, page_id_t page_no) {
+    OpenFileRef file = get_open_file(fd);
+    if (file->compressed != nullptr) {
+        return file->compressed->has_page(page_no);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        throw UnixError();
+    }
+    return static_cast<off_t>(page_no + 1) * PAGE_SIZE <= st.st_size;
+}
+
+/**
+ * @description: 将文件已写入的数据持久化到磁盘
+ * @param {int} fd 文件句柄
+ */
+void DiskManager::sync_file(int fd) {
+    get_open_file(fd);
+    if (fdatasync(fd) == -1) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 读取压缩文件中的页面，解压后复制前num_bytes个字节，按实际读取的字节数统计I/O
+ * @param {OpenFile*} file 压缩格式的文件
+ * @param {page_id_t} page_no 页号
+ * @param {char*} offset 读取的内容写入到offset中
+ * @param {int} num_bytes 读取的数据量大小，不超过PAGE_SIZE
+ */
+void DiskManager::read_compressed_page(OpenFile *file, page_id_t page_no, char *offset, int num_bytes) {
+    if (num_bytes == PAGE_SIZE) {
+        file->count_io(false, file->compressed->read_page(page_no, offset));
+        return;
+    }
+    char page[PAGE_SIZE];
+    file->count_io(false, file->compressed->read_page(page_no, page));
+    memcpy(offset, page, num_bytes);
+}
+
+/**
+ * @description: 压缩并写入页面，按实际写入的字节数统计I/O
+ * @param {OpenFile*} file 压缩格式的文件
+ * @param {page_id_t} page_no 页号
+ * @param {char*} offset 要写入的数据
+ * @param {int} num_bytes 要写入的数据大小，不超过PAGE_SIZE；不足一页时覆盖原页面的前num_bytes个字节
+ */
+void DiskManager::write_compressed_page(OpenFile *file, page_id_t page_no, const char *offset, int num_bytes) {
+    if (num_bytes == PAGE_SIZE) {
+        file->count_io(true, file->compressed->write_page(page_no, offset));
+        return;
+    }
+    // 压缩页面只能整页写入：先读出原页面（尚未写入的页面视为全0），覆盖前num_bytes个字节后再写回
+    char page[PAGE_SIZE] = {};
+    if (file->compressed->has_page(page_no)) {
+        read_compressed_page(file, page_no, page, PAGE_SIZE);
+    }
+    memcpy(page, offset, num_bytes);
+    file->count_io(true, file->compressed->write_page(page_no, page));
+}
+
+/**
+ * @description: 获得文件自打开以来的I/O统计
+ * @return {FileIoStats} 读写次数和字节数
+ * @param {int} fd 文件句柄
+ */
+FileIoStats DiskManager::get_file_io_stats(int fd) {
+    OpenFileRef file = get_open_file(fd);
+    FileIoStats stats;
+    stats.num_reads = file->num_reads.load(std::memory_order_relaxed);
+    stats.num_writes = file->num_writes.load(std::memory_order_relaxed);
+    stats.bytes_read = file->bytes_read.load(std::memory_order_relaxed);
+    stats.bytes_written = file->bytes_written.load(std::memory_order_relaxed);
+    return stats;
 }
 
 
@@ -230,7 +757,7 @@ int DiskManager::get_file_fd(const std::string &file_name) {
 int DiskManager::read_log(char *log_data, int size, int offset) {
     // read log file from the previous end
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        log_fd_ = open_file(LOG_FILE_NAME, false);
     }
     int file_size = get_file_size(LOG_FILE_NAME);
     if (offset > file_size) {
@@ -239,8 +766,7 @@ int DiskManager::read_log(char *log_data, int size, int offset) {
 
     size = std::min(size, file_size - offset);
     if(size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
+    ssize_t bytes_read = pread(log_fd_, log_data, size, offset);
     assert(bytes_read == size);
     return bytes_read;
 }
@@ -253,7 +779,7 @@ int DiskManager::read_log(char *log_data, int size, int offset) {
  */
 void DiskManager::write_log(char *log_data, int size) {
     if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+        log_fd_ = open_file(LOG_FILE_NAME, false);
     }
 
     // write from the file_end
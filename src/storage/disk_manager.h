@@ -17,11 +17,13 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
-#include <unordered_map>
 
 #include "common/config.h"
 #include "errors.h"  
+#include "storage/file_registry.h"
+#include "storage/io_engine.h"
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -36,9 +38,33 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    /*连续页面的批量操作*/
+    void write_pages(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages);
+
+    void read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
+    /*异步页面操作*/
+    void submit_read_page(int fd, page_id_t page_no, char *offset, int num_bytes, IoRequest *req);
+
+    void submit_write_page(int fd, page_id_t page_no, const char *offset, int num_bytes, IoRequest *req);
+
+    void submit_read_pages(int fd, page_id_t start_page_no, struct iovec *iovs, int num_pages, IoRequest *req);
+
+    void submit_write_pages(int fd, page_id_t start_page_no, struct iovec *iovs, int num_pages, IoRequest *req);
+
+    void wait_page_io(IoRequest *req);
+
+    IoEngine *get_io_engine() { return io_engine_.get(); }
+
     page_id_t allocate_page(int fd);
 
-    void deallocate_page(page_id_t page_id);
+    void reserve_extent(int fd, page_id_t page_no);
+
+    void deallocate_page(int fd, page_id_t page_no);
+
+    int save_free_pages(int fd, char *dest, int max_size);
+
+    void load_free_pages(int fd, const char *src);
 
     /*目录操作*/
     bool is_dir(const std::string &path);
@@ -50,11 +76,11 @@ class DiskManager {
     /*文件操作*/
     bool is_file(const std::string &path);
 
-    void create_file(const std::string &path);
+    void create_file(const std::string &path, bool compressed = false);
 
     void destroy_file(const std::string &path);
 
-    int open_file(const std::string &path);
+    int open_file(const std::string &path, bool allow_direct_io = true);
 
     void close_file(int fd);
 
@@ -64,6 +90,13 @@ class DiskManager {
 
     int get_file_fd(const std::string &file_name);
 
+    /**
+     * @description: 获得已打开的文件对应的文件句柄，与get_file_fd不同，文件未打开时不会打开它
+     * @return {int} 文件句柄，文件未打开时返回-1
+     * @param {string} &file_name 打开文件时使用的路径
+     */
+    int find_open_file(const std::string &file_name) { return files_.find(file_name); }
+
     /*日志操作*/
     int read_log(char *log_data, int size, int offset);
 
@@ -78,22 +111,59 @@ class DiskManager {
      * @param {int} fd 文件对应的文件句柄
      * @param {int} start_page_no 已经分配的页面个数，即文件接下来从start_page_no开始分配页面编号
      */
-    void set_fd2pageno(int fd, int start_page_no) { fd2pageno_[fd] = start_page_no; }
+    void set_fd2pageno(int fd, int start_page_no) { get_open_file(fd)->num_pages = start_page_no; }
 
     /**
-     * @description: 获得文件目前已分配的页面个数，即如果文件要分配一个新页面，需要从fd2pagenp_[fd]开始分配
+     * @description: 获得文件目前已分配的页面个数，即如果文件要分配一个新页面，需要从这个页号开始分配
      * @return {page_id_t} 已分配的页面个数 
      * @param {int} fd 文件对应的句柄
      */
-    page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
+    page_id_t get_fd2pageno(int fd) { return get_open_file(fd)->num_pages; }
 
-    static constexpr int MAX_FD = 8192;
+    /**
+     * @description: 设置之后打开的数据文件是否使用O_DIRECT，已经打开的文件不受影响
+     * @param {bool} enable 为true时使用O_DIRECT
+     */
+    void set_direct_io(bool enable) { direct_io_ = enable; }
+
+    /**
+     * @description: 判断文件是否以O_DIRECT方式打开
+     * @return {bool} 若fd以O_DIRECT打开则返回true，文件系统不支持O_DIRECT时返回false
+     * @param {int} fd 文件句柄
+     */
+    bool is_direct_io(int fd) {
+        OpenFileRef file = files_.get(fd);
+        return file != nullptr && file->direct;
+    }
+
+    FileIoStats get_file_io_stats(int fd);
+
+    /**
+     * @description: 文件注册表中已被替换、还在等待读者离开的对象个数
+     */
+    size_t get_num_retired_files() const { return files_.num_retired(); }
+
+    bool is_compressed(int fd) {
+        OpenFileRef file = files_.get(fd);
+        return file != nullptr && file->compressed != nullptr;
+    }
+
+    bool has_page(int fd, page_id_t page_no);
+
+    void sync_file(int fd);
 
    private:
-    // 文件打开列表，用于记录文件是否被打开
-    std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
-    std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
+    OpenFileRef get_open_file(int fd);
+
+    void read_compressed_page(OpenFile *file, page_id_t page_no, char *offset, int num_bytes);
+
+    void write_compressed_page(OpenFile *file, page_id_t page_no, const char *offset, int num_bytes);
+
+    // 文件打开列表，记录每个已打开文件的路径、已分配页面、空闲页面和I/O统计，查找时不加锁
+    OpenFileRegistry files_;
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
-    std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+    std::unique_ptr<IoEngine> io_engine_;         // 异步I/O引擎
+    std::mutex extent_latch_;                     // 串行化文件的预分配
+    bool direct_io_ = ENABLE_DIRECT_IO;           // 新打开的数据文件是否使用O_DIRECT
 };
\ No newline at end of file
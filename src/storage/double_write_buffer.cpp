@@ -0,0 +1,249 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/double_write_buffer.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "storage/checksum.h"
+#include "storage/io_engine.h"
+
+DoubleWriteBuffer::DoubleWriteBuffer(DiskManager *disk_manager, int capacity)
+    : disk_manager_(disk_manager), capacity_(capacity) {}
+
+DoubleWriteBuffer::~DoubleWriteBuffer() {
+    try {
+        close();
+    } catch (RMDBError &e) {
+        // 析构时无法报告错误，双写文件中的副本在下次打开时仍然有效
+    }
+}
+
+/**
+ * @description: 打开双写文件（不存在时创建），先用其中的页面副本修复损坏的数据页，再清空双写文件
+ * @return {int} 被修复的页面个数
+ * @param {string&} path 双写文件路径，需要在打开任何数据文件之前调用
+ */
+int DoubleWriteBuffer::open(const std::string &path) {
+    if (fd_ >= 0) {
+        throw InternalError("DoubleWriteBuffer::open: already opened");
+    }
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd_ < 0) {
+        throw UnixError();
+    }
+    int restored = recover();
+    reset_file();
+    return restored;
+}
+
+/**
+ * @description: 等待在途批次完成，把写回原位置的页面落盘后清空并关闭双写文件
+ */
+void DoubleWriteBuffer::close() {
+    if (fd_ < 0) {
+        return;
+    }
+    std::unique_lock lock{latch_};
+    cv_.wait(lock, [this] { return inflight_ == 0; });
+    if (syncfs(fd_) < 0) {
+        throw UnixError();
+    }
+    reset_file();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+/**
+ * @description: 把一批页面写入双写文件并落盘，返回后调用者才能把这些页面写回原位置，写回完成后调用finish()
+ * @param {PageId*} page_ids 各页面的PageId
+ * @param {char**} pages 各页面的数据，直到finish()之前都不能被修改
+ * @param {int} num_pages 页面个数，不能超过capacity()
+ */
+void DoubleWriteBuffer::stage(const PageId *page_ids, char *const *pages, int num_pages) {
+    assert(num_pages > 0 && num_pages <= capacity_);
+    std::unique_lock lock{latch_};
+    if (next_slot_ + num_pages > capacity_) {
+        // 槽位用完，从头复用之前必须保证之前各批次写回原位置的页面已经落盘
+        cv_.wait(lock, [this] { return inflight_ == 0; });
+        if (syncfs(fd_) < 0) {
+            throw UnixError();
+        }
+        next_slot_ = 0;
+    }
+
+    std::vector<Entry> entries(num_pages);
+    std::vector<struct iovec> iovs(num_pages);
+    int last_fd = -1;
+    Entry file_info;  // 同一批次中的页面通常来自同一个文件，缓存上一个文件的信息
+    for (int i = 0; i < num_pages; i++) {
+        Entry &entry = entries[i];
+        memset(&entry, 0, sizeof(entry));
+        if (page_ids[i].fd != last_fd) {
+            std::string file_name = disk_manager_->get_file_name(page_ids[i].fd);
+            if (file_name.size() >= sizeof(entry.file_name)) {
+                throw InternalError("DoubleWriteBuffer: file name too long: " + file_name);
+            }
+            struct stat st;
+            if (fstat(page_ids[i].fd, &st) < 0) {
+                throw UnixError();
+            }
+            memset(&file_info, 0, sizeof(file_info));
+            file_info.inode = st.st_ino;
+            memcpy(file_info.file_name, file_name.c_str(), file_name.size());
+            last_fd = page_ids[i].fd;
+        }
+        entry.page_no = page_ids[i].page_no;
+        entry.seq = next_seq_;
+        entry.inode = file_info.inode;
+        memcpy(entry.file_name, file_info.file_name, sizeof(entry.file_name));
+        entry.crc = entry_crc(entry, pages[i]);
+        iovs[i] = {pages[i], PAGE_SIZE};
+    }
+
+    // 描述区和页面副本区各一次顺序写，然后只做一次fdatasync
+    struct iovec entries_iov = {entries.data(), num_pages * sizeof(Entry)};
+    ssize_t entries_bytes = positional_io(fd_, &entries_iov, 1, next_slot_ * sizeof(Entry), true);
+    ssize_t pages_bytes =
+        positional_io(fd_, iovs.data(), num_pages, entries_size() + static_cast<off_t>(next_slot_) * PAGE_SIZE, true);
+    if (entries_bytes != static_cast<ssize_t>(entries_iov.iov_len) ||
+        pages_bytes != static_cast<ssize_t>(num_pages) * PAGE_SIZE) {
+        throw InternalError("DoubleWriteBuffer::stage Error");
+    }
+    if (fdatasync(fd_) < 0) {
+        throw UnixError();
+    }
+    next_slot_ += num_pages;
+    next_seq_++;
+    inflight_++;
+}
+
+/**
+ * @description: 通知双写缓冲区一个批次已经写回原位置（无论成功与否），其槽位可以在落盘后被复用
+ */
+void DoubleWriteBuffer::finish() {
+    {
+        std::scoped_lock lock{latch_};
+        inflight_--;
+    }
+    cv_.notify_all();
+}
+
+uint32_t DoubleWriteBuffer::entry_crc(const Entry &entry, const char *page) {
+    uint32_t crc = crc32c(reinterpret_cast<const char *>(&entry) + sizeof(entry.crc), sizeof(Entry) - sizeof(entry.crc));
+    return crc32c(page, PAGE_SIZE, crc);
+}
+
+/**
+ * @description: 扫描双写文件中完整的页面副本，若数据文件中对应的页面校验失败，说明写回时发生了崩溃，用副本覆盖
+ * @return {int} 被修复的页面个数
+ */
+int DoubleWriteBuffer::recover() {
+    struct stat st;
+    if (fstat(fd_, &st) < 0) {
+        throw UnixError();
+    }
+    int num_slots = 0;
+    if (st.st_size > entries_size()) {
+        num_slots = std::min<off_t>(capacity_, (st.st_size - entries_size()) / PAGE_SIZE);
+    }
+    if (num_slots == 0) {
+        return 0;
+    }
+    std::vector<Entry> entries(num_slots);
+    std::vector<char> copies(static_cast<size_t>(num_slots) * PAGE_SIZE);
+    if (pread(fd_, entries.data(), num_slots * sizeof(Entry), 0) != static_cast<ssize_t>(num_slots * sizeof(Entry)) ||
+        pread(fd_, copies.data(), copies.size(), entries_size()) != static_cast<ssize_t>(copies.size())) {
+        throw InternalError("DoubleWriteBuffer::recover Error");
+    }
+
+    // 同一页面可能有多个副本，只考虑序号最大的那个
+    std::map<std::pair<std::string, page_id_t>, int> latest;
+    for (int i = 0; i < num_slots; i++) {
+        Entry &entry = entries[i];
+        if (entry.seq == 0 || entry.file_name[sizeof(entry.file_name) - 1] != '\0' ||
+            entry.crc != entry_crc(entry, &copies[static_cast<size_t>(i) * PAGE_SIZE])) {
+            continue;  // 空槽位或没有写完整的槽位
+        }
+        auto key = std::make_pair(std::string(entry.file_name), entry.page_no);
+        auto iter = latest.find(key);
+        if (iter == latest.end() || entries[iter->second].seq < entry.seq) {
+            latest[key] = i;
+        }
+    }
+
+    // 通过DiskManager读写数据文件，普通文件和压缩格式的文件都能恢复
+    int restored = 0;
+    char page[PAGE_SIZE];
+    for (auto &[key, slot] : latest) {
+        int fd;
+        bool opened = true;
+        try {
+            fd = disk_manager_->open_file(key.first);
+        } catch (FileNotOpenError &e) {
+            fd = disk_manager_->get_file_fd(key.first);  // 文件已经打开，修复后不关闭
+            opened = false;
+        } catch (RMDBError &e) {
+            continue;  // 文件已经被删除
+        }
+        struct stat file_st;
+        bool torn = false;
+        // 页面不存在说明对它的写回没有开始，数据文件不受影响；读取失败（压缩页面损坏）或校验和不符说明页面写坏了
+        if (fstat(fd, &file_st) == 0 && file_st.st_ino == entries[slot].inode && disk_manager_->has_page(fd, key.second)) {
+            try {
+                disk_manager_->read_page(fd, key.second, page, PAGE_SIZE);
+                torn = !verify_page_checksum(page);
+            } catch (InternalError &e) {
+                torn = true;
+            }
+        }
+        bool failed = false;
+        if (torn) {
+            try {
+                disk_manager_->write_page(fd, key.second, &copies[static_cast<size_t>(slot) * PAGE_SIZE], PAGE_SIZE);
+                disk_manager_->sync_file(fd);
+                restored++;
+            } catch (RMDBError &e) {
+                failed = true;
+            }
+        }
+        if (opened) {
+            disk_manager_->close_file(fd);
+        }
+        if (failed) {
+            throw InternalError("DoubleWriteBuffer::recover: failed to restore " + key.first);
+        }
+    }
+    return restored;
+}
+
+/**
+ * @description: 清空双写文件中的所有槽位，并把文件扩展到完整大小
+ */
+void DoubleWriteBuffer::reset_file() {
+    if (ftruncate(fd_, 0) < 0 || ftruncate(fd_, entries_size() + static_cast<off_t>(capacity_) * PAGE_SIZE) < 0 ||
+        fdatasync(fd_) < 0) {
+        throw UnixError();
+    }
+    next_slot_ = 0;
+}
+
+/** @return 双写文件开头描述区的大小，按页对齐 */
+off_t DoubleWriteBuffer::entries_size() const {
+    off_t size = static_cast<off_t>(capacity_) * sizeof(Entry);
+    return (size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#include "common/config.h"
+#include "disk_manager.h"
+#include "page.h"
+
+/**
+ * @description: 双写缓冲区，防止崩溃时写了一半的页面（torn page）无法恢复
+ *               脏页在写回数据文件之前，先成批顺序写入双写文件并fdatasync一次，之后再写回原位置；
+ *               若写回原位置时崩溃，重启时用双写文件中完整的页面副本覆盖损坏的页面
+ * @note 双写文件由若干槽位组成，循环使用。一个槽位被重新使用前，会先把之前写回原位置的页面全部落盘
+ *       判断页面是否损坏依赖页面校验和，因此只有缓冲池启用了页面校验和时才能使用双写缓冲区
+ */
+class DoubleWriteBuffer {
+   public:
+    /**
+     * @param {DiskManager*} disk_manager 磁盘管理器，用于由文件句柄得到文件名
+     * @param {int} capacity 槽位个数，即一批最多可以写入的页面数
+     */
+    DoubleWriteBuffer(DiskManager *disk_manager, int capacity = DOUBLE_WRITE_PAGES);
+
+    ~DoubleWriteBuffer();
+
+    int open(const std::string &path);
+
+    void close();
+
+    /** @return 一批最多可以写入的页面数，调用者需要把更大的批次拆开 */
+    int capacity() const { return capacity_; }
+
+    void stage(const PageId *page_ids, char *const *pages, int num_pages);
+
+    void finish();
+
+   private:
+    /**
+     * @description: 双写文件中每个槽位的描述信息，位于文件开头的描述区
+     */
+    struct Entry {
+        uint32_t crc;        // 覆盖本结构其余字段和页面副本的校验和，用于识别未写完整的槽位
+        page_id_t page_no;   // 页面在数据文件中的页号
+        uint64_t seq;        // 批次序号，同一页面有多个副本时以序号最大的为准
+        uint64_t inode;      // 数据文件的inode号，防止把副本写入之后重新创建的同名文件
+        char file_name[232]; // 数据文件名，相对于数据库目录，以'\0'结尾
+    };
+    static_assert(sizeof(Entry) == 256, "DoubleWriteBuffer::Entry must be 256 bytes");
+
+    static uint32_t entry_crc(const Entry &entry, const char *page);
+
+    int recover();
+
+    void reset_file();
+
+    off_t entries_size() const;
+
+    DiskManager *disk_manager_;
+    int capacity_;
+    int fd_ = -1;                   // 双写文件的文件句柄，未打开时为-1
+    std::mutex latch_;              // 串行化对双写文件的写入，保护next_slot_和inflight_
+    std::condition_variable cv_;    // 在途批次全部写回原位置后唤醒等待复用槽位的线程
+    int next_slot_ = 0;             // 下一批写入的起始槽位
+    int inflight_ = 0;              // 已写入双写文件、尚未完成原位置写回的批次数
+    uint64_t next_seq_ = 1;         // 下一批次的序号
+};
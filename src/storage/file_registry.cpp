@@ -0,0 +1,142 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/file_registry.h"
+
+#include <algorithm>
+
+#include "errors.h"
+#include "storage/compressed_file.h"
+
+OpenFile::OpenFile(int fd, const std::string &path, bool direct, std::unique_ptr<CompressedFile> compressed)
+    : fd(fd), path(path), direct(direct), compressed(std::move(compressed)) {}
+
+OpenFile::~OpenFile() = default;
+
+OpenFileRegistry::OpenFileRegistry() : paths_(new PathMap()) {}
+
+OpenFileRegistry::~OpenFileRegistry() {
+    for (auto &chunk_ptr : chunks_) {
+        Chunk *chunk = chunk_ptr.load();
+        if (chunk == nullptr) {
+            continue;
+        }
+        for (auto &file : chunk->files) {
+            delete file.load();
+        }
+        delete chunk;
+    }
+    delete paths_.load();
+}
+
+/**
+ * @description: 查找路径对应的已打开文件的fd，不加锁，读取当前发布的路径快照
+ * @return {int} 文件未打开时返回-1
+ * @param {string&} path 打开文件时使用的路径
+ */
+int OpenFileRegistry::find(const std::string &path) const {
+    OpenFileRef ref(enter());
+    const PathMap *paths = paths_.load(std::memory_order_seq_cst);
+    auto iter = paths->find(path);
+    return iter == paths->end() ? -1 : iter->second;
+}
+
+/**
+ * @description: 登记一个新打开的文件，需要时分配第二级数组；该fd之前使用过的OpenFile对象被替换下来，
+ *               其他线程此前通过get()取得的引用仍然有效，且看到的内容不会改变
+ * @return {OpenFile*} 登记后的文件描述信息
+ * @param {int} fd 文件句柄
+ * @param {string&} path 文件路径
+ * @param {bool} direct 是否以O_DIRECT打开
+ * @param {unique_ptr<CompressedFile>} compressed 页面压缩格式的文件，普通文件为空
+ */
+OpenFile *OpenFileRegistry::add(int fd, const std::string &path, bool direct,
+                                std::unique_ptr<CompressedFile> compressed) {
+    if (fd < 0 || fd >= CHUNK_SIZE * MAX_CHUNKS) {
+        throw InternalError("OpenFileRegistry: fd out of range: " + std::to_string(fd));
+    }
+    auto file = std::make_unique<OpenFile>(fd, path, direct, std::move(compressed));
+    std::scoped_lock lock{latch_};
+    auto &chunk_ptr = chunks_[fd >> CHUNK_BITS];
+    Chunk *chunk = chunk_ptr.load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new Chunk();
+        chunk_ptr.store(chunk, std::memory_order_seq_cst);
+    }
+    auto paths = std::make_unique<PathMap>(*paths_.load(std::memory_order_relaxed));
+    (*paths)[path] = fd;
+    publish_paths(std::move(paths));
+    OpenFile *old_file = chunk->files[fd & (CHUNK_SIZE - 1)].exchange(file.get(), std::memory_order_seq_cst);
+    if (old_file != nullptr) {
+        retire(std::unique_ptr<OpenFile>(old_file), nullptr);
+    }
+    reclaim();
+    return file.release();
+}
+
+/**
+ * @description: 注销一个已关闭的文件，OpenFile对象留在原槽位中，直到相同的fd再次登记时才被替换
+ * @param {int} fd 文件句柄
+ */
+void OpenFileRegistry::remove(int fd) {
+    std::scoped_lock lock{latch_};
+    OpenFile *file = get(fd).get();
+    if (file == nullptr) {
+        return;
+    }
+    file->is_open.store(false, std::memory_order_release);
+    auto paths = std::make_unique<PathMap>(*paths_.load(std::memory_order_relaxed));
+    paths->erase(file->path);
+    publish_paths(std::move(paths));
+    reclaim();
+}
+
+/**
+ * @description: 原子地替换路径快照，旧快照等待读者离开后释放，调用者需持有latch_
+ * @param {unique_ptr<PathMap>} paths 新的路径快照
+ */
+void OpenFileRegistry::publish_paths(std::unique_ptr<PathMap> paths) {
+    const PathMap *old_paths = paths_.exchange(paths.release(), std::memory_order_seq_cst);
+    retire(nullptr, std::unique_ptr<const PathMap>(old_paths));
+}
+
+/**
+ * @description: 记录一个已经不能再被新读者读到的对象，此时仍有读者的计数器都要再观察到一次0，调用者需持有latch_
+ * @param {unique_ptr<OpenFile>} file 被替换下来的OpenFile
+ * @param {unique_ptr<const PathMap>} paths 被替换下来的路径快照
+ */
+void OpenFileRegistry::retire(std::unique_ptr<OpenFile> file, std::unique_ptr<const PathMap> paths) {
+    uint64_t pending_slots = 0;
+    for (int i = 0; i < NUM_READER_SLOTS; i++) {
+        if (reader_slots_[i].num_readers.load(std::memory_order_seq_cst) != 0) {
+            pending_slots |= uint64_t{1} << i;
+        }
+    }
+    retired_.push_back({pending_slots, std::move(file), std::move(paths)});
+}
+
+/**
+ * @description: 释放所有读者都已离开的对象，调用者需持有latch_
+ *               计数器观察到0时，替换之前登记在该计数器上的读者都已离开，之后登记的读者只能读到新的指针
+ */
+void OpenFileRegistry::reclaim() {
+    uint64_t idle_slots = 0;
+    for (int i = 0; i < NUM_READER_SLOTS; i++) {
+        if (reader_slots_[i].num_readers.load(std::memory_order_seq_cst) == 0) {
+            idle_slots |= uint64_t{1} << i;
+        }
+    }
+    for (auto &retired : retired_) {
+        retired.pending_slots &= ~idle_slots;
+    }
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [](const Retired &retired) { return retired.pending_slots == 0; }),
+                   retired_.end());
+}
@@ -0,0 +1,199 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+class CompressedFile;
+
+/**
+ * @description: 一个文件上的I/O统计
+ */
+struct FileIoStats {
+    uint64_t num_reads = 0;      // 读请求次数
+    uint64_t num_writes = 0;     // 写请求次数
+    uint64_t bytes_read = 0;     // 读取的字节数
+    uint64_t bytes_written = 0;  // 写入的字节数
+};
+
+/**
+ * @description: 一个已打开文件的描述信息，每次open_file都创建一个新的对象
+ * @note 对象不会被复用：同一fd再次登记时旧对象被替换下来，等到没有OpenFileRef可能持有它时才释放，
+ *       因此持有OpenFileRef的线程不会访问到已释放或被改写的内存；fd、path、direct和compressed在登记之前设置，之后不再修改
+ */
+struct OpenFile {
+    OpenFile(int fd, const std::string &path, bool direct, std::unique_ptr<CompressedFile> compressed);
+
+    ~OpenFile();
+
+    const int fd;
+    const std::string path;                     // 打开文件时使用的路径
+    const bool direct;                          // 是否以O_DIRECT打开，此时读写的缓冲区、长度和偏移量都必须对齐
+    const std::unique_ptr<CompressedFile> compressed;  // 页面压缩格式的文件，普通文件为空
+    std::atomic<bool> is_open{true};            // 文件关闭后置为false
+
+    std::atomic<page_id_t> num_pages{0};        // 文件中已经分配的页面个数，即下一个追加分配的页号
+    std::atomic<page_id_t> extent_end{0};       // 文件中已经用fallocate预分配的页面个数，页号小于它的页面已有磁盘空间
+    std::mutex free_pages_latch;                // 保护free_pages
+    std::set<page_id_t> free_pages;             // 文件中已释放、可以重新分配的页面，按页号有序，分配时从最小的开始
+
+    // 读写统计，压缩格式的文件按实际读写磁盘的字节数统计
+    std::atomic<uint64_t> num_reads{0};
+    std::atomic<uint64_t> num_writes{0};
+    std::atomic<uint64_t> bytes_read{0};
+    std::atomic<uint64_t> bytes_written{0};
+
+    void count_io(bool is_write, uint64_t num_bytes) {
+        (is_write ? num_writes : num_reads).fetch_add(1, std::memory_order_relaxed);
+        (is_write ? bytes_written : bytes_read).fetch_add(num_bytes, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @description: OpenFileRegistry::get()返回的文件引用，存在期间调用线程登记为注册表的读者，
+ *               其指向的OpenFile不会被释放；只应在一次操作内持有，不要保存
+ */
+class OpenFileRef {
+   public:
+    OpenFileRef(OpenFileRef &&other) noexcept : file_(other.file_), readers_(other.readers_) {
+        other.readers_ = nullptr;
+    }
+
+    OpenFileRef(const OpenFileRef &) = delete;
+    OpenFileRef &operator=(const OpenFileRef &) = delete;
+    OpenFileRef &operator=(OpenFileRef &&) = delete;
+
+    ~OpenFileRef() {
+        if (readers_ != nullptr) {
+            readers_->fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    OpenFile *get() const { return file_; }
+    OpenFile *operator->() const { return file_; }
+    bool operator==(std::nullptr_t) const { return file_ == nullptr; }
+    bool operator!=(std::nullptr_t) const { return file_ != nullptr; }
+
+   private:
+    friend class OpenFileRegistry;
+
+    explicit OpenFileRef(std::atomic<uint32_t> *readers) : readers_(readers) {}
+
+    OpenFile *file_ = nullptr;
+    std::atomic<uint32_t> *readers_;    // 登记读者时递增的计数器，析构时递减
+};
+
+/**
+ * @description: 已打开文件的注册表，取代按fd下标的定长数组和无同步的路径哈希表
+ *               fd到OpenFile和路径到fd的查找都不加锁：读者先在本线程的读者计数器上登记，再原子地读取指针；
+ *               fd到OpenFile为两级指针数组，第一级定长，第二级按需分配，可容纳的fd随之增长；
+ *               路径到fd为只读的哈希表快照，打开、关闭文件时在latch_下复制修改后原子地替换
+ *               被替换下来的OpenFile和快照放入retired_，替换时仍有读者的计数器都观察到0之后，才可能没有读者持有它们，此时释放
+ */
+class OpenFileRegistry {
+   public:
+    static constexpr int CHUNK_BITS = 10;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;  // 每个第二级数组容纳的fd个数
+    static constexpr int MAX_CHUNKS = 1 << 10;          // 第一级数组的大小，最多容纳2^20个fd，与Linux的nr_open默认值一致
+    static constexpr int NUM_READER_SLOTS = 64;         // 读者计数器的个数，线程按登记顺序分散到各个计数器上
+
+    OpenFileRegistry();
+
+    ~OpenFileRegistry();
+
+    /**
+     * @description: 查找fd对应的已打开文件，不加锁
+     * @return {OpenFileRef} fd未打开时指向nullptr
+     * @param {int} fd 文件句柄
+     */
+    OpenFileRef get(int fd) const {
+        OpenFileRef ref(enter());
+        if (fd < 0 || fd >= CHUNK_SIZE * MAX_CHUNKS) {
+            return ref;
+        }
+        Chunk *chunk = chunks_[fd >> CHUNK_BITS].load(std::memory_order_seq_cst);
+        if (chunk == nullptr) {
+            return ref;
+        }
+        OpenFile *file = chunk->files[fd & (CHUNK_SIZE - 1)].load(std::memory_order_seq_cst);
+        if (file != nullptr && file->is_open.load(std::memory_order_acquire)) {
+            ref.file_ = file;
+        }
+        return ref;
+    }
+
+    int find(const std::string &path) const;
+
+    OpenFile *add(int fd, const std::string &path, bool direct, std::unique_ptr<CompressedFile> compressed);
+
+    void remove(int fd);
+
+    /**
+     * @description: 已被替换、还在等待读者离开的对象个数
+     */
+    size_t num_retired() const {
+        std::scoped_lock lock{latch_};
+        return retired_.size();
+    }
+
+   private:
+    using PathMap = std::unordered_map<std::string, int>;   // <文件路径, fd>
+
+    struct Chunk {
+        std::atomic<OpenFile *> files[CHUNK_SIZE]{};
+    };
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint32_t> num_readers{0};
+    };
+
+    /**
+     * @description: 一个被替换下来的对象，pending_slots中的计数器都观察到0之后释放
+     */
+    struct Retired {
+        uint64_t pending_slots;
+        std::unique_ptr<OpenFile> file;
+        std::unique_ptr<const PathMap> paths;
+    };
+
+    /**
+     * @description: 在本线程的读者计数器上登记，之后读取的指针在递减计数器之前不会被释放
+     * @return {atomic<uint32_t>*} 登记的计数器
+     */
+    std::atomic<uint32_t> *enter() const {
+        static std::atomic<uint32_t> next_slot{0};
+        thread_local uint32_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % NUM_READER_SLOTS;
+        auto &readers = reader_slots_[slot].num_readers;
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        return &readers;
+    }
+
+    void retire(std::unique_ptr<OpenFile> file, std::unique_ptr<const PathMap> paths);
+
+    void reclaim();
+
+    void publish_paths(std::unique_ptr<PathMap> paths);
+
+    std::atomic<Chunk *> chunks_[MAX_CHUNKS]{};
+    std::atomic<const PathMap *> paths_;
+    mutable ReaderSlot reader_slots_[NUM_READER_SLOTS];
+    mutable std::mutex latch_;                  // 保护retired_，串行化add和remove
+    std::vector<Retired> retired_;              // 已被替换、可能仍被读者持有的对象
+};
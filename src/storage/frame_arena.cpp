@@ -0,0 +1,73 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "errors.h"
+
+FrameArena::FrameArena(size_t size, bool use_huge_pages) {
+    size_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (use_huge_pages) {
+        // 预留的大页在映射时就从大页池中扣除，大页不够时mmap直接失败，不会在访问时才因缺页收到SIGBUS
+        void *addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (addr != MAP_FAILED) {
+            data_ = static_cast<char *>(addr);
+            hugetlb_ = true;
+            return;
+        }
+    }
+    // 匿名映射由内核按需清零，只有被访问过的帧占用物理内存；不预留交换空间
+    // 多映射一个大页的长度，从中截取按HUGE_PAGE_SIZE对齐的部分，透明大页才能覆盖整个区域
+    size_t map_size = use_huge_pages ? size_ + HUGE_PAGE_SIZE : size_;
+    void *addr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED) {
+        throw UnixError();
+    }
+    char *start = static_cast<char *>(addr);
+    if (!use_huge_pages) {
+        data_ = start;
+        return;
+    }
+    auto begin = reinterpret_cast<uintptr_t>(start);
+    auto aligned = (begin + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    data_ = reinterpret_cast<char *>(aligned);
+    if (aligned > begin) {
+        munmap(start, aligned - begin);
+    }
+    size_t tail = map_size - (aligned - begin) - size_;
+    if (tail > 0) {
+        munmap(data_ + size_, tail);
+    }
+    // 内核不支持或禁用了透明大页时失败，此时仍然使用普通页面
+    madvise(data_, size_, MADV_HUGEPAGE);
+}
+
+FrameArena::~FrameArena() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+}
+
+/**
+ * @description: 把[offset, offset + length)之内的内存归还给操作系统，之后再访问时由内核重新分配并清零
+ * 预留的大页不归还：MADV_DONTNEED释放私有映射的大页后，该大页的预留不一定恢复，再次访问时可能因大页池耗尽而收到SIGBUS
+ */
+void FrameArena::release(size_t offset, size_t length) {
+    if (hugetlb_ || length == 0) {
+        return;
+    }
+    madvise(data_ + offset, length, MADV_DONTNEED);
+}
@@ -0,0 +1,47 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @description: 缓冲池实例存放页面数据的一块连续内存，与Page对象中的元数据分开分配
+ * 优先使用预留的2MB大页（MAP_HUGETLB），系统没有足够的大页时退化为按2MB对齐的匿名映射并通过MADV_HUGEPAGE
+ * 请求透明大页；一个2MB大页覆盖512帧，随机访问页面时TLB缺失大大减少
+ */
+class FrameArena {
+   public:
+    /**
+     * @param {size_t} size 需要的字节数，按HUGE_PAGE_SIZE向上取整
+     * @param {bool} use_huge_pages 是否尝试大页，为false时使用普通的4KB页面
+     */
+    FrameArena(size_t size, bool use_huge_pages);
+
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    char *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    // 内存是否来自预留的大页
+    bool is_hugetlb() const { return hugetlb_; }
+
+    void release(size_t offset, size_t length);
+
+   private:
+    char *data_ = nullptr;
+    size_t size_ = 0;
+    bool hugetlb_ = false;
+};
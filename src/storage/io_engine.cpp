@@ -0,0 +1,362 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/io_engine.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "errors.h"
+
+ssize_t positional_io(int fd, const struct iovec *iov, int iov_cnt, off_t offset, bool is_write) {
+    // 只有发生短读写时才需要修改iovec，此时复制一份剩余部分
+    std::vector<struct iovec> rest;
+    ssize_t total = 0;
+    while (iov_cnt > 0) {
+        int cnt = std::min(iov_cnt, IOV_MAX);
+        ssize_t ret = is_write ? pwritev(fd, iov, cnt, offset + total) : preadv(fd, iov, cnt, offset + total);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            return -errno;
+        }
+        if (ret == 0) {
+            break;  // 读到文件末尾
+        }
+        total += ret;
+        // 跳过已经完整读写的缓冲区
+        while (iov_cnt > 0 && static_cast<size_t>(ret) >= iov->iov_len) {
+            ret -= iov->iov_len;
+            iov++;
+            iov_cnt--;
+        }
+        if (ret > 0) {
+            rest.assign(iov, iov + iov_cnt);
+            rest[0].iov_base = static_cast<char *>(rest[0].iov_base) + ret;
+            rest[0].iov_len -= ret;
+            iov = rest.data();
+        }
+    }
+    return total;
+}
+
+/**
+ * @description: 等待一个请求完成
+ * @param {IoRequest*} req 已经提交的请求，不能设置callback
+ */
+void IoEngine::wait(IoRequest *req) {
+    std::unique_lock lock{done_latch_};
+    done_cv_.wait(lock, [req] { return req->done; });
+}
+
+/**
+ * @description: 记录请求的结果并通知等待者；若设置了回调则执行回调，回调之后请求的所有权归回调
+ *               调用者也可以用它直接完成一个在提交线程中同步执行、没有交给引擎的请求
+ * @param {IoRequest*} req 完成的请求
+ * @param {int} result 实际读写的字节数或-errno
+ */
+void IoEngine::complete(IoRequest *req, int result) {
+    req->result = result;
+    if (req->callback) {
+        auto callback = std::move(req->callback);
+        callback(req);
+        return;
+    }
+    {
+        std::scoped_lock lock{done_latch_};
+        req->done = true;
+    }
+    done_cv_.notify_all();
+}
+
+/**
+ * @description: 根据type创建I/O引擎，io_uring创建失败（内核不支持或被禁用）时退化为线程池
+ * @param {string&} type "URING"或"THREAD_POOL"
+ * @param {int} queue_depth io_uring提交队列长度
+ * @param {int} num_threads 线程池的线程数
+ */
+std::unique_ptr<IoEngine> IoEngine::create(const std::string &type, int queue_depth, int num_threads) {
+    if (type == "URING") {
+        try {
+            return std::make_unique<UringIoEngine>(queue_depth);
+        } catch (UnixError &e) {
+            // fall through to thread pool
+        }
+    }
+    return std::make_unique<ThreadPoolIoEngine>(num_threads);
+}
+
+/* ---------------------------------- ThreadPoolIoEngine ---------------------------------- */
+
+ThreadPoolIoEngine::ThreadPoolIoEngine(int num_threads) {
+    for (int i = 0; i < num_threads; i++) {
+        workers_.emplace_back(&ThreadPoolIoEngine::worker, this);
+    }
+}
+
+ThreadPoolIoEngine::~ThreadPoolIoEngine() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPoolIoEngine::submit(IoRequest *req) {
+    {
+        std::scoped_lock lock{latch_};
+        req->done = false;
+        req->iov.iov_base = req->buf;
+        req->iov.iov_len = req->num_bytes;
+        queue_.push_back(req);
+    }
+    cv_.notify_one();
+}
+
+/**
+ * @description: 工作线程，循环取出请求并用pread/pwrite执行，处理短读写
+ */
+void ThreadPoolIoEngine::worker() {
+    while (true) {
+        IoRequest *req;
+        {
+            std::unique_lock lock{latch_};
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            req = queue_.front();
+            queue_.pop_front();
+        }
+        ssize_t total = req->iov_cnt > 0 ? positional_io(req->fd, req->iovs, req->iov_cnt, req->offset, req->is_write)
+                                         : positional_io(req->fd, &req->iov, 1, req->offset, req->is_write);
+        complete(req, total);
+    }
+}
+
+/* ---------------------------------- UringIoEngine ---------------------------------- */
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+UringIoEngine::UringIoEngine(int queue_depth) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = io_uring_setup(queue_depth, &params);
+    if (ring_fd_ < 0) {
+        throw UnixError();
+    }
+    entries_ = params.sq_entries;
+
+    sq_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+        close(ring_fd_);
+        throw UnixError();
+    }
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ = mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            munmap(sq_ptr_, sq_len_);
+            close(ring_fd_);
+            throw UnixError();
+        }
+    }
+    sqes_len_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe *>(
+        mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+        if (!single_mmap) munmap(cq_ptr_, cq_len_);
+        munmap(sq_ptr_, sq_len_);
+        close(ring_fd_);
+        throw UnixError();
+    }
+
+    char *sq = static_cast<char *>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    reaper_ = std::thread(&UringIoEngine::reap, this);
+}
+
+UringIoEngine::~UringIoEngine() {
+    // 提交一个user_data为0的NOP请求，完成线程收到后退出
+    {
+        std::unique_lock lock{sq_latch_};
+        sq_cv_.wait(lock, [this] { return inflight_ < entries_; });
+        push_sqe(nullptr, IORING_OP_NOP);
+    }
+    reaper_.join();
+    munmap(sqes_, sqes_len_);
+    if (cq_ptr_ != sq_ptr_) {
+        munmap(cq_ptr_, cq_len_);
+    }
+    munmap(sq_ptr_, sq_len_);
+    close(ring_fd_);
+}
+
+void UringIoEngine::submit(IoRequest *req) {
+    req->done = false;
+    req->iov.iov_base = req->buf;
+    req->iov.iov_len = req->num_bytes;
+    req->num_done = 0;
+    req->rest_iovs.clear();
+    std::unique_lock lock{sq_latch_};
+    // 在途请求数达到队列长度时等待，保证完成队列不会溢出
+    sq_cv_.wait(lock, [this] { return inflight_ < entries_; });
+    push_sqe(req, req->is_write ? IORING_OP_WRITEV : IORING_OP_READV);
+}
+
+/**
+ * @description: 填写一个SQE并通知内核，调用者需持有sq_latch_且保证队列有空位
+ */
+void UringIoEngine::push_sqe(IoRequest *req, unsigned char opcode) {
+    unsigned tail = *sq_tail_;  // 只有持有sq_latch_的线程会修改tail
+    unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    if (req != nullptr) {
+        sqe->fd = req->fd;
+        sqe->off = req->offset + req->num_done;
+        if (!req->rest_iovs.empty()) {
+            sqe->addr = reinterpret_cast<unsigned long>(req->rest_iovs.data());
+            sqe->len = req->rest_iovs.size();
+        } else if (req->iov_cnt > 0) {
+            sqe->addr = reinterpret_cast<unsigned long>(req->iovs);
+            sqe->len = req->iov_cnt;
+        } else {
+            sqe->addr = reinterpret_cast<unsigned long>(&req->iov);
+            sqe->len = 1;
+        }
+    }
+    sqe->user_data = reinterpret_cast<unsigned long>(req);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (io_uring_enter(ring_fd_, 1, 0, 0) < 0) {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // 出错时内核没有消费任何SQE，收回刚填写的SQE，避免它被下一次提交带出
+            __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+            throw UnixError();
+        }
+    }
+    // SQE交给内核后才计入在途请求，提交失败不会占用队列空位
+    inflight_++;
+}
+
+/**
+ * @description: 重新提交发生短读写的请求中尚未完成的部分，与positional_io一样跳过已经完整读写的缓冲区；
+ *               调用者需持有sq_latch_，且该请求原来占用的队列空位还没有让给其他请求
+ * @param {IoRequest*} req 已经完成了num_done个字节的请求
+ */
+void UringIoEngine::resubmit_rest(IoRequest *req) {
+    const struct iovec *iov = req->iov_cnt > 0 ? req->iovs : &req->iov;
+    int iov_cnt = req->iov_cnt > 0 ? req->iov_cnt : 1;
+    size_t skip = req->num_done;
+    while (iov_cnt > 0 && skip >= iov->iov_len) {
+        skip -= iov->iov_len;
+        iov++;
+        iov_cnt--;
+    }
+    req->rest_iovs.assign(iov, iov + iov_cnt);
+    req->rest_iovs[0].iov_base = static_cast<char *>(req->rest_iovs[0].iov_base) + skip;
+    req->rest_iovs[0].iov_len -= skip;
+    push_sqe(req, req->is_write ? IORING_OP_WRITEV : IORING_OP_READV);
+}
+
+/**
+ * @description: 完成线程，等待并处理完成队列中的CQE，直到收到退出用的NOP；
+ *               短读写的请求重新提交剩余部分，直到全部完成、出错或读到文件末尾
+ */
+void UringIoEngine::reap() {
+    bool stop = false;
+    auto backoff = std::chrono::microseconds(100);
+    while (!stop) {
+        if (io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            // 持续出错时退避重试，避免完成线程空转占满CPU；已提交的请求仍在内核中，不能直接丢弃
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, std::chrono::microseconds(100000));
+        } else {
+            backoff = std::chrono::microseconds(100);
+        }
+        unsigned head = *cq_head_;  // 只有完成线程会修改head
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            continue;
+        }
+        std::vector<std::pair<IoRequest *, int>> completions;
+        std::vector<IoRequest *> partials;
+        unsigned num_reaped = tail - head;
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+            auto req = reinterpret_cast<IoRequest *>(cqe->user_data);
+            if (req != nullptr && cqe->res > 0 && req->num_done + cqe->res < req->num_bytes) {
+                req->num_done += cqe->res;
+                partials.push_back(req);
+            } else if (req != nullptr && cqe->res >= 0) {
+                completions.emplace_back(req, req->num_done + cqe->res);
+            } else {
+                completions.emplace_back(req, cqe->res);
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        // 先归还队列空位再执行完成回调，回调中可以继续提交新的请求；
+        // 短读写的请求在同一临界区内重新提交，直接沿用刚归还的空位，不会等待
+        {
+            std::scoped_lock lock{sq_latch_};
+            inflight_ -= num_reaped;
+            for (auto req : partials) {
+                try {
+                    resubmit_rest(req);
+                } catch (UnixError &e) {
+                    completions.emplace_back(req, -EIO);
+                }
+            }
+        }
+        sq_cv_.notify_all();
+        for (auto &completion : completions) {
+            if (completion.first == nullptr) {
+                stop = true;
+            } else {
+                complete(completion.first, completion.second);
+            }
+        }
+    }
+}
@@ -0,0 +1,173 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 一次异步I/O请求，由调用者分配并保证在完成之前一直有效
+ */
+struct IoRequest {
+    int fd = -1;                // 文件句柄
+    off_t offset = 0;           // 读写位置在文件中的偏移量
+    char *buf = nullptr;        // 读写缓冲区
+    int num_bytes = 0;          // 读写的数据量大小
+    bool is_write = false;      // true表示写请求，false表示读请求
+    // 向量化请求：iov_cnt>0时按iovs描述的多个缓冲区读写文件中从offset开始的连续区域，num_bytes为总字节数
+    struct iovec *iovs = nullptr;
+    int iov_cnt = 0;
+    // 完成回调，在I/O引擎的完成线程中执行；设置了回调的请求不能再被wait()
+    std::function<void(IoRequest *)> callback;
+
+    int result = 0;             // 实际读写的字节数，小于0时为-errno
+    bool done = false;          // 请求是否已经完成，由IoEngine::done_latch_保护
+    struct iovec iov {};        // 非向量化请求在io_uring的READV/WRITEV中使用，调用者无需设置
+    // io_uring发生短读写时已经完成的字节数，以及重新提交剩余部分使用的iovec，调用者无需设置
+    int num_done = 0;
+    std::vector<struct iovec> rest_iovs;
+};
+
+/**
+ * @description: 用preadv/pwritev在指定偏移量处完整地读写iov描述的全部缓冲区，处理短读写、EINTR和IOV_MAX限制
+ * @return {ssize_t} 实际读写的字节数，只有读到文件末尾时才会小于请求的字节数；出错时返回-errno
+ * @param {int} fd 文件句柄
+ * @param {const iovec*} iov 缓冲区数组
+ * @param {int} iov_cnt 缓冲区个数
+ * @param {off_t} offset 读写位置在文件中的偏移量
+ * @param {bool} is_write true表示写，false表示读
+ */
+ssize_t positional_io(int fd, const struct iovec *iov, int iov_cnt, off_t offset, bool is_write);
+
+/**
+ * @description: 异步I/O引擎，提供提交/完成两段式的页面读写接口，使多个I/O请求可以同时在途
+ */
+class IoEngine {
+   public:
+    IoEngine() = default;
+
+    virtual ~IoEngine() = default;
+
+    /**
+     * @description: 提交一个I/O请求，不等待其完成
+     * @param {IoRequest*} req 要提交的请求
+     */
+    virtual void submit(IoRequest *req) = 0;
+
+    /** @return 引擎的名称，用于日志和测试 */
+    virtual std::string name() const = 0;
+
+    void submit_batch(const std::vector<IoRequest *> &reqs) {
+        for (auto req : reqs) {
+            submit(req);
+        }
+    }
+
+    void wait(IoRequest *req);
+
+    void wait_all(const std::vector<IoRequest *> &reqs) {
+        for (auto req : reqs) {
+            wait(req);
+        }
+    }
+
+    static std::unique_ptr<IoEngine> create(const std::string &type, int queue_depth, int num_threads);
+
+    void complete(IoRequest *req, int result);
+
+   protected:
+    std::mutex done_latch_;             // 保护IoRequest::done
+    std::condition_variable done_cv_;   // 有请求完成时唤醒等待者
+};
+
+/**
+ * @description: 基于线程池和pread/pwrite的I/O引擎，在io_uring不可用时使用
+ */
+class ThreadPoolIoEngine : public IoEngine {
+   public:
+    explicit ThreadPoolIoEngine(int num_threads);
+
+    ~ThreadPoolIoEngine();
+
+    void submit(IoRequest *req) override;
+
+    std::string name() const override { return "THREAD_POOL"; }
+
+   private:
+    void worker();
+
+    std::mutex latch_;                  // 保护queue_和stop_
+    std::condition_variable cv_;
+    std::deque<IoRequest *> queue_;     // 等待执行的请求
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+};
+
+/**
+ * @description: 基于io_uring的I/O引擎，直接使用io_uring_setup/io_uring_enter系统调用，不依赖liburing
+ */
+class UringIoEngine : public IoEngine {
+   public:
+    /**
+     * @description: 创建io_uring实例，内核不支持时抛出UnixError
+     * @param {int} queue_depth 提交队列的长度，即同时在途的最大请求数
+     */
+    explicit UringIoEngine(int queue_depth);
+
+    ~UringIoEngine();
+
+    void submit(IoRequest *req) override;
+
+    std::string name() const override { return "URING"; }
+
+   private:
+    void push_sqe(IoRequest *req, unsigned char opcode);
+
+    void resubmit_rest(IoRequest *req);
+
+    void reap();
+
+    int ring_fd_ = -1;
+    unsigned entries_ = 0;              // 提交队列长度
+    unsigned inflight_ = 0;             // 已提交未完成的请求数，由sq_latch_保护
+
+    // 提交队列(SQ)，生产者为submit()
+    void *sq_ptr_ = nullptr;
+    size_t sq_len_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    struct io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_len_ = 0;
+
+    // 完成队列(CQ)，消费者为完成线程reaper_
+    void *cq_ptr_ = nullptr;
+    size_t cq_len_ = 0;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    struct io_uring_cqe *cqes_ = nullptr;
+
+    std::mutex sq_latch_;               // 串行化提交，并保护inflight_
+    std::condition_variable sq_cv_;     // 提交队列有空位时唤醒提交者
+    std::thread reaper_;                // 完成线程
+};
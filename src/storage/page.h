@@ -10,7 +10,10 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <cstring>
+
 #include "common/config.h"
+#include "page_latch.h"
 
 /**
  * @description: 存储层每个Page的id的声明
@@ -34,9 +37,11 @@ struct PageId {
     }
 };
 
-// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+// PageId的自定义哈希算法, 用于构建unordered_set<PageId, PageIdHash>等；fd和page_no各占32位，页号超过2^16时也不会冲突
 struct PageIdHash {
-    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+    size_t operator()(const PageId &x) const {
+        return (static_cast<size_t>(static_cast<uint32_t>(x.fd)) << 32) | static_cast<uint32_t>(x.page_no);
+    }
 };
 
 template <>
@@ -47,13 +52,18 @@ struct std::hash<PageId> {
 /**
  * @description: Page类声明, Page是RMDB数据块的单位、是负责数据操作Record模块的操作对象，
  * Page对象在磁盘上有文件存储, 若在Buffer中则有帧偏移, 并非特指Buffer或Disk上的数据
+ * Page对象只保存帧的元数据，页面数据在FrameArena中另外分配；按32字节对齐，每个对象不会跨越缓存行
  */
-class Page {
+class alignas(32) Page {
     friend class BufferPoolManager;
+    friend class BufferPoolInstance;
+    friend class BasicPageGuard;
+    friend class ReadPageGuard;
+    friend class WritePageGuard;
 
    public:
     
-    Page() { reset_memory(); }
+    Page() = default;
 
     ~Page() = default;
 
@@ -78,13 +88,24 @@ class Page {
     PageId id_;
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool中的偏移地址，指向缓冲池实例的FrameArena中的一帧
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
 
     /** 脏页判断 */
     bool is_dirty_ = false;
 
     /** The pin count of this page. */
     int pin_count_ = 0;
-};
\ No newline at end of file
+
+    /** 帧上正在进行磁盘I/O（读入新页面或写回被淘汰的脏页），完成前其他线程不能使用该帧 */
+    bool io_pending_ = false;
+
+    /** 页面被固定着写回磁盘（flush_page、flush_all_pages或检查点），期间页面照常可以访问，同一页面的另一次写回要等待本次完成 */
+    bool write_pending_ = false;
+
+    /** 保护页面数据的读写latch，通过ReadPageGuard/WritePageGuard获取，持有期间页面一直被固定 */
+    PageLatch latch_;
+};
+
+static_assert(sizeof(Page) == 32, "Page metadata should stay within half a cache line");
@@ -0,0 +1,183 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/page_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr int MIN_MATCH = 4;            // 最短匹配长度
+constexpr int MAX_OFFSET = 65535;       // 匹配偏移量用2个字节表示
+constexpr int HASH_BITS = 12;           // 哈希表大小为2^HASH_BITS，页面大小的数据足够
+constexpr int RUN_MASK = 15;            // token中长度字段的最大值，表示后面跟着扩展长度
+
+inline uint32_t read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash32(uint32_t value) { return (value * 2654435761u) >> (32 - HASH_BITS); }
+
+/**
+ * @description: 写入长度字段超出token部分的扩展字节
+ * @return {bool} dst空间不足时返回false
+ */
+inline bool write_length(uint8_t *&op, const uint8_t *op_end, int length) {
+    for (; length >= 255; length -= 255) {
+        if (op >= op_end) {
+            return false;
+        }
+        *op++ = 255;
+    }
+    if (op >= op_end) {
+        return false;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+/**
+ * @description: 读取扩展字节，累加到length上
+ * @return {bool} 输入越界时返回false
+ */
+inline bool read_length(const uint8_t *&ip, const uint8_t *ip_end, int &length) {
+    uint8_t byte;
+    do {
+        if (ip >= ip_end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/**
+ * @description: 输出一个序列：token、字面量，以及match_len>0时的匹配部分
+ * @return {bool} dst空间不足时返回false
+ */
+bool emit_sequence(uint8_t *&op, const uint8_t *op_end, const uint8_t *literals, int literal_len, int offset,
+                   int match_len) {
+    if (op >= op_end) {
+        return false;
+    }
+    uint8_t *token = op++;
+    int match_code = match_len > 0 ? match_len - MIN_MATCH : 0;
+    *token = static_cast<uint8_t>((std::min(literal_len, RUN_MASK) << 4) | std::min(match_code, RUN_MASK));
+    if (literal_len >= RUN_MASK && !write_length(op, op_end, literal_len - RUN_MASK)) {
+        return false;
+    }
+    if (op_end - op < literal_len) {
+        return false;
+    }
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+    if (match_len == 0) {
+        return true;
+    }
+    if (op_end - op < 2) {
+        return false;
+    }
+    *op++ = static_cast<uint8_t>(offset & 0xff);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    if (match_code >= RUN_MASK && !write_length(op, op_end, match_code - RUN_MASK)) {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int lz_compress(const char *src, int src_len, char *dst, int dst_capacity) {
+    const auto *base = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *ip = base;
+    const uint8_t *anchor = base;
+    const uint8_t *ip_end = base + src_len;
+    auto *op = reinterpret_cast<uint8_t *>(dst);
+    const uint8_t *op_end = op + dst_capacity;
+
+    int32_t table[1 << HASH_BITS];
+    memset(table, -1, sizeof(table));
+    while (ip_end - ip >= MIN_MATCH) {
+        uint32_t sequence = read32(ip);
+        uint32_t h = hash32(sequence);
+        int32_t candidate = table[h];
+        table[h] = static_cast<int32_t>(ip - base);
+        if (candidate < 0 || ip - (base + candidate) > MAX_OFFSET || read32(base + candidate) != sequence) {
+            ip++;
+            continue;
+        }
+        const uint8_t *match = base + candidate;
+        int match_len = MIN_MATCH;
+        while (ip + match_len < ip_end && match[match_len] == ip[match_len]) {
+            match_len++;
+        }
+        if (!emit_sequence(op, op_end, anchor, static_cast<int>(ip - anchor), static_cast<int>(ip - match),
+                           match_len)) {
+            return -1;
+        }
+        ip += match_len;
+        anchor = ip;
+    }
+    if (!emit_sequence(op, op_end, anchor, static_cast<int>(ip_end - anchor), 0, 0)) {
+        return -1;
+    }
+    int compressed_len = static_cast<int>(op - reinterpret_cast<uint8_t *>(dst));
+    return compressed_len < dst_capacity ? compressed_len : -1;
+}
+
+int lz_decompress(const char *src, int src_len, char *dst, int dst_capacity) {
+    const auto *ip = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *ip_end = ip + src_len;
+    auto *base = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *op = base;
+    const uint8_t *op_end = base + dst_capacity;
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+        int literal_len = token >> 4;
+        if (literal_len == RUN_MASK && !read_length(ip, ip_end, literal_len)) {
+            return -1;
+        }
+        if (ip_end - ip < literal_len || op_end - op < literal_len) {
+            return -1;
+        }
+        memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == ip_end) {
+            break;  // 最后一个序列只有字面量
+        }
+        if (ip_end - ip < 2) {
+            return -1;
+        }
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        int match_len = token & RUN_MASK;
+        if (match_len == RUN_MASK && !read_length(ip, ip_end, match_len)) {
+            return -1;
+        }
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > op - base || op_end - op < match_len) {
+            return -1;
+        }
+        // 偏移量可能小于匹配长度（如连续的0），需要逐字节复制
+        const uint8_t *match = op - offset;
+        for (int i = 0; i < match_len; i++) {
+            op[i] = match[i];
+        }
+        op += match_len;
+    }
+    return static_cast<int>(op - base);
+}
@@ -0,0 +1,39 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+/**
+ * 内置的LZ77类快速压缩算法，编码方式与LZ4的块格式类似，不依赖外部压缩库
+ * 压缩数据由若干序列组成，每个序列为:
+ * | token(1B) | 字面量长度扩展(0~nB) | 字面量 | 匹配偏移量(2B) | 匹配长度扩展(0~nB) |
+ * token的高4位为字面量长度，低4位为匹配长度减4，取值15时后面跟着若干字节的扩展长度（每字节累加，直到某字节不为255）；
+ * 最后一个序列只有字面量，没有匹配部分
+ */
+
+/**
+ * @description: 压缩一段数据
+ * @return {int} 压缩后的长度，若压缩后不小于dst_capacity则返回-1
+ * @param {char*} src 原始数据
+ * @param {int} src_len 原始数据长度
+ * @param {char*} dst 存放压缩数据的缓冲区
+ * @param {int} dst_capacity dst的大小
+ */
+int lz_compress(const char *src, int src_len, char *dst, int dst_capacity);
+
+/**
+ * @description: 解压一段数据，会检查输入是否越界，损坏的输入不会导致越界访问
+ * @return {int} 解压后的长度，输入不合法或解压后超过dst_capacity时返回-1
+ * @param {char*} src 压缩数据
+ * @param {int} src_len 压缩数据长度
+ * @param {char*} dst 存放解压数据的缓冲区
+ * @param {int} dst_capacity dst的大小
+ */
+int lz_decompress(const char *src, int src_len, char *dst, int dst_capacity);
@@ -0,0 +1,96 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_guard.h"
+
+#include "buffer_pool_manager.h"
+
+BasicPageGuard &BasicPageGuard::operator=(BasicPageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        bpm_ = that.bpm_;
+        page_ = that.page_;
+        is_dirty_ = that.is_dirty_;
+        that.page_ = nullptr;
+        that.is_dirty_ = false;
+    }
+    return *this;
+}
+
+/**
+ * @description: 取消固定，修改过的页面标记为脏页，之后guard变为无效；对无效的guard不做任何事
+ */
+void BasicPageGuard::drop() {
+    if (page_ == nullptr) {
+        return;
+    }
+    bpm_->unpin_page(page_->get_page_id(), is_dirty_);
+    page_ = nullptr;
+    is_dirty_ = false;
+}
+
+/**
+ * @description: 获取页面的读latch，固定转移给返回的ReadPageGuard，本guard变为无效；对无效的guard返回无效的guard
+ */
+ReadPageGuard BasicPageGuard::upgrade_read() {
+    if (page_ != nullptr) {
+        page_->latch_.lock_shared();
+    }
+    return ReadPageGuard(std::move(*this));
+}
+
+/**
+ * @description: 获取页面的写latch，固定转移给返回的WritePageGuard，本guard变为无效；对无效的guard返回无效的guard
+ */
+WritePageGuard BasicPageGuard::upgrade_write() {
+    if (page_ != nullptr) {
+        page_->latch_.lock();
+    }
+    return WritePageGuard(std::move(*this));
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        guard_ = std::move(that.guard_);
+    }
+    return *this;
+}
+
+/**
+ * @description: 释放读latch并取消固定，之后guard变为无效；对无效的guard不做任何事
+ * 必须先释放latch：取消固定后帧可能立即被淘汰并装入其他页面
+ */
+void ReadPageGuard::drop() {
+    if (guard_.page_ == nullptr) {
+        return;
+    }
+    guard_.page_->latch_.unlock_shared();
+    guard_.drop();
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        guard_ = std::move(that.guard_);
+    }
+    return *this;
+}
+
+/**
+ * @description: 释放写latch并取消固定，修改过的页面标记为脏页，之后guard变为无效；对无效的guard不做任何事
+ */
+void WritePageGuard::drop() {
+    if (guard_.page_ == nullptr) {
+        return;
+    }
+    guard_.page_->latch_.unlock();
+    guard_.drop();
+}
@@ -0,0 +1,141 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <utility>
+
+#include "page.h"
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * @description: 持有页面的一次固定，析构（或调用drop()）时取消固定，修改过的页面标记为脏页；只能移动，不能复制
+ * 由BufferPoolManager::fetch_page_basic()/new_page_guarded()创建，缓冲池没有可用的帧时返回无效的guard
+ * 不持有latch，页面数据的并发访问由调用者控制；需要latch时用upgrade_read()/upgrade_write()转换
+ */
+class BasicPageGuard {
+    friend class ReadPageGuard;
+    friend class WritePageGuard;
+
+   public:
+    BasicPageGuard() = default;
+
+    BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    BasicPageGuard(const BasicPageGuard &) = delete;
+
+    BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+    BasicPageGuard(BasicPageGuard &&that) noexcept : bpm_(that.bpm_), page_(that.page_), is_dirty_(that.is_dirty_) {
+        that.page_ = nullptr;
+        that.is_dirty_ = false;
+    }
+
+    BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+    ~BasicPageGuard() { drop(); }
+
+    void drop();
+
+    ReadPageGuard upgrade_read();
+
+    WritePageGuard upgrade_write();
+
+    bool is_valid() const { return page_ != nullptr; }
+
+    explicit operator bool() const { return page_ != nullptr; }
+
+    PageId get_page_id() const { return page_->get_page_id(); }
+
+    // 通过返回的Page修改页面后需调用mark_dirty()
+    Page *get_page() const { return page_; }
+
+    const char *get_data() const { return page_->get_data(); }
+
+    char *get_data_mut() {
+        is_dirty_ = true;
+        return page_->get_data();
+    }
+
+    void mark_dirty() { is_dirty_ = true; }
+
+   private:
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;
+    bool is_dirty_ = false;     // 是否修改过页面，取消固定时据此标记脏页
+};
+
+/**
+ * @description: 持有页面的读latch和一次固定，析构（或调用drop()）时先释放latch再取消固定；只能移动，不能复制
+ * 由BufferPoolManager::fetch_page_read()创建，缓冲池没有可用的帧时返回无效的guard
+ */
+class ReadPageGuard {
+   public:
+    ReadPageGuard() = default;
+
+    // guard对应的页面已经加了读latch
+    explicit ReadPageGuard(BasicPageGuard &&guard) : guard_(std::move(guard)) {}
+
+    ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+    ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+    ~ReadPageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return guard_.is_valid(); }
+
+    explicit operator bool() const { return guard_.is_valid(); }
+
+    PageId get_page_id() const { return guard_.get_page_id(); }
+
+    const char *get_data() const { return guard_.get_data(); }
+
+   private:
+    BasicPageGuard guard_;
+};
+
+/**
+ * @description: 持有页面的写latch和一次固定，通过get_data_mut()取得可写的数据时页面被标记为脏页，
+ * 析构（或调用drop()）时先释放latch再取消固定；只能移动，不能复制
+ * 由BufferPoolManager::fetch_page_write()创建，缓冲池没有可用的帧时返回无效的guard
+ */
+class WritePageGuard {
+   public:
+    WritePageGuard() = default;
+
+    // guard对应的页面已经加了写latch
+    explicit WritePageGuard(BasicPageGuard &&guard) : guard_(std::move(guard)) {}
+
+    WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+    WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+    ~WritePageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return guard_.is_valid(); }
+
+    explicit operator bool() const { return guard_.is_valid(); }
+
+    PageId get_page_id() const { return guard_.get_page_id(); }
+
+    const char *get_data() const { return guard_.get_data(); }
+
+    char *get_data_mut() { return guard_.get_data_mut(); }
+
+   private:
+    BasicPageGuard guard_;
+};
@@ -0,0 +1,100 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_latch.h"
+
+#include <climits>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @description: 读latch的慢路径：写者持有latch时先自旋，超过自旋次数后设置等待位并挂起，直到写者释放
+ */
+void PageLatch::lock_shared_slow() {
+    for (int spin = 0;; spin++) {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        if ((state & WRITER) == 0) {
+            if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+        if (spin < PAGE_LATCH_SPIN_COUNT) {
+            cpu_relax();
+            continue;
+        }
+        // 设置等待位之后挂起；状态在挂起前被修改时futex_wait立即返回，不会错过唤醒
+        if ((state & WAITERS) == 0 &&
+            !state_.compare_exchange_weak(state, state | WAITERS, std::memory_order_relaxed)) {
+            continue;
+        }
+        futex_wait(state | WAITERS);
+    }
+}
+
+/**
+ * @description: 写latch的慢路径：有读者或写者持有latch时先自旋，超过自旋次数后设置等待位并挂起
+ * 获取时保留等待位，释放时由unlock()唤醒其他等待者
+ */
+void PageLatch::lock_slow() {
+    for (int spin = 0;; spin++) {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        if ((state & (WRITER | READERS)) == 0) {
+            if (state_.compare_exchange_weak(state, state | WRITER, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+        if (spin < PAGE_LATCH_SPIN_COUNT) {
+            cpu_relax();
+            continue;
+        }
+        if ((state & WAITERS) == 0 &&
+            !state_.compare_exchange_weak(state, state | WAITERS, std::memory_order_relaxed)) {
+            continue;
+        }
+        futex_wait(state | WAITERS);
+    }
+}
+
+/**
+ * @description: 在state_仍等于expected时挂起当前线程；不支持futex的平台上让出CPU
+ */
+void PageLatch::futex_wait(uint32_t expected) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    (void)expected;
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * @description: 唤醒所有挂起在本latch上的线程，由它们重新竞争
+ */
+void PageLatch::futex_wake() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
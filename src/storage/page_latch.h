@@ -0,0 +1,101 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * @description: 每个帧上的读写latch，只占一个32位原子字：最高位为写者位，次高位表示有线程在等待，低30位为读者个数
+ * 无竞争时加锁和解锁都是一次原子操作；获取失败时先自旋PAGE_LATCH_SPIN_COUNT次，仍然失败再用futex挂起线程，
+ * 释放时只有等待位被设置才需要系统调用唤醒
+ */
+class PageLatch {
+   public:
+    PageLatch() = default;
+
+    PageLatch(const PageLatch &) = delete;
+
+    PageLatch &operator=(const PageLatch &) = delete;
+
+    void lock_shared() {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        if ((state & WRITER) != 0 ||
+            !state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            lock_shared_slow();
+        }
+    }
+
+    bool try_lock_shared() {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        while ((state & WRITER) == 0) {
+            if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void unlock_shared() {
+        uint32_t state = state_.fetch_sub(1, std::memory_order_release);
+        // 最后一个读者离开时唤醒等待的写者
+        if ((state & READERS) == 1 && (state & WAITERS) != 0) {
+            state_.fetch_and(~WAITERS, std::memory_order_relaxed);
+            futex_wake();
+        }
+    }
+
+    void lock() {
+        uint32_t state = 0;
+        if (!state_.compare_exchange_weak(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed)) {
+            lock_slow();
+        }
+    }
+
+    bool try_lock() {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        while ((state & (WRITER | READERS)) == 0) {
+            if (state_.compare_exchange_weak(state, state | WRITER, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void unlock() {
+        uint32_t state = state_.fetch_and(~(WRITER | WAITERS), std::memory_order_release);
+        if ((state & WAITERS) != 0) {
+            futex_wake();
+        }
+    }
+
+    bool is_locked() const { return (state_.load(std::memory_order_relaxed) & WRITER) != 0; }
+
+    uint32_t get_num_readers() const { return state_.load(std::memory_order_relaxed) & READERS; }
+
+   private:
+    static constexpr uint32_t WRITER = 1u << 31;
+    static constexpr uint32_t WAITERS = 1u << 30;
+    static constexpr uint32_t READERS = WAITERS - 1;
+
+    void lock_shared_slow();
+
+    void lock_slow();
+
+    void futex_wait(uint32_t expected);
+
+    void futex_wake();
+
+    std::atomic<uint32_t> state_{0};
+};
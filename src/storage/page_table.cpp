@@ -0,0 +1,138 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "page_table.h"
+
+#include <thread>
+
+PageTable::PageTable(size_t num_frames) {
+    size_t capacity = 16;
+    while (capacity < 2 * num_frames) {
+        capacity <<= 1;
+    }
+    slots_ = std::make_unique<Slot[]>(capacity);
+    mask_ = capacity - 1;
+}
+
+/**
+ * @description: 从key的初始槽位开始线性探测，遇到空槽位时停止
+ * @return {bool} 是否找到key
+ */
+bool PageTable::probe(uint64_t key, frame_id_t *frame_id) const {
+    for (size_t i = hash(key) & mask_, n = 0; n <= mask_; i = (i + 1) & mask_, n++) {
+        uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+        if (slot_key == key) {
+            *frame_id = slots_[i].frame_id.load(std::memory_order_relaxed);
+            return true;
+        }
+        if (slot_key == EMPTY_KEY) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 查找页面所在的帧，调用者需持有串行化修改的latch
+ * @return {bool} 页面是否在页表中
+ * @param {PageId} page_id 目标页面
+ * @param {frame_id_t*} frame_id 返回页面所在的帧
+ */
+bool PageTable::find(PageId page_id, frame_id_t *frame_id) const { return probe(pack(page_id), frame_id); }
+
+/**
+ * @description: 不加锁地查找页面所在的帧：读取前后顺序锁的值相同且为偶数时结果有效，否则说明与修改并发，重新读取
+ * @return {bool} 读取的瞬间页面是否在页表中；返回之后映射可能已经改变，调用者需要在latch_下确认
+ * @param {PageId} page_id 目标页面
+ * @param {frame_id_t*} frame_id 返回页面所在的帧
+ */
+bool PageTable::find_optimistic(PageId page_id, frame_id_t *frame_id) const {
+    uint64_t key = pack(page_id);
+    while (true) {
+        uint64_t seq = seq_.load(std::memory_order_acquire);
+        if ((seq & 1) != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        frame_id_t result = INVALID_FRAME_ID;
+        bool found = probe(key, &result);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == seq) {
+            *frame_id = result;
+            return found;
+        }
+    }
+}
+
+/**
+ * @description: 插入或更新页面到帧的映射，调用者需持有串行化修改的latch
+ */
+void PageTable::insert(PageId page_id, frame_id_t frame_id) {
+    uint64_t key = pack(page_id);
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    size_t i = hash(key) & mask_;
+    while (true) {
+        uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+        if (slot_key == key) {
+            break;
+        }
+        if (slot_key == EMPTY_KEY) {
+            slots_[i].key.store(key, std::memory_order_relaxed);
+            size_++;
+            break;
+        }
+        i = (i + 1) & mask_;
+    }
+    slots_[i].frame_id.store(frame_id, std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+/**
+ * @description: 删除页面的映射，之后的槽位向前移动填补空位（不使用墓碑），调用者需持有串行化修改的latch
+ * @return {bool} 页面是否在页表中
+ */
+bool PageTable::erase(PageId page_id) {
+    uint64_t key = pack(page_id);
+    size_t i = hash(key) & mask_;
+    while (true) {
+        uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+        if (slot_key == EMPTY_KEY) {
+            return false;
+        }
+        if (slot_key == key) {
+            break;
+        }
+        i = (i + 1) & mask_;
+    }
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // 空位i之后的槽位j中的键，如果其初始槽位不在(i, j]之间，探测时会经过i，需要移到i
+    for (size_t j = (i + 1) & mask_;; j = (j + 1) & mask_) {
+        uint64_t slot_key = slots_[j].key.load(std::memory_order_relaxed);
+        if (slot_key == EMPTY_KEY) {
+            break;
+        }
+        size_t home = hash(slot_key) & mask_;
+        bool in_range = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (!in_range) {
+            slots_[i].key.store(slot_key, std::memory_order_relaxed);
+            slots_[i].frame_id.store(slots_[j].frame_id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            i = j;
+        }
+    }
+    slots_[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+    slots_[i].frame_id.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+    size_--;
+    seq_.store(seq + 2, std::memory_order_release);
+    return true;
+}
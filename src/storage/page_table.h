@@ -0,0 +1,73 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "page.h"
+
+/**
+ * @description: 缓冲池实例的页表，把PageId映射到帧号；容量固定为不小于帧数两倍的2的幂，使用线性探测的开放寻址，
+ * 查找只访问连续的几个槽位，插入不分配内存
+ * 修改由调用者串行化（BufferPoolInstance::latch_）；find_optimistic()可以在不持有latch_时调用，
+ * 通过顺序锁seq_检测与修改并发的读取并重试，返回的结果只在读取的瞬间有效
+ */
+class PageTable {
+   public:
+    /**
+     * @param {size_t} num_frames 实例的帧数，即页表中最多同时存在的映射个数
+     */
+    explicit PageTable(size_t num_frames);
+
+    bool find(PageId page_id, frame_id_t *frame_id) const;
+
+    bool find_optimistic(PageId page_id, frame_id_t *frame_id) const;
+
+    void insert(PageId page_id, frame_id_t frame_id);
+
+    bool erase(PageId page_id);
+
+    size_t size() const { return size_; }
+
+    size_t capacity() const { return mask_ + 1; }
+
+   private:
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;   // fd和page_no都为-1，不是合法的页面
+
+    static uint64_t pack(PageId page_id) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id.fd)) << 32) |
+               static_cast<uint32_t>(page_id.page_no);
+    }
+
+    // fmix64（MurmurHash3的终结函数），页号连续的页面被打散到不相邻的槽位
+    static size_t hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    bool probe(uint64_t key, frame_id_t *frame_id) const;
+
+    struct Slot {
+        std::atomic<uint64_t> key{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_id{INVALID_FRAME_ID};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;                       // 容量减一
+    size_t size_ = 0;                   // 映射个数，由调用者的latch_保护
+    std::atomic<uint64_t> seq_{0};      // 顺序锁，修改期间为奇数
+};
@@ -91,12 +91,19 @@ void SmManager::open_db(const std::string& db_name) {
     if (chdir(db_name.c_str()) < 0) {
         throw UnixError();
     }
+    // 先用双写文件中的页面副本修复上次崩溃时写坏的页面，再打开数据文件
+    if (ENABLE_DOUBLE_WRITE && buffer_pool_manager_->is_checksum_enabled()) {
+        buffer_pool_manager_->open_double_write(DOUBLE_WRITE_FILE_NAME);
+    }
+    if (ENABLE_BACKGROUND_WRITER) {
+        buffer_pool_manager_->start_background_writer(BACKGROUND_WRITER_FREE_FRAMES, BACKGROUND_WRITER_INTERVAL_MS);
+    }
     std::ifstream ifs(DB_META_NAME);
     ifs >> db_;
     ifs.close();
     // 打开所有的文件
     for (auto &entry : db_.tabs_) {
-        fhs_.emplace(entry.first, rm_manager_->open_file(entry.first));
+        fhs_.emplace(entry.first, rm_manager_->open_file(entry.first, OPEN_TABLES_READ_ONLY));
     }
     // 打开所有的索引
     for (auto &entry : db_.tabs_) {
@@ -105,6 +112,10 @@ void SmManager::open_db(const std::string& db_name) {
             drop_index(entry.first, index.cols, nullptr);
         }
     }
+    // 所有文件打开之后，在后台读入上次关闭时缓冲池中的页面
+    if (ENABLE_BUFFER_POOL_WARMUP) {
+        buffer_pool_manager_->start_warmup(WARMUP_FILE_NAME);
+    }
 }
 
 /**
@@ -120,6 +131,15 @@ void SmManager::flush_meta() {
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
+    // 先停止后台写线程，之后关闭文件时不会再有进行中的写回
+    buffer_pool_manager_->stop_background_writer();
+    // 在关闭文件之前转储缓冲池中的页面，下次打开时预热
+    buffer_pool_manager_->stop_warmup();
+    if (ENABLE_BUFFER_POOL_WARMUP) {
+        buffer_pool_manager_->dump_resident_pages(WARMUP_FILE_NAME);
+    }
+    // 关闭数据库时不必限速：所有文件的脏页统一按页号排序合并写回，之后关闭各文件时已没有脏页
+    buffer_pool_manager_->checkpoint(0);
     std::ofstream ofs(DB_META_NAME);
     ofs << db_;
     db_.name_.clear();
@@ -132,6 +152,7 @@ void SmManager::close_db() {
 		ix_manager_->close_index(entry.second.get());
 	}
 	ihs_.clear();
+    buffer_pool_manager_->close_double_write();
 	if(chdir("..") < 0){
 		throw UnixError();
 	}
@@ -159,6 +180,29 @@ void SmManager::show_tables(Context* context) {
     outfile.close();
 }
 
+/**
+ * @description: 修改运行时的系统参数并输出修改后的值，目前支持buffer_pool_size：在线调整缓冲池的帧数，
+ * 不超过BUFFER_POOL_MAX_SIZE；收缩时帧中有页面一直被固定则停在能达到的大小
+ * @param {string&} name 参数名
+ * @param {int} value 参数的新值
+ * @param {Context*} context
+ */
+void SmManager::set_variable(const std::string& name, int value, Context* context) {
+    if (name != "buffer_pool_size") {
+        throw VariableNotFoundError(name);
+    }
+    if (value <= 0) {
+        throw InternalError("buffer_pool_size must be positive");
+    }
+    size_t pool_size = buffer_pool_manager_->resize(static_cast<size_t>(value));
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Variable", "Value"}, context);
+    printer.print_separator(context);
+    printer.print_record({name, std::to_string(pool_size)}, context);
+    printer.print_separator(context);
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -196,6 +240,7 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     int curr_offset = 0;
     TabMeta tab;
     tab.name = tab_name;
+    std::vector<RmVarCol> var_cols;
     for (auto &col_def : col_defs) {
         ColMeta col = {.tab_name = tab_name,
                        .name = col_def.name,
@@ -203,12 +248,21 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
                        .len = col_def.len,
                        .offset = curr_offset,
                        .index = false};
+        // 超出RM_MAX_VAR_COLS的VARCHAR字段在页面中按最大长度存放
+        if (col.type == TYPE_VARCHAR && var_cols.size() < RM_MAX_VAR_COLS) {
+            var_cols.push_back({.offset = col.offset, .len = col.len});
+        }
         curr_offset += col_def.len;
         tab.cols.push_back(col);
     }
     // Create & open record file
     int record_size = curr_offset;  // record_size就是col meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    // 有VARCHAR字段的表使用槽式页面格式，变长字段只存放实际长度
+    if (var_cols.empty()) {
+        rm_manager_->create_file(tab_name, record_size, COMPRESS_TABLE_FILES);
+    } else {
+        rm_manager_->create_slotted_file(tab_name, record_size, var_cols, COMPRESS_TABLE_FILES);
+    }
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
@@ -232,6 +286,8 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
         // context->lock_mgr_->lock_IX_on_table(context->txn_, fhs_[tab_name]->GetFd());
     }
     TabMeta &tab = db_.get_table(tab_name);
+    // 预热线程可能还在读该文件的页面，关闭文件之前先停止它
+    buffer_pool_manager_->stop_warmup();
     rm_manager_->close_file(fhs_.at(tab_name).get());
     rm_manager_->destroy_file(tab_name);
     for (auto &index : tab.indexes) {
@@ -293,6 +349,7 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
     }
     std::string index_name = ix_manager_->get_index_name(tab_name, col_names);
 
+    buffer_pool_manager_->stop_warmup();
     ix_manager_->close_index(ihs_.at(index_name).get());
     ix_manager_->destroy_index(tab_name, col_names);
 
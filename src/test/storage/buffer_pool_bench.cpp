@@ -0,0 +1,93 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 测量缓冲池在全部命中时的多线程吞吐量，比较不同实例个数下随线程数的扩展性
+ * 用法: buffer_pool_bench [数据页数=4096] [每个线程的操作次数=1000000] [最大线程数=8]
+ * 数据页全部装入缓冲池，随机访问阶段的fetch_page/unpin_page都是命中，吞吐量只取决于缓冲池内部的同步开销
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string BENCH_FILE_NAME = "buffer_pool_bench.dat";
+
+/**
+ * @return {double} 所有线程合计每秒完成的fetch_page+unpin_page次数
+ */
+double run_bench(BufferPoolManager *bpm, int fd, int num_pages, int ops_per_thread, int num_threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([=]() {
+            std::mt19937 rng(t);
+            std::uniform_int_distribution<int> dist(0, num_pages - 1);
+            for (int i = 0; i < ops_per_thread; i++) {
+                PageId page_id = {.fd = fd, .page_no = dist(rng)};
+                Page *page = bpm->fetch_page(page_id);
+                if (page != nullptr) {
+                    bpm->unpin_page(page_id, false);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(ops_per_thread) * num_threads / seconds;
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? std::stoi(argv[1]) : 4096;
+    int ops_per_thread = argc > 2 ? std::stoi(argv[2]) : 1000000;
+    int max_threads = argc > 3 ? std::stoi(argv[3]) : 8;
+    std::cout << "pages: " << num_pages << ", ops per thread: " << ops_per_thread
+              << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    DiskManager disk_manager;
+    if (disk_manager.is_file(BENCH_FILE_NAME)) {
+        disk_manager.destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager.create_file(BENCH_FILE_NAME);
+    int fd = disk_manager.open_file(BENCH_FILE_NAME);
+    for (size_t num_instances : {1, 8, 16}) {
+        // 缓冲池比数据页多一倍，保证分到每个实例的页面都能装下
+        BufferPoolManager bpm(2 * num_pages, &disk_manager, false, num_instances);
+        disk_manager.set_fd2pageno(fd, 0);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm.new_page(&page_id);
+            memcpy(page->get_data(), &i, sizeof(i));
+            bpm.unpin_page(page_id, true);
+        }
+        std::cout << "instances: " << num_instances;
+        double base = 0;
+        for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+            double ops = run_bench(&bpm, fd, num_pages, ops_per_thread, num_threads);
+            if (num_threads == 1) {
+                base = ops;
+            }
+            std::cout << "\t" << num_threads << " threads: " << static_cast<long>(ops) << " ops/s (x" << ops / base
+                      << ")";
+        }
+        std::cout << std::endl;
+        bpm.flush_all_pages(fd);
+    }
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    return 0;
+}
@@ -1,8 +1,12 @@
 #include "storage/buffer_pool_manager.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <fstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -427,3 +431,913 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
 
     disk_manager_->close_file(fd);
 }
+
+
+/**
+ * @brief 测试多个缓冲池实例：多线程读写分布在各实例上的页面，页面淘汰和flush_all_pages后数据保持正确
+ */
+TEST_F(BufferPoolManagerTest, ShardedInstancesTest) {
+    const std::string filename = "sharded_instances_test";
+    const int num_instances = 8;
+    const int buffer_pool_size = 64;
+    const int num_pages = 512;
+    const int num_threads = 4;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, false, num_instances);
+    EXPECT_EQ(static_cast<size_t>(num_instances), bpm->get_num_instances());
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), bpm->get_pool_size());
+    // 页面数远大于帧数，创建过程中不断有脏页被淘汰写回
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i, page_id.page_no);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    // 每个线程只修改页号与线程号同余的页面，修改次数记录在页面的第二个int中
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 2000; round++) {
+                int page_no = rand() % (num_pages / num_threads) * num_threads + t;
+                PageId page_id = {.fd = fd, .page_no = page_no};
+                Page *page = bpm->fetch_page(page_id);
+                while (page == nullptr) {
+                    page = bpm->fetch_page(page_id);
+                }
+                EXPECT_EQ(0, memcmp(page->get_data(), &page_no, sizeof(int)));
+                reinterpret_cast<int *>(page->get_data())[1]++;
+                EXPECT_TRUE(bpm->unpin_page(page_id, true));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    bpm->flush_all_pages(fd);
+    bpm.reset();
+
+    // 用单个实例的缓冲池重新读取，各页面的修改次数之和等于总修改次数
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    int total = 0;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, memcmp(page->get_data(), &i, sizeof(int)));
+        total += reinterpret_cast<int *>(page->get_data())[1];
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(num_threads * 2000, total);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试页面校验和：写回时写入页尾的校验和，读入时发现被篡改的页面
+ * @note 生成测试文件checksum_test
+ */
+TEST_F(BufferPoolManagerTest, ChecksumTest) {
+    const std::string filename = "checksum_test";
+    const size_t buffer_pool_size = 4;
+    const int num_pages = 16;
+
+    // 硬件实现与查表实现的结果必须一致，"123456789"的CRC32C为0xE3069283
+    EXPECT_EQ(0xE3069283u, crc32c("123456789", 9));
+    EXPECT_EQ(crc32c("123456789", 9), crc32c("6789", 4, crc32c("12345", 5)));
+
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true);
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    // 页面数远多于帧数，大部分页面经由淘汰写回
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memset(page->get_data(), i + 1, OFFSET_PAGE_CHECKSUM);
+        bpm->unpin_page(page_id, true);
+    }
+    bpm->flush_all_pages(fd);
+
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->read_page(fd, i, buf, PAGE_SIZE);
+        EXPECT_TRUE(verify_page_checksum(buf));
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(static_cast<char>(i + 1), page->get_data()[OFFSET_PAGE_CHECKSUM - 1]);
+        bpm->unpin_page(PageId{fd, i}, false);
+    }
+    EXPECT_GE(bpm->get_checksum_stats().num_computed, static_cast<uint64_t>(num_pages));
+    EXPECT_GT(bpm->get_checksum_stats().num_verified, 0u);
+    EXPECT_EQ(0u, bpm->get_checksum_stats().num_failed);
+
+    // 篡改磁盘上的一个页面，使其不在缓冲池中，再次读入时应当校验失败
+    disk_manager_->read_page(fd, 0, buf, PAGE_SIZE);
+    buf[100] ^= 1;
+    disk_manager_->write_page(fd, 0, buf, PAGE_SIZE);
+    for (int i = num_pages - (int)buffer_pool_size; i < num_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, i}));
+        bpm->unpin_page(PageId{fd, i}, false);
+    }
+    EXPECT_THROW(bpm->fetch_page(PageId{fd, 0}), PageChecksumError);
+    EXPECT_EQ(1u, bpm->get_checksum_stats().num_failed);
+    // 校验失败的帧被归还，缓冲池仍可以正常使用
+    ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, 1}));
+    EXPECT_EQ(static_cast<char>(2), bpm->fetch_page(PageId{fd, 1})->get_data()[0]);
+    bpm->unpin_page(PageId{fd, 1}, false);
+    bpm->unpin_page(PageId{fd, 1}, false);
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试双写缓冲区：模拟写回时崩溃导致的页面损坏，重新打开双写文件时用副本修复
+ * @note 生成测试文件double_write_test和double_write_test.dwb
+ */
+TEST_F(BufferPoolManagerTest, DoubleWriteTest) {
+    const std::string filename = "double_write_test";
+    const std::string dwb_name = filename + ".dwb";
+    const size_t buffer_pool_size = 8;
+    const int num_pages = 32;
+
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    char dwb_copy[PAGE_SIZE];
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true);
+        EXPECT_EQ(0, bpm->open_double_write(dwb_name));
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            memset(page->get_data(), i + 1, OFFSET_PAGE_CHECKSUM);
+            bpm->unpin_page(page_id, true);
+        }
+        bpm->flush_all_pages(fd);
+        // 保存此时的双写文件，模拟在页面写回原位置的过程中崩溃
+        std::ifstream ifs(dwb_name, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        std::ofstream(dwb_name + ".crash", std::ios::binary) << content;
+        bpm->close_double_write();
+    }
+    std::rename((dwb_name + ".crash").c_str(), dwb_name.c_str());
+
+    // 数据文件中的第3页只写了一半
+    const int torn_page = 3;
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, torn_page, buf, PAGE_SIZE);
+    memcpy(dwb_copy, buf, PAGE_SIZE);
+    memset(buf + PAGE_SIZE / 2, 0x5a, PAGE_SIZE / 2);
+    disk_manager_->write_page(fd, torn_page, buf, PAGE_SIZE);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true);
+    EXPECT_EQ(1, bpm->open_double_write(dwb_name));
+    Page *page = bpm->fetch_page(PageId{fd, torn_page});
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, memcmp(page->get_data(), dwb_copy, PAGE_SIZE));
+    bpm->unpin_page(PageId{fd, torn_page}, false);
+    // 修复完成后双写文件被清空，再次打开不会修复任何页面
+    bpm->close_double_write();
+    EXPECT_EQ(0, bpm->open_double_write(dwb_name));
+    bpm->close_double_write();
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 测试缓冲区访问策略：批量写入和顺序扫描只复用各自私有环中的帧，缓冲池中已有的页面不会被淘汰
+ * @note 生成测试文件strategy_hot_test和strategy_scan_test
+ */
+TEST_F(BufferPoolManagerTest, AccessStrategyTest) {
+    const std::string hot_filename = "strategy_hot_test";
+    const std::string scan_filename = "strategy_scan_test";
+    const int buffer_pool_size = 64;
+    const int num_hot_pages = 32;
+    const int num_scan_pages = 256;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    for (auto &filename : {hot_filename, scan_filename}) {
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        disk_manager->create_file(filename);
+    }
+    int hot_fd = disk_manager->open_file(hot_filename);
+    int scan_fd = disk_manager->open_file(scan_filename);
+
+    // 使用LRU替换策略，不使用访问策略时扫描一定会淘汰热点页面
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, false, 1, "LRU");
+    for (int i = 0; i < num_hot_pages; i++) {
+        PageId page_id = {.fd = hot_fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    bpm->flush_all_pages(hot_fd);
+    uint64_t hot_reads = disk_manager->get_file_io_stats(hot_fd).num_reads;
+
+    // 批量写入远多于缓冲池帧数的页面
+    auto bulk_write = bpm->create_access_strategy(BULK_WRITE);
+    for (int i = 0; i < num_scan_pages; i++) {
+        PageId page_id = {.fd = scan_fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id, bulk_write.get());
+        ASSERT_NE(nullptr, page);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    EXPECT_GT(bulk_write->get_num_reused(), 0u);
+
+    // 顺序扫描所有页面
+    auto bulk_read = bpm->create_access_strategy(BULK_READ);
+    for (int i = 0; i < num_scan_pages; i++) {
+        PageId page_id = {.fd = scan_fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id, bulk_read.get());
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, memcmp(page->get_data(), &i, sizeof(int)));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_GT(bulk_read->get_num_reused(), 0u);
+
+    // 热点页面仍然在缓冲池中，再次访问时不需要读盘
+    for (int i = 0; i < num_hot_pages; i++) {
+        PageId page_id = {.fd = hot_fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, memcmp(page->get_data(), &i, sizeof(int)));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(hot_reads, disk_manager->get_file_io_stats(hot_fd).num_reads);
+
+    // 不使用访问策略的扫描会淘汰热点页面
+    for (int i = 0; i < num_scan_pages; i++) {
+        PageId page_id = {.fd = scan_fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    for (int i = 0; i < num_hot_pages; i++) {
+        PageId page_id = {.fd = hot_fd, .page_no = i};
+        ASSERT_NE(nullptr, bpm->fetch_page(page_id));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_LT(hot_reads, disk_manager->get_file_io_stats(hot_fd).num_reads);
+
+    bpm->flush_all_pages(scan_fd);
+    bpm.reset();
+    disk_manager->close_file(hot_fd);
+    disk_manager->close_file(scan_fd);
+    disk_manager->destroy_file(hot_filename);
+    disk_manager->destroy_file(scan_filename);
+}
+
+/**
+ * @brief 测试后台写线程：提前淘汰并批量写回脏页之后，缺页不再需要在前台写回脏页，被淘汰的页面能被正确地重新读入
+ * @note 生成测试文件background_writer_test
+ */
+TEST_F(BufferPoolManagerTest, BackgroundWriterTest) {
+    const std::string filename = "background_writer_test";
+    const int buffer_pool_size = 64;
+    const int num_free_frames = 16;
+    const int num_pages = 512;
+    const int num_threads = 4;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true, 2);
+    // 填满缓冲池的脏页
+    for (int i = 0; i < buffer_pool_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    EXPECT_EQ(0u, bpm->get_writer_stats().num_foreground_writes);
+
+    // 同步执行一轮：每个实例腾出num_free_frames个空闲帧，之后的缺页直接使用这些帧
+    bpm->run_background_writer(num_free_frames);
+    EXPECT_EQ(2u * num_free_frames, bpm->get_writer_stats().num_background_writes);
+    for (int i = buffer_pool_size; i < buffer_pool_size + num_free_frames; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        if (page == nullptr) {
+            break;  // 页面在两个实例之间分布不均时，其中一个实例的空闲帧先用完
+        }
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    EXPECT_EQ(0u, bpm->get_writer_stats().num_foreground_writes);
+    int num_created = disk_manager->get_fd2pageno(fd);
+
+    // 启动后台写线程，多个线程同时修改页面，页面数远大于帧数
+    bpm->start_background_writer(num_free_frames, 1);
+    for (int i = num_created; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        while (page == nullptr) {
+            page = bpm->new_page(&page_id);
+        }
+        EXPECT_EQ(i, page_id.page_no);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 2000; round++) {
+                int page_no = rand() % (num_pages / num_threads) * num_threads + t;
+                PageId page_id = {.fd = fd, .page_no = page_no};
+                Page *page = bpm->fetch_page(page_id);
+                while (page == nullptr) {
+                    page = bpm->fetch_page(page_id);
+                }
+                EXPECT_EQ(0, memcmp(page->get_data(), &page_no, sizeof(int)));
+                reinterpret_cast<int *>(page->get_data())[1]++;
+                EXPECT_TRUE(bpm->unpin_page(page_id, true));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    bpm->stop_background_writer();
+    WriterStats stats = bpm->get_writer_stats();
+    EXPECT_GT(stats.num_background_writes, 2u * num_free_frames);
+    printf("foreground writes: %lu, background writes: %lu\n", stats.num_foreground_writes,
+           stats.num_background_writes);
+    bpm->flush_all_pages(fd);
+    bpm.reset();
+
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true);
+    int total = 0;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, memcmp(page->get_data(), &i, sizeof(int)));
+        total += reinterpret_cast<int *>(page->get_data())[1];
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(num_threads * 2000, total);
+    EXPECT_EQ(0u, bpm->get_checksum_stats().num_failed);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试页面的读写latch：guard析构时释放latch并取消固定，多个读者可以同时持有读latch，写者与读者互斥
+ * @note 生成测试文件page_guard_test
+ */
+TEST_F(BufferPoolManagerTest, PageGuardTest) {
+    const std::string filename = "page_guard_test";
+    const int num_threads = 4;
+    const int num_rounds = 10000;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(10, disk_manager);
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    ASSERT_NE(nullptr, bpm->new_page(&page_id));
+    EXPECT_TRUE(bpm->unpin_page(page_id, false));
+
+    {
+        // 同一个页面上可以同时有多个读者，guard被移动后只释放一次
+        ReadPageGuard guard1 = bpm->fetch_page_read(page_id);
+        ReadPageGuard guard2 = bpm->fetch_page_read(page_id);
+        ASSERT_TRUE(guard1.is_valid());
+        ASSERT_TRUE(guard2.is_valid());
+        ReadPageGuard guard3 = std::move(guard1);
+        EXPECT_FALSE(guard1.is_valid());
+        EXPECT_EQ(page_id, guard3.get_page_id());
+        guard2.drop();
+        EXPECT_FALSE(guard2.is_valid());
+    }
+    // 所有guard都已释放，页面不再被固定
+    EXPECT_FALSE(bpm->unpin_page(page_id, false));
+
+    {
+        WritePageGuard guard = bpm->fetch_page_write(page_id);
+        ASSERT_TRUE(guard.is_valid());
+        memset(guard.get_data_mut(), 0, 2 * sizeof(int));
+    }
+    EXPECT_FALSE(bpm->unpin_page(page_id, false));
+
+    // 写者每次同时修改两个计数器，读者在读latch下看到的两个计数器总是相等
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < num_rounds; round++) {
+                if (t % 2 == 0) {
+                    WritePageGuard guard = bpm->fetch_page_write(page_id);
+                    int *counters = reinterpret_cast<int *>(guard.get_data_mut());
+                    counters[0]++;
+                    counters[1]++;
+                } else {
+                    ReadPageGuard guard = bpm->fetch_page_read(page_id);
+                    const int *counters = reinterpret_cast<const int *>(guard.get_data());
+                    EXPECT_EQ(counters[0], counters[1]);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    {
+        ReadPageGuard guard = bpm->fetch_page_read(page_id);
+        const int *counters = reinterpret_cast<const int *>(guard.get_data());
+        EXPECT_EQ(num_threads / 2 * num_rounds, counters[0]);
+        EXPECT_EQ(num_threads / 2 * num_rounds, counters[1]);
+    }
+    EXPECT_FALSE(bpm->unpin_page(page_id, false));
+
+    // 被修改的页面在写回磁盘后仍然保留
+    bpm->flush_all_pages(fd);
+    bpm = std::make_unique<BufferPoolManager>(10, disk_manager);
+    {
+        ReadPageGuard guard = bpm->fetch_page_read(page_id);
+        EXPECT_EQ(num_threads / 2 * num_rounds, reinterpret_cast<const int *>(guard.get_data())[0]);
+    }
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 转储缓冲池中的页面，用新的缓冲池预热：最热的页面被批量读入，之后的访问全部命中
+ */
+TEST_F(BufferPoolManagerTest, WarmupTest) {
+    const std::string filename = "warmup_test";
+    const std::string dump_path = "warmup_test.warmup";
+    const int buffer_pool_size = 64;
+    const int num_pages = 256;
+    const int num_hot = 32;
+    const int first_hot = 100;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true, 2);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    // 最后访问的num_hot个页面最热，排在转储文件的最前面
+    for (int i = first_hot; i < first_hot + num_hot; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        ASSERT_NE(nullptr, bpm->fetch_page(page_id));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    bpm->flush_all_pages(fd);
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), bpm->dump_resident_pages(dump_path));
+    {
+        std::ifstream ifs(dump_path);
+        std::string name;
+        int page_no;
+        for (int i = 0; i < num_hot; i++) {
+            ASSERT_TRUE(ifs >> name >> page_no);
+            EXPECT_EQ(filename, name);
+            EXPECT_GE(page_no, first_hot);
+            EXPECT_LT(page_no, first_hot + num_hot);
+        }
+    }
+
+    // 新的缓冲池只能容纳最热的页面，它们页号连续，合并为一次读请求
+    bpm = std::make_unique<BufferPoolManager>(num_hot, disk_manager, true, 2);
+    uint64_t num_reads = disk_manager->get_file_io_stats(fd).num_reads;
+    bpm->start_warmup(dump_path);
+    for (int i = 0; i < 5000 && bpm->get_num_warmup_pages() < static_cast<size_t>(num_hot); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bpm->stop_warmup();
+    EXPECT_EQ(static_cast<size_t>(num_hot), bpm->get_num_warmup_pages());
+    EXPECT_EQ(num_reads + 1, disk_manager->get_file_io_stats(fd).num_reads);
+    for (int i = first_hot; i < first_hot + num_hot; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        EXPECT_TRUE(bpm->is_resident(page_id));
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i, *reinterpret_cast<int *>(page->get_data()));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(num_reads + 1, disk_manager->get_file_io_stats(fd).num_reads);
+
+    // 转储文件不存在时不预热
+    bpm = std::make_unique<BufferPoolManager>(num_hot, disk_manager, true, 2);
+    bpm->start_warmup("no_such_file.warmup");
+    bpm->stop_warmup();
+    EXPECT_EQ(0u, bpm->get_num_warmup_pages());
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 预读：连续的页面合并为一次异步读请求，读入后不固定；读入期间的fetch_page等待读入完成
+ */
+TEST_F(BufferPoolManagerTest, PrefetchTest) {
+    const std::string filename = "prefetch_test";
+    const int buffer_pool_size = 64;
+    const int num_pages = 128;
+    const int window = 16;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true, 2);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memcpy(page->get_data(), &i, sizeof(int));
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true, 2);
+
+    uint64_t num_reads = disk_manager->get_file_io_stats(fd).num_reads;
+    EXPECT_EQ(window, bpm->prefetch({.fd = fd, .page_no = 0}, window));
+    bpm->wait_prefetch();
+    EXPECT_EQ(num_reads + 1, disk_manager->get_file_io_stats(fd).num_reads);
+    // 已在缓冲池中的页面不再读入；预读的页面没有被固定，可以被淘汰
+    EXPECT_EQ(0, bpm->prefetch({.fd = fd, .page_no = 0}, window));
+    for (int i = 0; i < window; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        EXPECT_TRUE(bpm->is_resident(page_id));
+        EXPECT_FALSE(bpm->unpin_page(page_id, false));
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i, *reinterpret_cast<int *>(page->get_data()));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(num_reads + 1, disk_manager->get_file_io_stats(fd).num_reads);
+
+    // 中间已有页面时拆成两个请求
+    EXPECT_EQ(window - 1, bpm->prefetch({.fd = fd, .page_no = window - 1}, window));
+    bpm->wait_prefetch();
+    EXPECT_EQ(num_reads + 2, disk_manager->get_file_io_stats(fd).num_reads);
+
+    // 不等待预读完成就访问这些页面，读到的是完整的内容
+    for (int start = 2 * window; start < num_pages; start += window) {
+        bpm->prefetch({.fd = fd, .page_no = start}, window);
+        for (int i = start; i < start + window; i++) {
+            PageId page_id = {.fd = fd, .page_no = i};
+            Page *page = bpm->fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(i, *reinterpret_cast<int *>(page->get_data()));
+            EXPECT_TRUE(bpm->unpin_page(page_id, false));
+        }
+    }
+    bpm->wait_prefetch();
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 在线扩展和收缩缓冲池：扩展后可以同时固定更多的页面；收缩时被停用的帧中的脏页写回磁盘，
+ * 帧中有页面被固定时无法收缩到目标大小
+ */
+TEST_F(BufferPoolManagerTest, ResizeTest) {
+    const std::string filename = "resize_test";
+    const int buffer_pool_size = 32;
+    const int max_pool_size = 128;
+    const int num_instances = 2;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, true, num_instances, REPLACER_TYPE,
+                                                   max_pool_size);
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), bpm->get_pool_size());
+    EXPECT_EQ(static_cast<size_t>(max_pool_size), bpm->get_max_pool_size());
+    // 超过最大帧数时扩展到最大帧数
+    EXPECT_EQ(static_cast<size_t>(max_pool_size), bpm->resize(2 * max_pool_size));
+
+    // 所有帧都被固定，缓冲池已满
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < max_pool_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memcpy(page->get_data(), &i, sizeof(int));
+        page_ids.push_back(page_id);
+    }
+    PageId overflow_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    EXPECT_EQ(nullptr, bpm->new_page(&overflow_page_id));
+
+    // 页面都被固定，不能收缩
+    EXPECT_EQ(static_cast<size_t>(max_pool_size), bpm->resize(buffer_pool_size));
+    for (auto &page_id : page_ids) {
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    // 收缩后脏页已经写回磁盘，重新读入时内容不变
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), bpm->resize(buffer_pool_size));
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), bpm->get_pool_size());
+    for (int i = 0; i < max_pool_size; i++) {
+        Page *page = bpm->fetch_page(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i, *reinterpret_cast<int *>(page->get_data()));
+        EXPECT_TRUE(bpm->unpin_page(page_ids[i], false));
+    }
+    // 收缩后最多只能同时固定buffer_pool_size个页面
+    for (int i = 0; i < buffer_pool_size; i++) {
+        EXPECT_NE(nullptr, bpm->fetch_page(page_ids[i]));
+    }
+    EXPECT_EQ(nullptr, bpm->fetch_page(page_ids[buffer_pool_size]));
+    for (int i = 0; i < buffer_pool_size; i++) {
+        EXPECT_TRUE(bpm->unpin_page(page_ids[i], false));
+    }
+
+    // 收缩期间其他线程在访问页面，数据保持一致
+    std::atomic<bool> stop{false};
+    std::thread reader([&]() {
+        for (int i = 0; !stop; i = (i + 1) % max_pool_size) {
+            Page *page = bpm->fetch_page(page_ids[i]);
+            if (page != nullptr) {
+                EXPECT_EQ(i, *reinterpret_cast<int *>(page->get_data()));
+                bpm->unpin_page(page_ids[i], false);
+            }
+        }
+    });
+    for (int round = 0; round < 50; round++) {
+        bpm->resize(max_pool_size);
+        bpm->resize(num_instances + round % buffer_pool_size);
+    }
+    stop = true;
+    reader.join();
+
+    bpm->flush_all_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 缓冲池的统计信息：命中、缺页、淘汰和写回的计数，以及各文件缓存的页面数
+ */
+TEST_F(BufferPoolManagerTest, StatsTest) {
+    const std::string filename = "stats_test";
+    const int buffer_pool_size = 16;
+    const int num_pages = 32;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, false, 2);
+    BufferPoolStats stats = bpm->get_stats();
+    ASSERT_EQ(2, stats.shards.size());
+    EXPECT_EQ(stats.total.pool_size, stats.shards[0].pool_size + stats.shards[1].pool_size);
+    // 用一个实例统计淘汰的页面，页面在多个实例之间的分布不均匀时淘汰的页面数不确定
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    stats = bpm->get_stats();
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), stats.total.pool_size);
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), stats.total.num_free_frames);
+    EXPECT_EQ(0, stats.total.num_hits + stats.total.num_misses);
+    EXPECT_TRUE(stats.files.empty());
+
+    // 新建的页面超过帧数，前一半被淘汰并写回
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    stats = bpm->get_stats();
+    EXPECT_EQ(0, stats.total.num_free_frames);
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), stats.total.num_resident_pages);
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), stats.total.num_dirty_pages);
+    EXPECT_EQ(static_cast<uint64_t>(num_pages - buffer_pool_size), stats.total.num_evictions);
+    EXPECT_EQ(stats.total.num_evictions, stats.total.num_dirty_evictions);
+    EXPECT_EQ(static_cast<uint64_t>(num_pages - buffer_pool_size), stats.num_write_backs);
+    ASSERT_EQ(1, stats.files.size());
+    EXPECT_EQ(filename, stats.files[0].file_name);
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size), stats.files[0].num_resident_pages);
+
+    // 后一半页面命中，前一半页面缺页
+    for (int i = num_pages - 1; i >= 0; i--) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        ASSERT_NE(nullptr, bpm->fetch_page(page_id));
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    stats = bpm->get_stats();
+    EXPECT_EQ(static_cast<uint64_t>(num_pages - buffer_pool_size), stats.total.num_hits);
+    EXPECT_EQ(static_cast<uint64_t>(buffer_pool_size), stats.total.num_misses);
+    EXPECT_EQ(stats.total.num_hits, stats.total.hit_latency.count);
+    EXPECT_EQ(stats.total.num_misses, stats.total.miss_latency.count);
+    EXPECT_DOUBLE_EQ(0.5, stats.total.hit_ratio());
+    EXPECT_LE(stats.total.hit_latency.percentile_ns(0.5), stats.total.hit_latency.percentile_ns(0.99));
+    // 被淘汰的脏页都已写回，其余的脏页仍在缓冲池中
+    EXPECT_EQ(static_cast<uint64_t>(num_pages), stats.total.num_evictions);
+    EXPECT_EQ(stats.total.num_dirty_evictions, stats.num_write_backs);
+    EXPECT_EQ(static_cast<uint64_t>(num_pages), stats.total.num_dirty_evictions + stats.total.num_dirty_pages);
+
+    bpm->flush_all_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 帧的页面数据在按大页对齐的连续内存中分配，Page对象只保存元数据；收缩时释放的帧在再次扩展后可以正常使用
+ */
+TEST_F(BufferPoolManagerTest, FrameArenaTest) {
+    const std::string filename = "frame_arena_test";
+    const int buffer_pool_size = 16;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, false, 1, REPLACER_TYPE,
+                                                   4 * buffer_pool_size);
+    std::vector<char *> frames;
+    for (int i = 0; i < buffer_pool_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memset(page->get_data(), 'a' + i, PAGE_SIZE);
+        frames.push_back(page->get_data());
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    // 第0帧位于内存区域的开头，各帧连续排列
+    std::sort(frames.begin(), frames.end());
+    if (ENABLE_HUGE_PAGE_FRAMES) {
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frames[0]) % HUGE_PAGE_SIZE);
+    }
+    for (int i = 1; i < buffer_pool_size; i++) {
+        EXPECT_EQ(frames[i - 1] + PAGE_SIZE, frames[i]);
+    }
+
+    // 收缩和再次扩展后，被释放的帧重新使用，已写回的页面可以从磁盘读回
+    EXPECT_EQ(static_cast<size_t>(buffer_pool_size / 2), bpm->resize(buffer_pool_size / 2));
+    EXPECT_EQ(static_cast<size_t>(4 * buffer_pool_size), bpm->resize(4 * buffer_pool_size));
+    for (int i = 0; i < buffer_pool_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ('a' + i, page->get_data()[0]);
+        EXPECT_EQ('a' + i, page->get_data()[PAGE_SIZE - 1]);
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+
+    bpm->flush_all_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 脏页表和增量检查点：只写回脏页，flush_all_pages不再写回干净的页面
+ */
+TEST_F(BufferPoolManagerTest, CheckpointTest) {
+    const std::string filename = "checkpoint_test";
+    const int buffer_pool_size = 64;
+    const int num_pages = 48;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, false, 2);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        memset(page->get_data() + Page::OFFSET_PAGE_HDR, 'a' + i % 26, PAGE_SIZE - Page::OFFSET_PAGE_HDR);
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    EXPECT_EQ(static_cast<size_t>(num_pages), bpm->get_dirty_page_table().size());
+
+    // 所有脏页被写回，脏页表清空；再次检查点时没有页面需要写回
+    EXPECT_EQ(static_cast<size_t>(num_pages), bpm->checkpoint(0));
+    EXPECT_TRUE(bpm->get_dirty_page_table().empty());
+    EXPECT_EQ(0, bpm->checkpoint(0));
+    EXPECT_EQ(static_cast<uint64_t>(num_pages), bpm->get_stats().num_write_backs);
+
+    // 只修改几个页面，检查点和flush_all_pages只写回这些页面
+    for (int i = 10; i < 13; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        page->get_data()[PAGE_SIZE - 1] = 'A' + i;
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    auto dirty_pages = bpm->get_dirty_page_table();
+    ASSERT_EQ(3, dirty_pages.size());
+    EXPECT_EQ(3, bpm->checkpoint());
+    EXPECT_EQ(static_cast<uint64_t>(num_pages + 3), bpm->get_stats().num_write_backs);
+    {
+        auto guard = bpm->fetch_page_basic({.fd = fd, .page_no = 20});
+        ASSERT_TRUE(guard.is_valid());
+        guard.mark_dirty();
+    }
+    bpm->flush_all_pages(fd);
+    EXPECT_EQ(static_cast<uint64_t>(num_pages + 4), bpm->get_stats().num_write_backs);
+
+    // 写回的内容可以从磁盘读回
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, false, 2);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(i >= 10 && i < 13 ? 'A' + i : 'a' + i % 26, page->get_data()[PAGE_SIZE - 1]);
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+
+    bpm->flush_all_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+/**
+ * @brief flush_page写盘期间页面照常可以被访问和修改；同一页面的多次写回互相等待，
+ * 先复制的旧内容不会在新内容之后写入磁盘而使页面被误认为是干净的
+ */
+TEST_F(BufferPoolManagerTest, ConcurrentFlushTest) {
+    const std::string filename = "concurrent_flush_test";
+    const int num_updates = 2000;
+    const int num_flushers = 2;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(16, disk_manager);
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    ASSERT_NE(nullptr, bpm->new_page(&page_id));
+    EXPECT_TRUE(bpm->unpin_page(page_id, true));
+
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> flushers;
+    for (int t = 0; t < num_flushers; t++) {
+        flushers.emplace_back([&]() {
+            while (!stop) {
+                EXPECT_TRUE(bpm->flush_page(page_id));
+            }
+        });
+    }
+    for (int i = 1; i <= num_updates; i++) {
+        auto guard = bpm->fetch_page_write(page_id);
+        ASSERT_TRUE(guard.is_valid());
+        memset(guard.get_data_mut(), i & 0xff, PAGE_SIZE);
+    }
+    stop = true;
+    for (auto &flusher : flushers) {
+        flusher.join();
+    }
+
+    // 仍为脏页的页面由flush_all_pages写回，之后磁盘上的内容与缓冲池中的相同
+    bpm->flush_all_pages(fd);
+    char buf[PAGE_SIZE];
+    disk_manager->read_page(fd, page_id.page_no, buf, PAGE_SIZE);
+    {
+        auto guard = bpm->fetch_page_read(page_id);
+        ASSERT_TRUE(guard.is_valid());
+        EXPECT_EQ(0, memcmp(buf, guard.get_data(), PAGE_SIZE));
+    }
+
+    bpm->flush_all_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
@@ -0,0 +1,239 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "replacer/clock_replacer.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "replacer/clock_pro_replacer.h"
+
+const std::vector<std::string> REPLACER_TYPES = {"LRU", "LRU_K", "CLOCK", "CLOCK_PRO"};
+
+/**
+ * @brief 测试ClockReplacer的基本功能：引用位为1的帧会被跳过一次
+ */
+TEST(ClockReplacerTest, SimpleTest) {
+    ClockReplacer clock_replacer(7);
+
+    clock_replacer.unpin(1);
+    clock_replacer.unpin(2);
+    clock_replacer.unpin(3);
+    clock_replacer.unpin(4);
+    clock_replacer.unpin(5);
+    clock_replacer.unpin(6);
+    clock_replacer.unpin(1);
+    EXPECT_EQ(6, clock_replacer.Size());
+
+    // 第一圈清除所有引用位，之后按时钟顺序淘汰
+    int value;
+    clock_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+
+    clock_replacer.pin(3);
+    clock_replacer.pin(4);
+    EXPECT_EQ(2, clock_replacer.Size());
+
+    // 4重新设置了引用位，指针经过时跳过一次
+    clock_replacer.unpin(4);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(6, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+    EXPECT_EQ(0, clock_replacer.Size());
+    EXPECT_FALSE(clock_replacer.victim(&value));
+}
+
+/**
+ * @brief 测试被固定的帧不会被淘汰，取消固定的帧获得第二次机会
+ */
+TEST(ClockReplacerTest, SecondChanceTest) {
+    ClockReplacer clock_replacer(4);
+    for (int i = 0; i < 4; i++) {
+        clock_replacer.unpin(i);
+    }
+    int value;
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+
+    clock_replacer.pin(1);
+    clock_replacer.unpin(1);
+    clock_replacer.pin(2);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(clock_replacer.victim(&value));
+
+    clock_replacer.unpin(2);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(2, value);
+}
+
+/**
+ * @brief 测试CLOCK-Pro的抗扫描能力：被反复访问的页面成为热页面，一次性扫描的页面只在冷帧中淘汰
+ */
+TEST(ClockProReplacerTest, ScanResistanceTest) {
+    ClockProReplacer replacer(8);
+    for (int i = 0; i < 8; i++) {
+        replacer.unpin(i);
+    }
+    EXPECT_EQ(8, replacer.Size());
+
+    // 第一次淘汰时冷指针转了一圈，所有帧开始测试期；1..3在测试期内被再次访问，成为热帧，之后不会被扫描淘汰
+    int value;
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    replacer.unpin(0);
+    for (int i = 1; i < 4; i++) {
+        replacer.pin(i);
+        replacer.unpin(i);
+    }
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 4; i++) {
+            EXPECT_TRUE(replacer.victim(&value));
+            EXPECT_TRUE(value == 0 || value >= 4);
+            replacer.unpin(value);
+        }
+        for (int i = 1; i < 4; i++) {
+            replacer.pin(i);
+            replacer.unpin(i);
+        }
+    }
+
+    // 只剩热帧可以淘汰时，热帧被降级后淘汰
+    for (int i : {0, 4, 5, 6, 7}) {
+        replacer.pin(i);
+    }
+    EXPECT_EQ(3, replacer.Size());
+    for (int i = 1; i < 4; i++) {
+        EXPECT_TRUE(replacer.victim(&value));
+        EXPECT_TRUE(value >= 1 && value < 4);
+    }
+    EXPECT_FALSE(replacer.victim(&value));
+    EXPECT_EQ(0, replacer.Size());
+}
+
+/**
+ * @brief remove移除的热帧不再是热帧，之后装入的页面作为冷帧先于其他热帧被淘汰
+ */
+TEST(ClockProReplacerTest, RemoveTest) {
+    ClockProReplacer replacer(8);
+    for (int i = 0; i < 8; i++) {
+        replacer.unpin(i);
+    }
+    int value;
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    replacer.unpin(0);
+    for (int i = 1; i < 4; i++) {
+        replacer.pin(i);
+        replacer.unpin(i);
+    }
+    // 淘汰所有冷帧，只剩下热帧1..3
+    for (int i = 0; i < 5; i++) {
+        EXPECT_TRUE(replacer.victim(&value));
+        EXPECT_TRUE(value == 0 || value >= 4);
+    }
+    EXPECT_EQ(3, replacer.Size());
+
+    // 帧1装入新页面，只有它是冷帧
+    replacer.remove(1);
+    EXPECT_EQ(2, replacer.Size());
+    replacer.unpin(1);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_TRUE(value == 2 || value == 3);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_TRUE(value == 2 || value == 3);
+    EXPECT_FALSE(replacer.victim(&value));
+}
+
+/**
+ * @brief 每个策略都要在Size()个可淘汰帧上各返回一次，且不返回被固定的帧
+ */
+TEST(ClockReplacerTest, PinnedFramesTest) {
+    for (auto &type : REPLACER_TYPES) {
+        const int value_size = 1000;
+        auto replacer = Replacer::create(type, value_size);
+        for (int i = 0; i < value_size; i++) {
+            replacer->unpin(i);
+        }
+        for (int i = 0; i < value_size; i += 3) {
+            replacer->pin(i);
+        }
+        EXPECT_EQ(value_size - (value_size + 2) / 3, replacer->Size()) << type;
+        std::vector<int> out_values;
+        int result;
+        while (replacer->victim(&result)) {
+            EXPECT_NE(0, result % 3) << type;
+            out_values.push_back(result);
+        }
+        std::sort(out_values.begin(), out_values.end());
+        EXPECT_EQ(std::unique(out_values.begin(), out_values.end()), out_values.end()) << type;
+        EXPECT_EQ(value_size - (value_size + 2) / 3, out_values.size()) << type;
+        EXPECT_EQ(0, replacer->Size()) << type;
+    }
+}
+
+/**
+ * @brief 并发unpin之后每个帧恰好被淘汰一次
+ */
+TEST(ClockReplacerTest, ConcurrencyTest) {
+    const int num_threads = 5;
+    const int num_runs = 50;
+    for (auto &type : {"LRU_K", "CLOCK", "CLOCK_PRO"}) {
+        for (int run = 0; run < num_runs; run++) {
+            int value_size = 1000;
+            auto replacer = Replacer::create(type, value_size);
+            std::vector<std::thread> threads;
+            std::vector<int> value(value_size);
+            for (int i = 0; i < value_size; i++) {
+                value[i] = i;
+            }
+            auto rng = std::default_random_engine{};
+            std::shuffle(value.begin(), value.end(), rng);
+
+            for (int tid = 0; tid < num_threads; tid++) {
+                threads.push_back(std::thread([tid, &replacer, &value]() {
+                    int share = 1000 / 5;
+                    for (int i = 0; i < share; i++) {
+                        replacer->pin(value[tid * share + i]);
+                        replacer->unpin(value[tid * share + i]);
+                    }
+                }));
+            }
+            for (int i = 0; i < num_threads; i++) {
+                threads[i].join();
+            }
+            std::vector<int> out_values;
+            int result;
+            for (int i = 0; i < value_size; i++) {
+                EXPECT_EQ(1, replacer->victim(&result));
+                out_values.push_back(result);
+            }
+            std::sort(value.begin(), value.end());
+            std::sort(out_values.begin(), out_values.end());
+            EXPECT_EQ(value, out_values);
+            EXPECT_EQ(0, replacer->victim(&result));
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 比较普通读写与O_DIRECT读写下缓冲池的吞吐量
+ * 用法: direct_io_bench [数据页数=65536] [缓冲池帧数=8192] [操作次数=200000] [线程数=4]
+ * 数据量大于缓冲池时，大部分fetch_page都会缺页，吞吐量主要取决于磁盘读写路径
+ */
+
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string BENCH_FILE_NAME = "direct_io_bench.dat";
+
+struct BenchResult {
+    double load_seconds;  // 创建并写回全部数据页的时间
+    double run_seconds;   // 随机访问阶段的时间
+    bool direct;          // 文件实际是否以O_DIRECT打开
+};
+
+BenchResult run_bench(bool direct_io, int num_pages, int pool_size, int num_ops, int num_threads) {
+    DiskManager disk_manager;
+    disk_manager.set_direct_io(direct_io);
+    if (disk_manager.is_file(BENCH_FILE_NAME)) {
+        disk_manager.destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager.create_file(BENCH_FILE_NAME);
+    int fd = disk_manager.open_file(BENCH_FILE_NAME);
+    BenchResult result;
+    result.direct = disk_manager.is_direct_io(fd);
+    {
+        BufferPoolManager bpm(pool_size, &disk_manager);
+        // 装载阶段：顺序创建全部页面，缓冲池满后脏页被淘汰写回
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm.new_page(&page_id);
+            memcpy(page->get_data(), &i, sizeof(i));
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+        result.load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // 丢弃该文件在内核页缓存中的内容，使两种模式都从冷缓存开始
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+        // 随机访问阶段：多线程均匀随机读取页面，其中十分之一修改页面
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(t);
+                std::uniform_int_distribution<int> dist(0, num_pages - 1);
+                for (int i = 0; i < num_ops / num_threads; i++) {
+                    PageId page_id = {.fd = fd, .page_no = dist(rng)};
+                    Page *page = bpm.fetch_page(page_id);
+                    if (page == nullptr) {
+                        continue;
+                    }
+                    bool dirty = i % 10 == 0;
+                    if (dirty) {
+                        page->get_data()[sizeof(int)]++;
+                    }
+                    bpm.unpin_page(page_id, dirty);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        result.run_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? std::stoi(argv[1]) : 65536;
+    int pool_size = argc > 2 ? std::stoi(argv[2]) : 8192;
+    int num_ops = argc > 3 ? std::stoi(argv[3]) : 200000;
+    int num_threads = argc > 4 ? std::stoi(argv[4]) : 4;
+    std::cout << "pages: " << num_pages << ", pool frames: " << pool_size << ", ops: " << num_ops
+              << ", threads: " << num_threads << std::endl;
+    for (bool direct_io : {false, true}) {
+        BenchResult result = run_bench(direct_io, num_pages, pool_size, num_ops, num_threads);
+        std::cout << (direct_io ? "O_DIRECT" : "buffered") << (direct_io && !result.direct ? "(unsupported)" : "")
+                  << "\tload: " << num_pages / result.load_seconds << " pages/s"
+                  << "\trandom fetch: " << num_ops / result.run_seconds << " ops/s" << std::endl;
+    }
+    return 0;
+}
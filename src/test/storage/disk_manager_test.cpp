@@ -1,11 +1,17 @@
 #include "storage/disk_manager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "storage/compressed_file.h"
+#include "storage/page_codec.h"
 
 constexpr int MAX_FILES = 32;
 constexpr int MAX_PAGES = 128;
@@ -147,3 +153,473 @@ TEST_F(DiskManagerTest, PageOperation) {
     disk_manager_->destroy_file(filename);
     EXPECT_EQ(disk_manager_->is_file(filename), false);
 }
+
+/**
+ * @brief 测试异步读写页面，一次提交多个请求使其同时在途 submit/wait page io
+ */
+TEST_F(DiskManagerTest, AsyncPageOperation) {
+    const std::string filename = "AsyncPageOperationTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<std::vector<char>> buf(MAX_PAGES, std::vector<char>(PAGE_SIZE, 0));
+    std::vector<IoRequest> reqs(MAX_PAGES);
+    // 先提交全部写请求，再统一等待
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        rand_buf(data[page_no].data(), PAGE_SIZE);
+        data[page_no][0] = static_cast<char>(page_no);  // 保证各页内容不同
+        disk_manager_->submit_write_page(fd, page_no, data[page_no].data(), PAGE_SIZE, &reqs[page_no]);
+    }
+    for (auto &req : reqs) {
+        disk_manager_->wait_page_io(&req);
+    }
+    // 再以逆序提交全部读请求
+    for (int page_no = MAX_PAGES - 1; page_no >= 0; page_no--) {
+        disk_manager_->submit_read_page(fd, page_no, buf[page_no].data(), PAGE_SIZE, &reqs[page_no]);
+    }
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        disk_manager_->wait_page_io(&reqs[page_no]);
+        EXPECT_EQ(std::memcmp(buf[page_no].data(), data[page_no].data(), PAGE_SIZE), 0);
+    }
+    // 读取文件末尾之后的页面属于短读，应当抛出异常
+    char tail[PAGE_SIZE];
+    IoRequest tail_req;
+    disk_manager_->submit_read_page(fd, MAX_PAGES, tail, PAGE_SIZE, &tail_req);
+    EXPECT_THROW(disk_manager_->wait_page_io(&tail_req), InternalError);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试I/O引擎处理短读写：读到文件末尾时返回实际读到的字节数，其他短读写继续读写剩余部分
+ */
+TEST_F(DiskManagerTest, IoEngineShortTransfer) {
+    const std::string filename = "IoEngineShortTransferTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename, false);
+    const int file_size = PAGE_SIZE + PAGE_SIZE / 2;
+    std::vector<char> data(file_size);
+    rand_buf(data.data(), file_size);
+    ASSERT_EQ(pwrite(fd, data.data(), file_size, 0), file_size);
+
+    for (auto &type : {"URING", "THREAD_POOL"}) {
+        auto engine = IoEngine::create(type, 8, 1);
+        std::vector<char> buf(2 * PAGE_SIZE, 0);
+        struct iovec iovs[2] = {{buf.data(), PAGE_SIZE}, {buf.data() + PAGE_SIZE, PAGE_SIZE}};
+        IoRequest req;
+        req.fd = fd;
+        req.iovs = iovs;
+        req.iov_cnt = 2;
+        req.num_bytes = 2 * PAGE_SIZE;
+        engine->submit(&req);
+        engine->wait(&req);
+        EXPECT_EQ(req.result, file_size) << engine->name();
+        EXPECT_EQ(std::memcmp(buf.data(), data.data(), file_size), 0) << engine->name();
+
+        // 从页面中间开始读，剩余部分从第一个缓冲区的中间继续
+        std::fill(buf.begin(), buf.end(), 0);
+        req.offset = PAGE_SIZE / 2;
+        engine->submit(&req);
+        engine->wait(&req);
+        EXPECT_EQ(req.result, PAGE_SIZE) << engine->name();
+        EXPECT_EQ(std::memcmp(buf.data(), data.data() + PAGE_SIZE / 2, PAGE_SIZE), 0) << engine->name();
+    }
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+
+    // 管道只有一半数据时io_uring返回短读，引擎应当继续读取剩余部分，而不是以一半的结果完成请求
+    auto engine = IoEngine::create("URING", 8, 1);
+    if (engine->name() != "URING") {
+        return;
+    }
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+    std::vector<char> buf(PAGE_SIZE, 0);
+    IoRequest req;
+    req.fd = pipe_fds[0];
+    req.buf = buf.data();
+    req.num_bytes = PAGE_SIZE;
+    ASSERT_EQ(write(pipe_fds[1], data.data(), PAGE_SIZE / 2), PAGE_SIZE / 2);
+    engine->submit(&req);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(write(pipe_fds[1], data.data() + PAGE_SIZE / 2, PAGE_SIZE / 2), PAGE_SIZE / 2);
+    engine->wait(&req);
+    EXPECT_EQ(req.result, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf.data(), data.data(), PAGE_SIZE), 0);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+/**
+ * @brief 测试连续页面的批量读写 read_pages/write_pages
+ */
+TEST_F(DiskManagerTest, BatchPageOperation) {
+    const std::string filename = "BatchPageOperationTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<std::vector<char>> buf(MAX_PAGES, std::vector<char>(PAGE_SIZE, 0));
+    std::vector<const char *> data_ptrs(MAX_PAGES);
+    std::vector<char *> buf_ptrs(MAX_PAGES);
+    for (int i = 0; i < MAX_PAGES; i++) {
+        rand_buf(data[i].data(), PAGE_SIZE);
+        data[i][0] = static_cast<char>(i);
+        data_ptrs[i] = data[i].data();
+        buf_ptrs[i] = buf[i].data();
+    }
+    // 一次写入全部页面，再分两段读回
+    disk_manager_->write_pages(fd, 0, data_ptrs.data(), MAX_PAGES);
+    disk_manager_->read_pages(fd, 0, buf_ptrs.data(), MAX_PAGES / 2);
+    disk_manager_->read_pages(fd, MAX_PAGES / 2, buf_ptrs.data() + MAX_PAGES / 2, MAX_PAGES - MAX_PAGES / 2);
+    for (int i = 0; i < MAX_PAGES; i++) {
+        EXPECT_EQ(std::memcmp(buf[i].data(), data[i].data(), PAGE_SIZE), 0);
+    }
+    // 超出文件末尾的批量读取应当抛出异常
+    EXPECT_THROW(disk_manager_->read_pages(fd, MAX_PAGES - 1, buf_ptrs.data(), 2), InternalError);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试O_DIRECT模式下的页面读写，包括未对齐和不足一页的读写 direct io
+ */
+TEST_F(DiskManagerTest, DirectIoPageOperation) {
+    const std::string filename = "DirectIoPageOperationTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    disk_manager_->set_direct_io(true);
+    int fd = disk_manager_->open_file(filename);
+
+    // 不足一页且未对齐的写入（如文件头），不能破坏同一页中其余的数据
+    char data[PAGE_SIZE + 1];
+    char *unaligned = data + 1;
+    rand_buf(unaligned, PAGE_SIZE);
+    disk_manager_->write_page(fd, 0, unaligned, PAGE_SIZE);
+    char hdr[100];
+    rand_buf(hdr, sizeof(hdr));
+    hdr[0] = ~unaligned[0];
+    disk_manager_->write_page(fd, 0, hdr, sizeof(hdr));
+    std::memcpy(unaligned, hdr, sizeof(hdr));
+
+    char buf[PAGE_SIZE + 1];
+    disk_manager_->read_page(fd, 0, buf + 1, sizeof(hdr));
+    EXPECT_EQ(std::memcmp(buf + 1, hdr, sizeof(hdr)), 0);
+    disk_manager_->read_page(fd, 0, buf + 1, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf + 1, unaligned, PAGE_SIZE), 0);
+
+    // 对齐的缓冲区直接读写，包括异步读写
+    char *aligned = static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, 2 * PAGE_SIZE));
+    rand_buf(aligned, PAGE_SIZE);
+    IoRequest req;
+    disk_manager_->submit_write_page(fd, 1, aligned, PAGE_SIZE, &req);
+    disk_manager_->wait_page_io(&req);
+    disk_manager_->submit_read_page(fd, 1, aligned + PAGE_SIZE, PAGE_SIZE, &req);
+    disk_manager_->wait_page_io(&req);
+    EXPECT_EQ(std::memcmp(aligned, aligned + PAGE_SIZE, PAGE_SIZE), 0);
+    free(aligned);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->set_direct_io(false);
+    // 以普通方式重新打开，确认数据确实落盘
+    fd = disk_manager_->open_file(filename);
+    EXPECT_EQ(disk_manager_->is_direct_io(fd), false);
+    disk_manager_->read_page(fd, 0, buf, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf, unaligned, PAGE_SIZE), 0);
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试页面释放与复用，以及空闲页面列表的持久化 deallocate page
+ */
+TEST_F(DiskManagerTest, FreePageReuse) {
+    const std::string filename = "FreePageReuseTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+    for (int page_no = 0; page_no < 10; page_no++) {
+        EXPECT_EQ(disk_manager_->allocate_page(fd), page_no);
+    }
+    // 释放的页面按页号从小到大被重新分配，用完之后才继续向文件末尾分配
+    disk_manager_->deallocate_page(fd, 7);
+    disk_manager_->deallocate_page(fd, 3);
+    disk_manager_->deallocate_page(fd, 5);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 3);
+
+    // 空闲页面列表的序列化与恢复
+    char buf[PAGE_SIZE];
+    int size = disk_manager_->save_free_pages(fd, buf, sizeof(buf));
+    EXPECT_EQ(size, static_cast<int>(sizeof(int) + 3 * sizeof(page_id_t)));
+    disk_manager_->close_file(fd);
+    fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 10);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 10);  // 重新打开后空闲页面列表为空，直到从文件头恢复
+    disk_manager_->load_free_pages(fd, buf);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 5);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 7);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 11);
+
+    // 文件头中放不下的空闲页面写入溢出页，恢复后一个也不丢失
+    const int num_pages = 3 * PAGE_SIZE / static_cast<int>(sizeof(page_id_t));
+    for (int page_no = 12; page_no < num_pages; page_no++) {
+        EXPECT_EQ(disk_manager_->allocate_page(fd), page_no);
+    }
+    for (int page_no = 12; page_no < num_pages; page_no++) {
+        disk_manager_->deallocate_page(fd, page_no);
+    }
+    size = disk_manager_->save_free_pages(fd, buf, 64);
+    EXPECT_LE(size, 64);
+    disk_manager_->close_file(fd);
+    fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, num_pages);
+    disk_manager_->load_free_pages(fd, buf);
+    for (int page_no = 12; page_no < num_pages; page_no++) {
+        EXPECT_EQ(disk_manager_->allocate_page(fd), page_no);
+    }
+    EXPECT_EQ(disk_manager_->allocate_page(fd), num_pages);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试按extent预分配文件空间 fallocate
+ */
+TEST_F(DiskManagerTest, ExtentPreallocation) {
+    const std::string filename = "ExtentPreallocationTestFile";
+    // 清理残留文件
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    char data[PAGE_SIZE];
+    rand_buf(data, PAGE_SIZE);
+    page_id_t page_no = disk_manager_->allocate_page(fd);
+    disk_manager_->write_page(fd, page_no, data, PAGE_SIZE);
+    struct stat st;
+    EXPECT_EQ(fstat(fd, &st), 0);
+    // 文件大小只包含已经写入的页面，但磁盘空间按extent预先分配（文件系统不支持fallocate时除外）
+    EXPECT_EQ(st.st_size, PAGE_SIZE);
+    if (FILE_EXTENT_SIZE > 0 && st.st_blocks * 512 > PAGE_SIZE) {
+        EXPECT_GE(st.st_blocks * 512, FILE_EXTENT_SIZE);
+    }
+    // 预分配的区域中尚未写入的页面仍然视为超出文件末尾
+    page_id_t next_page_no = disk_manager_->allocate_page(fd);
+    EXPECT_EQ(next_page_no, page_no + 1);
+    EXPECT_THROW(disk_manager_->read_page(fd, next_page_no, data, PAGE_SIZE), InternalError);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试已打开文件的注册表：fd没有固定上限，查找与打开、关闭文件可以并发进行
+ */
+TEST_F(DiskManagerTest, OpenFileRegistry) {
+    // 大于原来8192上限的fd也可以登记
+    OpenFileRegistry registry;
+    const int large_fd = 100000;
+    EXPECT_EQ(registry.get(large_fd).get(), nullptr);
+    OpenFile *file = registry.add(large_fd, "large_fd_file", false, nullptr);
+    EXPECT_EQ(registry.get(large_fd).get(), file);
+    EXPECT_EQ(registry.find("large_fd_file"), large_fd);
+    registry.remove(large_fd);
+    EXPECT_EQ(registry.get(large_fd).get(), nullptr);
+    EXPECT_EQ(registry.find("large_fd_file"), -1);
+
+    // 被替换下来的OpenFile在持有它的引用释放之前不会被释放，之后的一次登记或注销会回收它
+    registry.add(large_fd, "large_fd_file", false, nullptr);
+    {
+        OpenFileRef ref = registry.get(large_fd);
+        registry.remove(large_fd);
+        registry.add(large_fd, "reopened_file", false, nullptr);
+        EXPECT_GT(registry.num_retired(), 0u);
+        EXPECT_EQ(ref->path, "large_fd_file");
+    }
+    registry.remove(large_fd);
+    EXPECT_EQ(registry.num_retired(), 0u);
+
+    const std::string filename = "OpenFileRegistryTestFile";
+    const int num_files = 16;
+    std::vector<int> fds;
+    for (int i = 0; i < num_files; i++) {
+        std::string name = filename + std::to_string(i);
+        if (disk_manager_->is_file(name)) {
+            disk_manager_->destroy_file(name);
+        }
+        disk_manager_->create_file(name);
+        fds.push_back(disk_manager_->open_file(name));
+    }
+    // 查找线程反复按fd和路径查找前一半文件，同时主线程反复打开、关闭后一半文件
+    std::atomic<bool> stop = false;
+    std::atomic<int> mismatches = 0;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                for (int i = 0; i < num_files / 2; i++) {
+                    std::string name = filename + std::to_string(i);
+                    if (disk_manager_->get_file_fd(name) != fds[i] || disk_manager_->get_file_name(fds[i]) != name) {
+                        mismatches++;
+                    }
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 200; round++) {
+        for (int i = num_files / 2; i < num_files; i++) {
+            disk_manager_->close_file(fds[i]);
+            fds[i] = disk_manager_->open_file(filename + std::to_string(i));
+        }
+    }
+    stop = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches, 0);
+    // 查找线程都已退出，替换下来的OpenFile和路径快照不会一直积累
+    disk_manager_->close_file(fds[num_files - 1]);
+    fds[num_files - 1] = disk_manager_->open_file(filename + std::to_string(num_files - 1));
+    EXPECT_EQ(disk_manager_->get_num_retired_files(), 0u);
+
+    // 每个文件记录自己的I/O统计
+    char data[PAGE_SIZE];
+    rand_buf(data, PAGE_SIZE);
+    disk_manager_->write_page(fds[0], 0, data, PAGE_SIZE);
+    disk_manager_->read_page(fds[0], 0, data, PAGE_SIZE);
+    FileIoStats stats = disk_manager_->get_file_io_stats(fds[0]);
+    EXPECT_EQ(stats.num_writes, 1u);
+    EXPECT_EQ(stats.num_reads, 1u);
+    EXPECT_EQ(stats.bytes_written, static_cast<uint64_t>(PAGE_SIZE));
+    EXPECT_EQ(disk_manager_->get_file_io_stats(fds[1]).num_writes, 0u);
+
+    for (int i = 0; i < num_files; i++) {
+        disk_manager_->close_file(fds[i]);
+        disk_manager_->destroy_file(filename + std::to_string(i));
+    }
+    EXPECT_THROW(disk_manager_->get_file_name(fds[0]), FileNotOpenError);
+}
+
+/**
+ * @brief 测试页面压缩格式的文件：读写、部分写入、重写变长、异步读写、关闭后按映射或扫描重新打开
+ */
+TEST_F(DiskManagerTest, CompressedPageOperation) {
+    // 压缩与解压互逆，不可压缩的数据返回-1
+    char page[PAGE_SIZE];
+    char compressed[PAGE_SIZE];
+    char decompressed[PAGE_SIZE];
+    for (int i = 0; i < PAGE_SIZE; i++) {
+        page[i] = "rucbase"[i % 7] + (i / 512);
+    }
+    int len = lz_compress(page, PAGE_SIZE, compressed, PAGE_SIZE);
+    ASSERT_GT(len, 0);
+    EXPECT_LT(len, PAGE_SIZE / 4);
+    EXPECT_EQ(lz_decompress(compressed, len, decompressed, PAGE_SIZE), PAGE_SIZE);
+    EXPECT_EQ(memcmp(page, decompressed, PAGE_SIZE), 0);
+    EXPECT_EQ(lz_decompress(compressed, len, decompressed, PAGE_SIZE - 1), -1);
+    rand_buf(page, PAGE_SIZE);
+    EXPECT_EQ(lz_compress(page, PAGE_SIZE, compressed, PAGE_SIZE), -1);
+
+    const std::string filename = "CompressedPageTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename, true);
+    EXPECT_TRUE(CompressedFile::is_compressed(filename));
+    int fd = disk_manager_->open_file(filename);
+    EXPECT_TRUE(disk_manager_->is_compressed(fd));
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    // 页面内容：前一半是记录，后一半是空闲空间
+    std::vector<std::vector<char>> pages(MAX_PAGES, std::vector<char>(PAGE_SIZE, 0));
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        EXPECT_EQ(disk_manager_->allocate_page(fd), page_no);
+        EXPECT_FALSE(disk_manager_->has_page(fd, page_no));
+        for (int i = 0; i < PAGE_SIZE / 2; i++) {
+            pages[page_no][i] = static_cast<char>((i % 64) + page_no);
+        }
+        disk_manager_->write_page(fd, page_no, pages[page_no].data(), PAGE_SIZE);
+        EXPECT_TRUE(disk_manager_->has_page(fd, page_no));
+    }
+    FileIoStats stats = disk_manager_->get_file_io_stats(fd);
+    EXPECT_LT(stats.bytes_written, static_cast<uint64_t>(MAX_PAGES) * PAGE_SIZE / 2);
+
+    // 部分写入只覆盖页面开头；写入随机数据使页面变长后被挪到文件末尾
+    memset(pages[1].data(), 0xab, 100);
+    disk_manager_->write_page(fd, 1, pages[1].data(), 100);
+    rand_buf(pages[2].data(), PAGE_SIZE);
+    disk_manager_->write_page(fd, 2, pages[2].data(), PAGE_SIZE);
+    // 异步读写在提交时同步完成
+    IoRequest req;
+    rand_buf(pages[3].data(), PAGE_SIZE / 4);
+    disk_manager_->submit_write_page(fd, 3, pages[3].data(), PAGE_SIZE, &req);
+    disk_manager_->wait_page_io(&req);
+    disk_manager_->submit_read_page(fd, 3, page, PAGE_SIZE, &req);
+    disk_manager_->wait_page_io(&req);
+    EXPECT_EQ(memcmp(page, pages[3].data(), PAGE_SIZE), 0);
+    disk_manager_->submit_read_page(fd, MAX_PAGES, page, PAGE_SIZE, &req);
+    EXPECT_THROW(disk_manager_->wait_page_io(&req), InternalError);
+
+    auto check_pages = [&](int fd) {
+        char buf[PAGE_SIZE];
+        for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+            disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);
+            EXPECT_EQ(memcmp(buf, pages[page_no].data(), PAGE_SIZE), 0) << "page_no: " << page_no;
+        }
+    };
+    check_pages(fd);
+    EXPECT_THROW(disk_manager_->read_page(fd, MAX_PAGES, page, PAGE_SIZE), InternalError);
+
+    // 正常关闭后按页面映射文件打开
+    disk_manager_->close_file(fd);
+    EXPECT_TRUE(disk_manager_->is_file(CompressedFile::map_path(filename)));
+    fd = disk_manager_->open_file(filename);
+    EXPECT_FALSE(disk_manager_->is_file(CompressedFile::map_path(filename)));
+    check_pages(fd);
+    rand_buf(pages[4].data(), PAGE_SIZE);
+    disk_manager_->write_page(fd, 4, pages[4].data(), PAGE_SIZE);
+    disk_manager_->sync_file(fd);
+
+    // 模拟没有正常关闭：打开后映射文件已被删除，此时另建的CompressedFile扫描整个文件重建映射，同一页面取最新的版本
+    int dup_fd = open(filename.c_str(), O_RDWR);
+    ASSERT_GE(dup_fd, 0);
+    {
+        CompressedFile scanned(dup_fd, filename);
+        char buf[PAGE_SIZE];
+        for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+            scanned.read_page(page_no, buf);
+            EXPECT_EQ(memcmp(buf, pages[page_no].data(), PAGE_SIZE), 0) << "page_no: " << page_no;
+        }
+    }
+    close(dup_fd);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+    EXPECT_FALSE(disk_manager_->is_file(CompressedFile::map_path(filename)));
+}
@@ -0,0 +1,155 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "replacer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @description: 模拟缓冲池对帧的一次访问
+ */
+void access(LRUKReplacer *replacer, frame_id_t frame_id) {
+    replacer->pin(frame_id);
+    replacer->unpin(frame_id);
+}
+
+/**
+ * @brief 测试LRUKReplacer(K=2)的淘汰顺序：访问不足两次的帧按第一次访问的时间先淘汰，
+ * 其余的按倒数第二次访问的时间淘汰
+ */
+TEST(LRUKReplacerTest, SimpleTest) {
+    LRUKReplacer replacer(7, 2);
+    for (int i = 1; i <= 6; i++) {
+        access(&replacer, i);
+    }
+    access(&replacer, 1);
+    EXPECT_EQ(6, replacer.Size());
+
+    int value;
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(3, value);
+
+    // 5访问满两次，不再优先淘汰；被固定的4不能淘汰
+    access(&replacer, 5);
+    replacer.pin(4);
+    EXPECT_EQ(3, replacer.Size());
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(1, value);
+
+    // 4有两次访问，倒数第二次早于5的倒数第二次
+    replacer.unpin(4);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(4, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(5, value);
+    EXPECT_FALSE(replacer.victim(&value));
+    EXPECT_EQ(0, replacer.Size());
+
+    // 被淘汰的帧重新开始记录访问历史
+    access(&replacer, 5);
+    access(&replacer, 2);
+    access(&replacer, 2);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(5, value);
+}
+
+/**
+ * @brief 反复访问的帧不会被只访问一次的扫描帧挤出
+ */
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+    const int num_frames = 64;
+    const int num_hot_frames = 16;
+    LRUKReplacer replacer(num_frames, 2);
+    for (int i = 0; i < num_frames; i++) {
+        access(&replacer, i);
+    }
+    for (int i = 0; i < num_hot_frames; i++) {
+        access(&replacer, i);
+    }
+    std::mt19937 rng(0);
+    for (int round = 0; round < 1000; round++) {
+        int value;
+        EXPECT_TRUE(replacer.victim(&value));
+        EXPECT_GE(value, num_hot_frames);
+        access(&replacer, value);
+        access(&replacer, static_cast<frame_id_t>(rng() % num_hot_frames));
+    }
+    EXPECT_EQ(num_frames, replacer.Size());
+
+    // 只剩访问过两次的帧时，淘汰倒数第二次访问最早的帧
+    std::vector<int> out_values;
+    int value;
+    while (replacer.victim(&value)) {
+        out_values.push_back(value);
+    }
+    EXPECT_EQ(num_frames, out_values.size());
+    std::sort(out_values.begin(), out_values.end());
+    EXPECT_EQ(out_values.end(), std::unique(out_values.begin(), out_values.end()));
+}
+
+/**
+ * @brief 相关访问期内对同一帧的多次访问只算作一次访问
+ */
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+    LRUKReplacer replacer(4, 2, 2);
+    // 帧0被连续访问多次（如扫描逐条读取同一页面），仍然只有一次访问
+    access(&replacer, 0);
+    access(&replacer, 0);
+    access(&replacer, 0);
+    // 帧1相隔较远的两次访问是两次独立的访问
+    access(&replacer, 1);
+    access(&replacer, 2);
+    access(&replacer, 3);
+    access(&replacer, 1);
+    access(&replacer, 2);
+    access(&replacer, 3);
+    int value;
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+
+    // 所有帧都处于相关访问期内时，仍然可以淘汰
+    LRUKReplacer small(2, 2, 8);
+    access(&small, 0);
+    access(&small, 1);
+    EXPECT_TRUE(small.victim(&value));
+    EXPECT_EQ(0, value);
+}
+
+/**
+ * @brief remove移除的帧不能被淘汰，并且之后装入的页面不继承旧的访问历史
+ */
+TEST(LRUKReplacerTest, RemoveTest) {
+    LRUKReplacer replacer(3, 2);
+    access(&replacer, 0);
+    access(&replacer, 0);
+    access(&replacer, 1);
+    access(&replacer, 2);
+    access(&replacer, 2);
+    replacer.remove(0);
+    EXPECT_EQ(2, replacer.Size());
+
+    // 帧0装入新页面后只有一次访问，先于访问过两次的帧2被淘汰
+    access(&replacer, 0);
+    int value;
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_TRUE(replacer.victim(&value));
+    EXPECT_EQ(2, value);
+}
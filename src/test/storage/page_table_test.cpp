@@ -0,0 +1,136 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/page_table.h"
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(PageTableTest, SimpleTest) {
+    PageTable page_table(8);
+    EXPECT_EQ(page_table.capacity(), 16);
+    frame_id_t frame_id;
+    EXPECT_FALSE(page_table.find(PageId{3, 0}, &frame_id));
+
+    page_table.insert(PageId{3, 0}, 1);
+    page_table.insert(PageId{3, 1}, 2);
+    // 旧的PageIdHash中(fd << 16) | page_no会让这两个页面冲突
+    page_table.insert(PageId{3, 1 << 16}, 3);
+    page_table.insert(PageId{4, 0}, 4);
+    EXPECT_EQ(page_table.size(), 4);
+    ASSERT_TRUE(page_table.find(PageId{3, 1 << 16}, &frame_id));
+    EXPECT_EQ(frame_id, 3);
+    ASSERT_TRUE(page_table.find(PageId{4, 0}, &frame_id));
+    EXPECT_EQ(frame_id, 4);
+    ASSERT_TRUE(page_table.find_optimistic(PageId{3, 1}, &frame_id));
+    EXPECT_EQ(frame_id, 2);
+
+    // 重复插入更新映射
+    page_table.insert(PageId{3, 0}, 5);
+    EXPECT_EQ(page_table.size(), 4);
+    ASSERT_TRUE(page_table.find(PageId{3, 0}, &frame_id));
+    EXPECT_EQ(frame_id, 5);
+
+    EXPECT_TRUE(page_table.erase(PageId{3, 0}));
+    EXPECT_FALSE(page_table.erase(PageId{3, 0}));
+    EXPECT_FALSE(page_table.find(PageId{3, 0}, &frame_id));
+    EXPECT_FALSE(page_table.find_optimistic(PageId{3, 0}, &frame_id));
+    EXPECT_EQ(page_table.size(), 3);
+}
+
+/**
+ * @brief 随机插入删除，与unordered_map的结果比较；页表装满帧数个映射，删除时的槽位移动被充分覆盖
+ */
+TEST(PageTableTest, ChurnTest) {
+    const int num_frames = 64;
+    PageTable page_table(num_frames);
+    std::unordered_map<PageId, frame_id_t> model;
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> page_dist(0, 4 * num_frames);
+    std::uniform_int_distribution<int> fd_dist(3, 5);
+    for (int round = 0; round < 200000; round++) {
+        PageId page_id{fd_dist(rng), page_dist(rng) << (round % 3 == 0 ? 16 : 0)};
+        frame_id_t frame_id;
+        bool found = page_table.find(page_id, &frame_id);
+        auto it = model.find(page_id);
+        ASSERT_EQ(found, it != model.end());
+        if (found) {
+            ASSERT_EQ(frame_id, it->second);
+            ASSERT_TRUE(page_table.erase(page_id));
+            model.erase(it);
+        } else if (static_cast<int>(model.size()) < num_frames) {
+            page_table.insert(page_id, round % num_frames);
+            model[page_id] = round % num_frames;
+        }
+        ASSERT_EQ(page_table.size(), model.size());
+    }
+    for (auto &entry : model) {
+        frame_id_t frame_id;
+        ASSERT_TRUE(page_table.find(entry.first, &frame_id));
+        EXPECT_EQ(frame_id, entry.second);
+    }
+}
+
+/**
+ * @brief 一个线程在latch下不断插入删除，其他线程不加锁地查找一直存在的页面，必须总能找到正确的帧
+ */
+TEST(PageTableTest, OptimisticReadTest) {
+    const int num_frames = 128;
+    const int num_stable = num_frames / 2;
+    const int num_readers = 3;
+    PageTable page_table(num_frames);
+    std::mutex latch;
+    for (int i = 0; i < num_stable; i++) {
+        page_table.insert(PageId{3, i}, i);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> num_errors{0};
+    std::thread writer([&]() {
+        std::mt19937 rng(23);
+        std::vector<PageId> churn;
+        for (int round = 0; round < 50000; round++) {
+            std::scoped_lock lock{latch};
+            if (churn.size() < static_cast<size_t>(num_frames - num_stable) && rng() % 2 == 0) {
+                PageId page_id{4, static_cast<int>(rng() % 100000)};
+                page_table.insert(page_id, num_stable + static_cast<int>(churn.size()));
+                churn.push_back(page_id);
+            } else if (!churn.empty()) {
+                size_t i = rng() % churn.size();
+                page_table.erase(churn[i]);
+                churn[i] = churn.back();
+                churn.pop_back();
+            }
+        }
+        stop = true;
+    });
+    std::vector<std::thread> readers;
+    for (int t = 0; t < num_readers; t++) {
+        readers.emplace_back([&, t]() {
+            for (int i = t; !stop; i = (i + 1) % num_stable) {
+                frame_id_t frame_id;
+                if (!page_table.find_optimistic(PageId{3, i}, &frame_id) || frame_id != i) {
+                    num_errors++;
+                }
+            }
+        });
+    }
+    writer.join();
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(num_errors, 0);
+}
@@ -8,7 +8,9 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <iterator>
 #include <unordered_map>
+#include <vector>
 
 #include "gtest/gtest.h"
 #define BUFFER_LENGTH 8192
@@ -222,4 +224,317 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 测试以只读方式打开的表：通过内存映射读取记录和扫描，修改记录时报错
+ */
+TEST(RecordManagerTest, ReadOnlyMmapTest) {
+    srand((unsigned)time(nullptr));
+
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    std::string filename = "read_only.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    int record_size = 4 + rand() % 256;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    assert(!file_handle->is_mapped());
+    char write_buf[PAGE_SIZE];
+    for (int i = 0; i < 1000; i++) {
+        rand_buf(record_size, write_buf);
+        Rid rid = file_handle->insert_record(write_buf, context);
+        mock[rid] = std::string(write_buf, record_size);
+    }
+    rm_manager->close_file(file_handle.get());
+
+    // 只读方式打开后，读取和扫描的结果与写入的一致
+    file_handle = rm_manager->open_file(filename, true);
+    assert(file_handle->is_read_only());
+    assert(file_handle->is_mapped());
+    check_equal(file_handle.get(), mock);
+    EXPECT_THROW(file_handle->insert_record(write_buf, context), TableReadOnlyError);
+    EXPECT_THROW(file_handle->update_record(mock.begin()->first, write_buf, context), TableReadOnlyError);
+    EXPECT_THROW(file_handle->delete_record(mock.begin()->first, context), TableReadOnlyError);
+    rm_manager->close_file(file_handle.get());
+
+    // 重新以读写方式打开，文件头没有被修改
+    file_handle = rm_manager->open_file(filename);
+    check_equal(file_handle.get(), mock);
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试记录的插入、读取、更新、删除和扫描之后没有遗留被固定的页面，缓冲池的所有帧仍然可以使用
+ */
+TEST(RecordManagerTest, NoLeakedPinsTest) {
+    srand((unsigned)time(nullptr));
+
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    const int pool_size = 32;
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(pool_size, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    std::string filename = "no_leaked_pins.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    int record_size = 512;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    char write_buf[PAGE_SIZE];
+    // 页面数远大于缓冲池的帧数，遗留的固定会使缓冲池很快耗尽
+    for (int i = 0; i < 2000; i++) {
+        rand_buf(record_size, write_buf);
+        Rid rid = file_handle->insert_record(write_buf, context);
+        mock[rid] = std::string(write_buf, record_size);
+    }
+    assert(file_handle->file_hdr_.num_pages > 4 * pool_size);
+    for (int i = 0; i < 1000; i++) {
+        auto it = std::next(mock.begin(), rand() % mock.size());
+        if (rand() % 2 == 0) {
+            rand_buf(record_size, write_buf);
+            file_handle->update_record(it->first, write_buf, context);
+            it->second = std::string(write_buf, record_size);
+        } else {
+            file_handle->delete_record(it->first, context);
+            mock.erase(it);
+        }
+    }
+    check_equal(file_handle.get(), mock);
+    rm_manager->close_file(file_handle.get());
+
+    // 所有帧都能同时被新页面固定
+    std::string scratch = "no_leaked_pins_scratch.txt";
+    if (disk_manager->is_file(scratch)) {
+        disk_manager->destroy_file(scratch);
+    }
+    disk_manager->create_file(scratch);
+    int fd = disk_manager->open_file(scratch);
+    std::vector<BasicPageGuard> guards;
+    for (int i = 0; i < pool_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        guards.push_back(buffer_pool_manager->new_page_guarded(&page_id));
+        EXPECT_TRUE(guards.back().is_valid());
+    }
+    guards.clear();
+    buffer_pool_manager->flush_all_pages(fd);
+    buffer_pool_manager->discard_file_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(scratch);
+
+    file_handle = rm_manager->open_file(filename);
+    check_equal(file_handle.get(), mock);
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试槽式页面格式：变长字段只占用实际长度，记录长度可以超过RM_MAX_RECORD_SIZE，
+ * 更新后原页面放不下的记录转发到其他页面，记录号保持不变
+ */
+TEST(RecordManagerTest, SlottedFormatTest) {
+    srand((unsigned)time(nullptr));
+
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    std::string filename = "slotted.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    // INT, VARCHAR(200), 8字节定长字段, VARCHAR(600)
+    std::vector<RmVarCol> var_cols = {{.offset = 4, .len = 200}, {.offset = 212, .len = 600}};
+    int record_size = 812;
+    rm_manager->create_slotted_file(filename, record_size, var_cols);
+    auto file_handle = rm_manager->open_file(filename);
+    assert(file_handle->file_hdr_.format == RM_FORMAT_SLOTTED);
+
+    // 变长字段的实际内容不含0，之后填0
+    auto make_record = [&](char *buf, int max_var_len) {
+        rand_buf(record_size, buf);
+        for (auto &col : var_cols) {
+            int len = rand() % (std::min(col.len, max_var_len) + 1);
+            for (int i = 0; i < len; i++) {
+                buf[col.offset + i] = 1 + rand() % 255;
+            }
+            memset(buf + col.offset + len, 0, col.len - len);
+        }
+    };
+
+    // 短记录：一个页面能放下的记录数远多于按最大长度存放时
+    char write_buf[PAGE_SIZE];
+    for (int i = 0; i < 300; i++) {
+        make_record(write_buf, 16);
+        Rid rid = file_handle->insert_record(write_buf, context);
+        mock[rid] = std::string(write_buf, record_size);
+    }
+    check_equal(file_handle.get(), mock);
+    EXPECT_GT(300 / (file_handle->file_hdr_.num_pages - 1), PAGE_SIZE / record_size);
+
+    // 把第一个页面中的记录依次更新为最长，页面的剩余空间用完后，之后的记录转发到其他页面
+    bool forwarded = false;
+    for (int slot_no = 0; slot_no < 4 && !forwarded; slot_no++) {
+        Rid rid = {.page_no = RM_FIRST_RECORD_PAGE, .slot_no = slot_no};
+        make_record(write_buf, record_size);
+        memset(write_buf + 4, 'x', 200);
+        memset(write_buf + 212, 'y', 600);
+        file_handle->update_record(rid, write_buf, context);
+        mock[rid] = std::string(write_buf, record_size);
+        RmPageHandle page_handle = file_handle->fetch_page_handle(rid.page_no);
+        forwarded = page_handle.slotted().is_forward(rid.slot_no);
+    }
+    EXPECT_TRUE(forwarded);
+    check_equal(file_handle.get(), mock);
+
+    // 随机插入、更新、删除和回滚删除
+    for (int round = 0; round < 1000; round++) {
+        int dice = rand() % 4;
+        if (mock.empty() || dice == 0) {
+            make_record(write_buf, record_size);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, record_size);
+        } else {
+            auto it = std::next(mock.begin(), rand() % mock.size());
+            Rid rid = it->first;
+            if (dice == 1) {
+                make_record(write_buf, rand() % 2 == 0 ? 16 : record_size);
+                file_handle->update_record(rid, write_buf, context);
+                it->second = std::string(write_buf, record_size);
+            } else if (dice == 2) {
+                file_handle->delete_record(rid, context);
+                mock.erase(it);
+            } else {
+                // 删除后在原位置恢复，恢复的记录可能比页面剩余空间大
+                std::string old = it->second;
+                file_handle->delete_record(rid, context);
+                file_handle->insert_record(rid, (char *)old.c_str());
+            }
+        }
+        if (round % 100 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+            check_equal(file_handle.get(), mock);
+        }
+    }
+    check_equal(file_handle.get(), mock);
+
+    // 删除所有记录后，所有页面的空间都被回收
+    for (auto &entry : mock) {
+        file_handle->delete_record(entry.first, context);
+    }
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_handle->file_hdr_.num_pages; page_no++) {
+        RmPageHandle page_handle = file_handle->fetch_page_handle(page_no);
+        EXPECT_EQ(page_handle.slotted().get_free_bytes(), RM_SLOTTED_PAGE_CAPACITY);
+        EXPECT_EQ(page_handle.slotted().get_hdr()->in_free_list, 1);
+    }
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试顺序扫描不会挤掉被反复访问的页面：扫描对同一页面逐条记录的多次访问只算一次，
+ * 扫描过的表页面先于热页面（如B+树内部结点）被淘汰
+ */
+TEST(RecordManagerTest, ScanResistanceTest) {
+    const int pool_size = 64;
+    const int num_tables = 4;
+    const int table_pages = pool_size / BULK_READ_THRESHOLD;  // 不超过阈值，扫描不使用环形缓冲区
+    const int num_hot_pages = 16;
+    const int record_size = 512;
+    auto disk_manager = std::make_unique<DiskManager>();
+
+    // 先用另一个缓冲池建表，测试用的缓冲池开始时是空的
+    std::vector<std::string> tables;
+    {
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(pool_size, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+        char write_buf[PAGE_SIZE];
+        for (int i = 0; i < num_tables; i++) {
+            std::string filename = "scan_resistance_" + std::to_string(i) + ".txt";
+            if (disk_manager->is_file(filename)) {
+                disk_manager->destroy_file(filename);
+            }
+            rm_manager->create_file(filename, record_size);
+            auto file_handle = rm_manager->open_file(filename);
+            while (file_handle->file_hdr_.num_pages < table_pages) {
+                rand_buf(record_size, write_buf);
+                file_handle->insert_record(write_buf, nullptr);
+            }
+            rm_manager->close_file(file_handle.get());
+            tables.push_back(filename);
+        }
+    }
+
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(pool_size, disk_manager.get(), false, 1, "LRU_K");
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string hot_file = "scan_resistance_hot.txt";
+    if (disk_manager->is_file(hot_file)) {
+        disk_manager->destroy_file(hot_file);
+    }
+    disk_manager->create_file(hot_file);
+    int hot_fd = disk_manager->open_file(hot_file);
+    for (int i = 0; i < num_hot_pages; i++) {
+        PageId page_id = {.fd = hot_fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, buffer_pool_manager->new_page(&page_id));
+        buffer_pool_manager->unpin_page(page_id, true);
+    }
+    // 热页面被多轮访问，每轮之间隔着其他页面的访问
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < num_hot_pages; i++) {
+            PageId page_id = {.fd = hot_fd, .page_no = i};
+            ASSERT_NE(nullptr, buffer_pool_manager->fetch_page(page_id));
+            buffer_pool_manager->unpin_page(page_id, false);
+        }
+    }
+
+    // 扫描的页面总数加上热页面超过缓冲池的帧数；扫描完所有表之后才关闭，关闭时表的页面会离开缓冲池
+    std::vector<std::unique_ptr<RmFileHandle>> file_handles;
+    for (auto &filename : tables) {
+        file_handles.push_back(rm_manager->open_file(filename));
+    }
+    size_t num_records = 0;
+    for (auto &file_handle : file_handles) {
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            EXPECT_NE(nullptr, file_handle->get_record(scan.rid(), nullptr));
+            num_records++;
+        }
+    }
+    buffer_pool_manager->wait_prefetch();
+    EXPECT_GT(num_records, 0u);
+    for (int i = 0; i < num_hot_pages; i++) {
+        EXPECT_TRUE(buffer_pool_manager->is_resident({.fd = hot_fd, .page_no = i})) << "page_no: " << i;
+    }
+
+    for (auto &file_handle : file_handles) {
+        rm_manager->close_file(file_handle.get());
+    }
+    buffer_pool_manager->flush_all_pages(hot_fd);
+    buffer_pool_manager->discard_file_pages(hot_fd);
+    disk_manager->close_file(hot_fd);
+    disk_manager->destroy_file(hot_file);
+    for (auto &filename : tables) {
+        rm_manager->destroy_file(filename);
+    }
+}
@@ -0,0 +1,136 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 比较各个替换策略的命中率和命中路径上pin+unpin的吞吐量
+ * 用法: replacer_bench [扫描页数=20000] [每个线程的操作次数=1000000] [最大线程数=4]
+ * 命中率使用热点页面+顺序扫描的负载：热点页面的重用距离大于缓冲池时LRU总是先淘汰它们，
+ * LRU-K先淘汰只访问过一次的扫描页面，CLOCK-Pro把热点页面留在热帧中
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "replacer/replacer.h"
+
+const std::vector<std::string> REPLACER_TYPES = {"LRU", "LRU_K", "CLOCK", "CLOCK_PRO"};
+
+/**
+ * @description: 只有页表和替换器的缓冲池模型，用于比较不同替换策略的命中率
+ */
+class PoolModel {
+   public:
+    PoolModel(const std::string &type, int pool_size)
+        : replacer_(Replacer::create(type, pool_size)), frames_(pool_size, -1) {}
+
+    /**
+     * @description: 访问一个页面，与BufferPoolManager一样在访问前后pin/unpin该页面所在的帧
+     * @return {bool} 是否命中
+     */
+    bool access(int page_no) {
+        auto it = page_table_.find(page_no);
+        bool hit = it != page_table_.end();
+        frame_id_t frame_id;
+        if (hit) {
+            frame_id = it->second;
+        } else if (num_used_ < frames_.size()) {
+            frame_id = static_cast<frame_id_t>(num_used_++);
+        } else {
+            replacer_->victim(&frame_id);
+            page_table_.erase(frames_[frame_id]);
+        }
+        frames_[frame_id] = page_no;
+        page_table_[page_no] = frame_id;
+        replacer_->pin(frame_id);
+        replacer_->unpin(frame_id);
+        return hit;
+    }
+
+   private:
+    std::unique_ptr<Replacer> replacer_;
+    std::vector<int> frames_;   // 每个帧中的页面号
+    std::unordered_map<int, frame_id_t> page_table_;
+    size_t num_used_ = 0;
+};
+
+/**
+ * @description: 每访问一个扫描页面访问一次热点页面，热点页面每两次访问换一个
+ */
+void run_hit_ratio(const std::string &type, int num_scan_pages) {
+    const int pool_size = 100;
+    const int num_hot_pages = 40;
+    PoolModel model(type, pool_size);
+    int hot_hits = 0;
+    int hits = 0;
+    for (int i = 0; i < num_scan_pages; i++) {
+        hits += model.access(num_hot_pages + i);
+        int hot_page_no = i / 2 % num_hot_pages;
+        bool hit = model.access(hot_page_no);
+        hot_hits += hit;
+        hits += hit;
+    }
+    std::cout << type << "\thot page hit ratio: " << static_cast<double>(hot_hits) / num_scan_pages
+              << ", total hit ratio: " << static_cast<double>(hits) / (2 * num_scan_pages) << std::endl;
+}
+
+/**
+ * @return {double} 所有线程合计每秒完成的pin+unpin次数，帧全部可淘汰，相当于缓冲池全部命中
+ */
+double run_throughput(Replacer *replacer, int num_frames, int ops_per_thread, int num_threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([=]() {
+            std::mt19937 rng(t);
+            std::uniform_int_distribution<int> dist(0, num_frames - 1);
+            for (int i = 0; i < ops_per_thread; i++) {
+                int frame_id = dist(rng);
+                replacer->pin(frame_id);
+                replacer->unpin(frame_id);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(ops_per_thread) * num_threads / seconds;
+}
+
+int main(int argc, char **argv) {
+    int num_scan_pages = argc > 1 ? std::stoi(argv[1]) : 20000;
+    int ops_per_thread = argc > 2 ? std::stoi(argv[2]) : 1000000;
+    int max_threads = argc > 3 ? std::stoi(argv[3]) : 4;
+    const int num_frames = 10000;
+    std::cout << "scan pages: " << num_scan_pages << ", ops per thread: " << ops_per_thread
+              << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    for (auto &type : REPLACER_TYPES) {
+        run_hit_ratio(type, num_scan_pages);
+    }
+    for (auto &type : REPLACER_TYPES) {
+        auto replacer = Replacer::create(type, num_frames);
+        for (int i = 0; i < num_frames; i++) {
+            replacer->unpin(i);
+        }
+        std::cout << type;
+        for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+            double ops = run_throughput(replacer.get(), num_frames, ops_per_thread, num_threads);
+            std::cout << "\t" << num_threads << " threads: " << static_cast<long>(ops) << " pin+unpin/s";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}